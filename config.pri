@@ -221,6 +221,12 @@ liborigin {
 DEFINES  += ORIGIN_IMPORT
 }
 
+### use FFTW instead of GSL for Fourier transforms
+fftw {
+DEFINES  += HAVE_FFTW3
+LIBS     += -lfftw3
+}
+
 ### python support
 aegis {
 CONFIG+=python
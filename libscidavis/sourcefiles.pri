@@ -78,6 +78,8 @@ HEADERS  += src/ApplicationWindow.h \
             src/NonLinearFit.h\
             src/PluginFit.h\
             src/SigmoidalFit.h\
+            src/AutoDiffFormula.h\
+            src/BatchFit.h\
             src/customevents.h\
             src/ScriptingLangDialog.h\
             src/TextFormatButtons.h\
@@ -92,6 +94,7 @@ HEADERS  += src/ApplicationWindow.h \
             src/SmoothFilter.h\
             src/FFTFilter.h\
             src/FFT.h\
+            src/FourierTransform.h\
             src/Convolution.h\
             src/Correlation.h\
             src/PlotToolInterface.h\
@@ -186,6 +189,8 @@ SOURCES  += src/ApplicationWindow.cpp \
             src/PluginFit.cpp\
             src/NonLinearFit.cpp\
             src/SigmoidalFit.cpp\
+            src/AutoDiffFormula.cpp\
+            src/BatchFit.cpp\
             src/ScriptingEnv.cpp\
             src/Script.cpp\
             src/ScriptingLangDialog.cpp\
@@ -200,6 +205,7 @@ SOURCES  += src/ApplicationWindow.cpp \
             src/SmoothFilter.cpp\
             src/FFTFilter.cpp\
             src/FFT.cpp\
+            src/FourierTransform.cpp\
             src/Convolution.cpp\
             src/Correlation.cpp\
             src/ScreenPickerTool.cpp\
@@ -245,6 +251,7 @@ HEADERS += src/future/core/AbstractAspect.h \
            src/future/core/AbstractColumn.h \
            src/future/core/column/Column.h \
            src/future/core/column/ColumnPrivate.h \
+           src/future/core/column/ColumnData.h \
            src/future/core/column/columncommands.h \
            src/future/core/AbstractFilter.h \
            src/future/core/AbstractSimpleFilter.h \
@@ -268,6 +275,11 @@ HEADERS += src/future/core/AbstractAspect.h \
            src/future/lib/ConfigPageWidget.h \
            src/future/lib/Interval.h \
            src/future/lib/IntervalAttribute.h \
+           src/future/lib/ParallelFor.h \
+           src/future/lib/BinaryData.h \
+           src/future/lib/UndoMemory.h \
+           src/future/lib/GzipDevice.h \
+           src/future/lib/NumberParser.h \
            src/future/matrix/future_Matrix.h \
            src/future/matrix/MatrixModel.h \
            src/future/matrix/MatrixView.h \
@@ -292,6 +304,7 @@ SOURCES += src/future/core/AbstractAspect.cpp \
            src/future/core/Project.cpp \
            src/future/core/column/Column.cpp \
            src/future/core/column/ColumnPrivate.cpp \
+           src/future/core/column/ColumnData.cpp \
            src/future/core/column/columncommands.cpp \
            src/future/core/datatypes/DateTime2StringFilter.cpp \
            src/future/core/datatypes/String2DateTimeFilter.cpp \
@@ -303,6 +316,9 @@ SOURCES += src/future/core/AbstractAspect.cpp \
            src/future/lib/XmlStreamReader.cpp \
            src/future/lib/ActionManager.cpp \
            src/future/lib/ConfigPageWidget.cpp \
+           src/future/lib/UndoMemory.cpp \
+           src/future/lib/NumberParser.cpp \
+           src/future/lib/GzipDevice.cpp \
            src/future/matrix/future_Matrix.cpp \
            src/future/matrix/MatrixModel.cpp \
            src/future/matrix/MatrixView.cpp \
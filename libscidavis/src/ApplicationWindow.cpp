@@ -101,7 +101,11 @@
 #include "IconLoader.h"
 #include "core/Project.h"
 #include "core/column/Column.h"
+#include "lib/GzipDevice.h"
+#include "lib/ParallelFor.h"
+#include "lib/UndoMemory.h"
 #include "lib/XmlStreamReader.h"
+#include "table/AsciiTableImportFilter.h"
 #include "table/future_Table.h"
 
 // TODO: move tool-specific code to an extension manager
@@ -159,8 +163,13 @@
 
 #include <zlib.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <thread>
 using namespace std;
 
 #ifdef Q_OS_WIN
@@ -171,10 +180,6 @@ using namespace std;
 
 using namespace Qwt3D;
 
-extern "C" {
-void file_compress(const char *file, const char *mode);
-}
-
 ApplicationWindow::ApplicationWindow()
     : scripted(ScriptingLangManager::newEnv(this)),
       //      logWindow(new QDockWidget(this)),
@@ -934,6 +939,8 @@ void ApplicationWindow::initMainMenu()
     smooth->setFont(appFont);
     smooth->addAction(actionSmoothSavGol);
     smooth->addAction(actionSmoothAverage);
+    smooth->addAction(actionSmoothMedian);
+    smooth->addAction(actionSmoothExponential);
     smooth->addAction(actionSmoothFFT);
 
     filter = calcul->addMenu(tr("&FFT Filter"));
@@ -2748,6 +2755,7 @@ Table *ApplicationWindow::table(const QString &name)
     QList<MyWidget *> lst = windowsList();
     foreach (MyWidget *w, lst) {
         if (w->inherits("Table") && static_cast<Table *>(w)->name() == caption) {
+            w->loadPendingData();
             return (Table *)w;
         }
     }
@@ -2765,6 +2773,7 @@ Matrix *ApplicationWindow::matrix(const QString &name)
     QList<MyWidget *> lst = windowsList();
     foreach (MyWidget *w, lst) {
         if (w->inherits("Matrix") && static_cast<Matrix *>(w)->name() == caption) {
+            w->loadPendingData();
             return (Matrix *)w;
         }
     }
@@ -3223,24 +3232,95 @@ void ApplicationWindow::importASCII(const QStringList &files, int import_mode,
 
     // this is very much a special case, and thus is handled completely in its own block
     if (import_mode == ImportASCIIDialog::NewTables) {
-        int dx = 0, dy = 0;
         QStringList sorted_files = files;
         sorted_files.sort();
-        for (int i = 0; i < sorted_files.size(); i++) {
-            Table *w = newTable(sorted_files[i], local_column_separator, local_ignored_lines,
-                                local_rename_columns, local_strip_spaces, local_simplify_spaces,
-                                local_convert_to_numeric, local_numeric_locale);
-            if (!w)
-                continue;
-            w->setCaptionPolicy(MyWidget::Both);
-            setListViewLabel(w->name(), sorted_files[i]);
-            if (i == 0) {
-                dx = w->verticalHeaderWidth();
-                dy = w->frameGeometry().height() - w->height();
-                w->move(QPoint(0, 0));
-            } else
-                w->move(QPoint(i * dx, i * dy));
-        }
+        int count = sorted_files.size();
+
+        AsciiTableImportFilter filter;
+        filter.set_ignored_lines(local_ignored_lines);
+        filter.set_separator(local_column_separator);
+        filter.set_first_row_names_columns(local_rename_columns);
+        filter.set_trim_whitespace(local_strip_spaces);
+        filter.set_simplify_whitespace(local_simplify_spaces);
+        filter.set_convert_to_numeric(local_convert_to_numeric);
+        filter.set_numeric_locale(local_numeric_locale);
+
+        // parse the files on worker threads; the tables can only be created in the GUI thread
+        vector<shared_ptr<AsciiTableImportFilter::Data>> parsed(count);
+        vector<bool> finished(count, false);
+        mutex parsed_mutex;
+        condition_variable parsed_changed;
+        atomic<int> next_file(0);
+        atomic<bool> cancelled(false);
+        auto work = [&]() {
+            for (int i = next_file++; i < count && !cancelled; i = next_file++) {
+                shared_ptr<AsciiTableImportFilter::Data> data;
+                QFile file(sorted_files.at(i));
+                try {
+                    if (file.open(QIODevice::ReadOnly))
+                        data = filter.read(file);
+                } catch (...) {
+                    // files which can't be read are skipped, as before
+                }
+                lock_guard<mutex> lock(parsed_mutex);
+                parsed[i] = data;
+                finished[i] = true;
+                parsed_changed.notify_all();
+            }
+        };
+        vector<thread> workers;
+        for (int k = 0; k < min(idealThreadCount(), count); k++)
+            workers.emplace_back(work);
+
+        QApplication::setOverrideCursor(Qt::BusyCursor);
+        QProgressDialog progress(tr("Importing ASCII files..."), tr("&Cancel"), 0, count, this);
+        progress.setWindowModality(Qt::ApplicationModal);
+        progress.setMinimumDuration(500);
+        QElapsedTimer timer;
+        timer.start();
+        int dx = 0, dy = 0;
+        for (int i = 0; i < count && !progress.wasCanceled(); i++) {
+            // wait for the file to be parsed, keeping the GUI alive meanwhile
+            shared_ptr<AsciiTableImportFilter::Data> data;
+            bool ready = false;
+            while (!ready && !progress.wasCanceled()) {
+                unique_lock<mutex> lock(parsed_mutex);
+                ready = parsed_changed.wait_for(lock, chrono::milliseconds(50),
+                                                [&]() { return finished[i]; });
+                data.swap(parsed[i]);
+                lock.unlock();
+                if (!ready)
+                    QApplication::processEvents(progress.isVisible()
+                                                        ? QEventLoop::AllEvents
+                                                        : QEventLoop::ExcludeUserInputEvents,
+                                                50);
+            }
+            if (data) {
+                Table *w = newTable(generateUniqueName(tr("Table")), sorted_files[i],
+                                    AsciiTableImportFilter::createColumns(*data));
+                w->setWindowLabel(sorted_files[i]);
+                w->setCaptionPolicy(MyWidget::Both);
+                setListViewLabel(w->name(), sorted_files[i]);
+                if (i == 0) {
+                    dx = w->verticalHeaderWidth();
+                    dy = w->frameGeometry().height() - w->height();
+                    w->move(QPoint(0, 0));
+                } else
+                    w->move(QPoint(i * dx, i * dy));
+            }
+
+            double seconds = max(timer.elapsed(), qint64(1)) / 1000.0;
+            progress.setLabelText(tr("Imported %1 of %2 files (%3 files/s)")
+                                          .arg(i + 1)
+                                          .arg(count)
+                                          .arg((i + 1) / seconds, 0, 'f', 1));
+            progress.setValue(i + 1);
+        }
+        cancelled = true;
+        for (auto &worker : workers)
+            worker.join();
+        progress.reset();
+        QApplication::restoreOverrideCursor();
         modifiedProject();
         return;
     }
@@ -3489,56 +3569,23 @@ void ApplicationWindow::openRecentProject()
     }
 }
 
-QFile *ApplicationWindow::openCompressedFile(const QString &fn)
+QIODevice *ApplicationWindow::openCompressedFile(const QString &fn)
 {
-    QTemporaryFile *file;
-    char buf[16384];
-    int len, err;
-
-    gzFile in = gzopen(QFile::encodeName(fn).constData(), "rb");
-    if (!in) {
+    // decompress on the fly while reading
+    QFile *file = new QFile(fn);
+    GzipDevice *gzip = new GzipDevice(file);
+    file->setParent(gzip);
+    if (!file->open(QIODevice::ReadOnly) || !gzip->open(QIODevice::ReadOnly)) {
         QMessageBox::critical(this, tr("File opening error"), tr("zlib can't open %1.").arg(fn));
+        delete gzip;
         return 0;
     }
-    file = new QTemporaryFile();
-    if (!file || !file->open()) {
-        gzclose(in);
-        QMessageBox::critical(
-                this, tr("File opening error"),
-                tr("Can't create temporary file for writing uncompressed copy of %1.").arg(fn));
-        return 0;
-    }
-
-    forever {
-        len = gzread(in, buf, sizeof(buf));
-        if (len == 0)
-            break;
-        if (len < 0) {
-            QMessageBox::critical(this, tr("File opening error"), gzerror(in, &err));
-            gzclose(in);
-            file->close();
-            delete file;
-            return 0;
-        }
-        if (file->write(buf, len) != len) {
-            QMessageBox::critical(
-                    this, tr("File opening error"),
-                    tr("Error writing to temporary file: %1").arg(file->errorString()));
-            gzclose(in);
-            file->close();
-            delete file;
-            return 0;
-        }
-    }
-
-    gzclose(in);
-    file->reset();
-    return file;
+    return gzip;
 }
 
 bool ApplicationWindow::loadProject(const QString &fn)
 {
-    unique_ptr<QFile> file;
+    unique_ptr<QIODevice> file;
 
     if (fn.endsWith(".gz", Qt::CaseInsensitive) || fn.endsWith(".gz~", Qt::CaseInsensitive)) {
         file.reset(openCompressedFile(fn));
@@ -3653,6 +3700,14 @@ bool ApplicationWindow::loadProject(const QString &fn)
     progress.setLabelText(title);
     progress.activateWindow();
 
+    // in lazy mode, the data of tables and matrices is read when it is needed for the first time
+    d_pending_xml.reset();
+    if (getSettings().value("/General/LazyProjectLoading", false).toBool()) {
+        d_pending_xml = make_shared<QTemporaryFile>();
+        if (!d_pending_xml->open())
+            d_pending_xml.reset();
+    }
+
     Folder *cf = projectFolder();
     folders.blockSignals(true);
     blockSignals(true);
@@ -3852,6 +3907,13 @@ bool ApplicationWindow::loadProject(const QString &fn)
     // change folder to user defined current folder
     changeFolder(cf, true);
 
+    // the tables and matrices kept the file they still have to be read from
+    d_pending_xml.reset();
+    // those shown right away need their data now, the others get it when they are shown
+    foreach (MyWidget *w, windowsList())
+        if (w->isVisible() && !w->isMinimized())
+            w->loadPendingData();
+
     blockSignals(false);
     renamedTables.clear();
 
@@ -4150,6 +4212,8 @@ void ApplicationWindow::readSettings()
     changeAppStyle(settings.value("/Style", appStyle).toString());
     undoLimit = settings.value("/UndoLimit", 10).toInt();
     d_project->undoStack()->setUndoLimit(undoLimit);
+    undoMemoryLimit = settings.value("/UndoMemoryLimit", 512).toInt();
+    UndoMemory::setBudget(qint64(undoMemoryLimit) * 1024 * 1024);
     autoSave = settings.value("/AutoSave", true).toBool();
     autoSaveTime = settings.value("/AutoSaveTime", 15).toInt();
     defaultScriptingLang = settings.value("/ScriptingLang", "muParser").toString();
@@ -4418,6 +4482,7 @@ void ApplicationWindow::saveSettings()
     settings.setValue("/AutoSave", autoSave);
     settings.setValue("/AutoSaveTime", autoSaveTime);
     settings.setValue("/UndoLimit", undoLimit);
+    settings.setValue("/UndoMemoryLimit", undoMemoryLimit);
     settings.setValue("/ScriptingLang", defaultScriptingLang);
     settings.setValue("/Locale", QLocale().name());
     settings.setValue("/LocaleUseGroupSeparator",
@@ -4943,28 +5008,24 @@ Folder *ApplicationWindow::projectFolder()
     return ((FolderListItem *)folders.topLevelItem(0))->folder();
 }
 
+//! Whether a project has to be saved under a new name (it is new or was imported)
+static bool needsNewFileName(const QString &projectname)
+{
+    return projectname == "untitled" || projectname.endsWith(".opj", Qt::CaseInsensitive)
+            || projectname.endsWith(".ogm", Qt::CaseInsensitive)
+            || projectname.endsWith(".ogw", Qt::CaseInsensitive)
+            || projectname.endsWith(".ogg", Qt::CaseInsensitive)
+            || projectname.endsWith(".org", Qt::CaseInsensitive);
+}
+
 bool ApplicationWindow::saveProject()
 {
-    if (projectname == "untitled" || projectname.endsWith(".opj", Qt::CaseInsensitive)
-        || projectname.endsWith(".ogm", Qt::CaseInsensitive)
-        || projectname.endsWith(".ogw", Qt::CaseInsensitive)
-        || projectname.endsWith(".ogg", Qt::CaseInsensitive)
-        || projectname.endsWith(".org", Qt::CaseInsensitive)) {
+    if (needsNewFileName(projectname)) {
         saveProjectAs();
         return false;
     }
 
-    bool compress = false;
-    QString fn = projectname;
-    if (fn.endsWith(".gz")) {
-        fn = fn.left(fn.length() - 3);
-        compress = true;
-    }
-
-    saveFolder(projectFolder(), fn);
-
-    if (compress)
-        file_compress(QFile::encodeName(fn).constData(), "wb9");
+    saveFolder(projectFolder(), projectname);
 
     setWindowTitle("SciDAVis - " + projectname);
     savedProject();
@@ -6374,6 +6435,16 @@ void ApplicationWindow::showSmoothAverageDialog()
     showSmoothDialog(SmoothFilter::Average);
 }
 
+void ApplicationWindow::showSmoothMedianDialog()
+{
+    showSmoothDialog(SmoothFilter::Median);
+}
+
+void ApplicationWindow::showSmoothExponentialDialog()
+{
+    showSmoothDialog(SmoothFilter::Exponential);
+}
+
 void ApplicationWindow::showInterpolationDialog()
 {
     if (!d_workspace.activeSubWindow() || !d_workspace.activeSubWindow()->inherits("MultiLayer"))
@@ -7484,7 +7555,7 @@ void ApplicationWindow::modifiedProject(MyWidget *w)
 void ApplicationWindow::timerEvent(QTimerEvent *e)
 {
     if (e->timerId() == savingTimerId)
-        saveProject();
+        autoSaveProject();
     else
         QWidget::timerEvent(e);
 }
@@ -7784,6 +7855,8 @@ void ApplicationWindow::showGraphContextMenu()
             smooth->addAction(actionSmoothSavGol);
             smooth->addAction(actionSmoothFFT);
             smooth->addAction(actionSmoothAverage);
+            smooth->addAction(actionSmoothMedian);
+            smooth->addAction(actionSmoothExponential);
 
             QMenu *filter = calcul->addMenu(tr("&FFT Filter"));
             filter->addAction(actionLowPassFilter);
@@ -7899,6 +7972,8 @@ void ApplicationWindow::showLayerButtonContextMenu()
             smooth->addAction(actionSmoothSavGol);
             smooth->addAction(actionSmoothFFT);
             smooth->addAction(actionSmoothAverage);
+            smooth->addAction(actionSmoothMedian);
+            smooth->addAction(actionSmoothExponential);
 
             QMenu *filter = calcul->addMenu(tr("&FFT Filter"));
             filter->addAction(actionLowPassFilter);
@@ -9019,24 +9094,39 @@ Matrix *ApplicationWindow::openMatrix(ApplicationWindow *app, const QStringList
         QString xml(flist.at(index++));
         while (xml.length() < length && index < flist.size())
             xml += '\n' + flist.at(index++);
-        XmlStreamReader reader(xml);
-        reader.readNext();
-        reader.readNext(); // read the start document
-        if (w->d_future_matrix->load(&reader) == false) {
-            QString msg_text = reader.errorString();
-            QMessageBox::critical(this, tr("Error reading matrix from project file"), msg_text);
-        }
-        if (reader.hasWarnings()) {
-            QString msg_text =
-                    tr("The following problems occured when loading the project file:\n");
-            QStringList warnings = reader.warningStrings();
-            foreach (QString str, warnings)
-                msg_text += str + "\n";
-            QMessageBox::warning(this, tr("Project loading partly failed"), msg_text);
+
+        // when loading lazily, keep the XML in a file for reading it later
+        bool pending = false;
+        if (app->d_pending_xml) {
+            qint64 offset = app->d_pending_xml->size();
+            QByteArray utf8 = xml.toUtf8();
+            pending = app->d_pending_xml->seek(offset)
+                    && app->d_pending_xml->write(utf8) == utf8.size()
+                    && w->d_future_matrix->setPendingData(app->d_pending_xml, offset, utf8.size());
+        }
+        if (!pending) {
+            XmlStreamReader reader(xml);
+            reader.readNext();
+            reader.readNext(); // read the start document
+            if (w->d_future_matrix->load(&reader) == false) {
+                QString msg_text = reader.errorString();
+                QMessageBox::critical(this, tr("Error reading matrix from project file"),
+                                      msg_text);
+            }
+            if (reader.hasWarnings()) {
+                QString msg_text =
+                        tr("The following problems occured when loading the project file:\n");
+                QStringList warnings = reader.warningStrings();
+                foreach (QString str, warnings)
+                    msg_text += str + "\n";
+                QMessageBox::warning(this, tr("Project loading partly failed"), msg_text);
+            }
         }
         restoreWindowGeometry(app, w, flist.at(index));
 
-        activateSubWindow(w);
+        // showing the window would read the pending data right away
+        if (!pending)
+            activateSubWindow(w);
         return w;
     }
 }
@@ -9140,10 +9230,14 @@ Table *ApplicationWindow::openTable(ApplicationWindow *app, QTextStream &stream)
         // On Windows, loading large tables to a QString has been observed to crash
         // (apparently due to excessive memory usage).
         // => use temporary file if possible
-        QTemporaryFile tmp_file;
+        // When loading lazily, all tables share one file, which is kept for reading them later.
+        QTemporaryFile own_tmp_file;
+        QTemporaryFile *tmp_file = app->d_pending_xml ? app->d_pending_xml.get() : &own_tmp_file;
+        qint64 offset = tmp_file->isOpen() ? tmp_file->size() : 0;
         QString tmp_string;
-        if (tmp_file.open()) {
-            QTextStream tmp(&tmp_file);
+        if (tmp_file->isOpen() || tmp_file->open()) {
+            tmp_file->seek(offset);
+            QTextStream tmp(tmp_file);
             tmp.setCodec(QTextCodec::codecForName("UTF-8"));
             int read = 0;
             while (length - read >= 1024) {
@@ -9152,30 +9246,37 @@ Table *ApplicationWindow::openTable(ApplicationWindow *app, QTextStream &stream)
             }
             tmp << stream.read(length - read);
             tmp.flush();
-            tmp_file.seek(0);
+            tmp_file->seek(offset);
             stream.readLine(); // skip to next newline
         } else
             while (tmp_string.length() < length)
                 tmp_string += '\n' + stream.readLine();
 
-        XmlStreamReader reader(tmp_string);
-        if (tmp_file.isOpen())
-            reader.setDevice(&tmp_file);
-
-        Table *w = app->newTable("table", 1, 1);
-        reader.readNext();
-        reader.readNext(); // read the start document
-        if (w->d_future_table->load(&reader) == false) {
-            QString msg_text = reader.errorString();
-            QMessageBox::critical(this, tr("Error reading table from project file"), msg_text);
-        }
-        if (reader.hasWarnings()) {
-            QString msg_text =
-                    tr("The following problems occured when loading the project file:\n");
-            QStringList warnings = reader.warningStrings();
-            foreach (QString str, warnings)
-                msg_text += str + "\n";
-            QMessageBox::warning(this, tr("Project loading partly failed"), msg_text);
+        Table *w = app->newTable("table", 0, 0);
+        bool pending = tmp_file == app->d_pending_xml.get()
+                && w->d_future_table->setPendingData(app->d_pending_xml, offset,
+                                                     tmp_file->size() - offset);
+        if (!pending) {
+            XmlStreamReader reader(tmp_string);
+            if (tmp_file->isOpen()) {
+                tmp_file->seek(offset);
+                reader.setDevice(tmp_file);
+            }
+            reader.readNext();
+            reader.readNext(); // read the start document
+            if (w->d_future_table->load(&reader) == false) {
+                QString msg_text = reader.errorString();
+                QMessageBox::critical(this, tr("Error reading table from project file"),
+                                      msg_text);
+            }
+            if (reader.hasWarnings()) {
+                QString msg_text =
+                        tr("The following problems occured when loading the project file:\n");
+                QStringList warnings = reader.warningStrings();
+                foreach (QString str, warnings)
+                    msg_text += str + "\n";
+                QMessageBox::warning(this, tr("Project loading partly failed"), msg_text);
+            }
         }
         w->setBirthDate(QLocale().toString(w->d_future_table->creationTime()));
 
@@ -9184,7 +9285,9 @@ Table *ApplicationWindow::openTable(ApplicationWindow *app, QTextStream &stream)
 
         s = stream.readLine(); // </table>
 
-        activateSubWindow(w);
+        // showing the window would read the pending data right away
+        if (!pending)
+            activateSubWindow(w);
         return w;
     }
 }
@@ -10584,6 +10687,13 @@ void ApplicationWindow::createActions()
     actionSmoothAverage = new QAction(tr("Moving Window &Average..."), this);
     connect(actionSmoothAverage, SIGNAL(triggered()), this, SLOT(showSmoothAverageDialog()));
 
+    actionSmoothMedian = new QAction(tr("Moving Window &Median..."), this);
+    connect(actionSmoothMedian, SIGNAL(triggered()), this, SLOT(showSmoothMedianDialog()));
+
+    actionSmoothExponential = new QAction(tr("&Exponential Moving Average..."), this);
+    connect(actionSmoothExponential, SIGNAL(triggered()), this,
+            SLOT(showSmoothExponentialDialog()));
+
     actionDifferentiate = new QAction(tr("&Differentiate"), this);
     connect(actionDifferentiate, SIGNAL(triggered()), this, SLOT(differentiate()));
 
@@ -11102,6 +11212,8 @@ void ApplicationWindow::translateActionsStrings()
     actionSmoothSavGol->setText(tr("&Savitzky-Golay..."));
     actionSmoothFFT->setText(tr("&FFT Filter..."));
     actionSmoothAverage->setText(tr("Moving Window &Average..."));
+    actionSmoothMedian->setText(tr("Moving Window &Median..."));
+    actionSmoothExponential->setText(tr("&Exponential Moving Average..."));
     actionDifferentiate->setText(tr("&Differentiate"));
     actionFitLinear->setText(tr("Fit &Linear"));
     actionShowFitPolynomDialog->setText(tr("Fit &Polynomial ..."));
@@ -11981,7 +12093,7 @@ void ApplicationWindow::appendProject(const QString &fn)
     if (fn.isEmpty())
         return;
 
-    QFile *file;
+    QIODevice *file;
 
     QFileInfo fi(fn);
     workingDir = fi.absolutePath();
@@ -12217,32 +12329,78 @@ void ApplicationWindow::appendProject(const QString &fn)
     QApplication::restoreOverrideCursor();
 }
 
-void ApplicationWindow::rawSaveFolder(Folder *folder, QIODevice *device)
+//! Return the line starting a subfolder in a project file
+static QString folderStartTag(Folder *folder, bool current)
+{
+    QString tag = "<folder>\t" + QString(folder->name()) + "\t" + folder->birthDate() + "\t"
+            + folder->modificationDate();
+    if (current)
+        return tag + "\tcurrent\n";
+    return tag + "\n"; // FIXME: Having no 5th string here is not a good idea
+}
+
+void ApplicationWindow::rawSaveFolder(Folder *folder, QIODevice *device, bool binary_data)
 {
     QTextStream stream(device);
     stream.setCodec(QTextCodec::codecForName("UTF-8"));
     foreach (MyWidget *w, folder->windowsList()) {
         Table *t = qobject_cast<Table *>(w);
+        Matrix *m = qobject_cast<Matrix *>(w);
         if (t)
-            t->saveToDevice(device, windowGeometryInfo(w));
-        else
+            t->saveToDevice(device, windowGeometryInfo(w), binary_data);
+        else if (m)
+            m->saveToDevice(device, windowGeometryInfo(w), binary_data);
+        else {
             stream << w->saveToString(windowGeometryInfo(w));
+            stream.flush();
+        }
     }
     foreach (Folder *subfolder, folder->folders()) {
-        stream << "<folder>\t" + QString(subfolder->name()) + "\t" + subfolder->birthDate() + "\t"
-                        + subfolder->modificationDate();
-        if (subfolder == current_folder)
-            stream << "\tcurrent\n";
-        else
-            stream << "\n"; // FIXME: Having no 5th string here is not a good idea
+        stream << folderStartTag(subfolder, subfolder == current_folder);
         stream.flush();
-        rawSaveFolder(subfolder, device);
+        rawSaveFolder(subfolder, device, binary_data);
         stream << "</folder>\n";
     }
 }
 
+//! Flush \c file and make sure its content has reached the disk
+static bool syncFile(QFile &file)
+{
+#ifdef Q_OS_WIN
+    // this one was taken from
+    // http://support.microsoft.com/kb/148505/en-us
+    // http://msdn.microsoft.com/en-us/library/17618685(VS.80).aspx
+    return file.flush() && _commit(file.handle()) == 0;
+#else
+    return file.flush() && fsync(file.handle()) == 0;
+#endif
+}
+
+//! Replace \c fn by \c fn.new, keeping the previous version as \c fn~
+/**
+ * Second part of the secure file saving procedure in saveFolder(). Sets errno on failure.
+ */
+static bool replaceByNewFile(const QString &fn)
+{
+#ifdef Q_OS_WIN
+    // unfortunately, Windows doesn't support atomic renames; so Windows users will have to live
+    // with the risk of losing the file in case of a crash between remove and rename
+    return !((QFile::exists(fn)
+              && ((QFile::exists(fn + "~") && !QFile::remove(fn + "~"))
+                  || !QFile::rename(fn, fn + "~")))
+             || !QFile::rename(fn + ".new", fn));
+#else
+    // we want to atomically replace existing files, so we can't use QFile::rename()
+    return !((QFile::exists(fn) && rename(QFile::encodeName(fn), QFile::encodeName(fn + "~")) != 0)
+             || rename(QFile::encodeName(fn + ".new"), QFile::encodeName(fn)) != 0);
+#endif
+}
+
 void ApplicationWindow::saveFolder(Folder *folder, const QString &fn)
 {
+    // an autosave might be writing to the same file
+    waitForAutoSave();
+
     // file saving procedure follows
     // https://bugs.launchpad.net/ubuntu/+source/linux/+bug/317781/comments/54
     QFile f(fn + ".new");
@@ -12264,24 +12422,27 @@ void ApplicationWindow::saveFolder(Folder *folder, const QString &fn)
 
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
-    QTextStream t(&f);
+    // compressed projects are compressed on the fly
+    int level = getSettings().value("/General/CompressionLevel", GzipDevice::default_level).toInt();
+    GzipDevice gzip(&f, level);
+    QIODevice *device = &f;
+    if (fn.endsWith(".gz") && gzip.open(QIODevice::WriteOnly))
+        device = &gzip;
+
+    QTextStream t(device);
     t.setCodec(QTextCodec::codecForName("UTF-8"));
     t << SciDAVis::schemaVersion() + " project file\n";
     t << "<scripting-lang>\t" + QString(scriptEnv->objectName()) + "\n";
     t << "<windows>\t" + QString::number(folder->windowCount(true)) + "\n";
     t.flush();
-    rawSaveFolder(folder, &f);
+    rawSaveFolder(folder, device,
+                  getSettings().value("/General/BinaryProjectData", false).toBool());
     t << "<log>\n" + logInfo + "</log>";
+    t.flush();
+    gzip.close();
 
     // second part of secure file saving (see comment at the start of this method)
-#ifdef Q_OS_WIN
-    // this one was taken from
-    // http://support.microsoft.com/kb/148505/en-us
-    // http://msdn.microsoft.com/en-us/library/17618685(VS.80).aspx
-    if (!f.flush() || _commit(f.handle()) != 0) {
-#else
-    if (!f.flush() || fsync(f.handle()) != 0) {
-#endif
+    if (!syncFile(f)) {
         QApplication::restoreOverrideCursor();
         QMessageBox::critical(
                 this, tr("Error writing data to disk"),
@@ -12294,17 +12455,7 @@ void ApplicationWindow::saveFolder(Folder *folder, const QString &fn)
         return;
     }
     f.close();
-#ifdef Q_OS_WIN
-    // unfortunately, Windows doesn't support atomic renames; so Windows users will have to live
-    // with the risk of losing the file in case of a crash between remove and rename
-    if ((QFile::exists(fn)
-         && ((QFile::exists(fn + "~") && !QFile::remove(fn + "~")) || !QFile::rename(fn, fn + "~")))
-        || !QFile::rename(fn + ".new", fn)) {
-#else
-    // we want to atomically replace existing files, so we can't use QFile::rename()
-    if ((QFile::exists(fn) && rename(QFile::encodeName(fn), QFile::encodeName(fn + "~")) != 0)
-        || rename(QFile::encodeName(fn + ".new"), QFile::encodeName(fn)) != 0) {
-#endif
+    if (!replaceByNewFile(fn)) {
         QApplication::restoreOverrideCursor();
         QMessageBox::critical(
                 this, tr("Error renaming backup files"),
@@ -12323,6 +12474,169 @@ void ApplicationWindow::saveFolder(Folder *folder, const QString &fn)
     QApplication::restoreOverrideCursor();
 }
 
+struct ApplicationWindow::AutoSave
+{
+    //! Either text to be written as is, or a table or matrix with its window geometry as text
+    struct Piece
+    {
+        QString text;
+        std::unique_ptr<future::Table> table;
+        std::unique_ptr<future::Matrix> matrix;
+    };
+
+    ~AutoSave()
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    void append(const QString &text)
+    {
+        if (pieces.empty() || pieces.back().table || pieces.back().matrix)
+            pieces.emplace_back();
+        pieces.back().text += text;
+    }
+    void appendTable(future::Table *table, const QString &geometry)
+    {
+        pieces.emplace_back();
+        pieces.back().text = geometry;
+        pieces.back().table.reset(table);
+    }
+    void appendMatrix(future::Matrix *matrix, const QString &geometry)
+    {
+        pieces.emplace_back();
+        pieces.back().text = geometry;
+        pieces.back().matrix.reset(matrix);
+    }
+
+    //! Write the project file; runs in #thread
+    void write();
+
+    QString file_name;
+    bool binary_data = true;
+    int compression_level = GzipDevice::default_level;
+    std::vector<Piece> pieces;
+    std::thread thread;
+    std::atomic<bool> done{ false };
+    //! Description of what went wrong, empty on success
+    QString error;
+};
+
+void ApplicationWindow::AutoSave::write()
+{
+    QFile f(file_name + ".new");
+    if (!f.open(QIODevice::WriteOnly)) {
+        error = ApplicationWindow::tr("The file: <br><b>%1</b> is opened in read-only mode")
+                        .arg(file_name + ".new");
+        return;
+    }
+    GzipDevice gzip(&f, compression_level);
+    QIODevice *device = &f;
+    if (file_name.endsWith(".gz") && gzip.open(QIODevice::WriteOnly))
+        device = &gzip;
+
+    QTextStream t(device);
+    t.setCodec(QTextCodec::codecForName("UTF-8"));
+    for (const Piece &piece : pieces) {
+        if (piece.table) {
+            t.flush();
+            Table::saveToDevice(piece.table.get(), device, piece.text, binary_data);
+        } else if (piece.matrix) {
+            t.flush();
+            Matrix::saveToDevice(piece.matrix.get(), device, piece.text, binary_data);
+        } else
+            t << piece.text;
+    }
+    t.flush();
+    gzip.close();
+    if (!syncFile(f)) {
+        error = ApplicationWindow::tr("Writing <em>%1</em> failed: %2")
+                        .arg(file_name + ".new")
+                        .arg(QString::fromLocal8Bit(strerror(errno)));
+        return;
+    }
+    f.close();
+
+    if (!replaceByNewFile(file_name))
+        error = ApplicationWindow::tr("Moving <em>%1</em> to <em>%2</em> failed: %3")
+                        .arg(file_name + ".new")
+                        .arg(file_name)
+                        .arg(QString::fromLocal8Bit(strerror(errno)));
+}
+
+void ApplicationWindow::snapshotFolder(Folder *folder, AutoSave &save)
+{
+    foreach (MyWidget *w, folder->windowsList()) {
+        Table *t = qobject_cast<Table *>(w);
+        Matrix *m = qobject_cast<Matrix *>(w);
+        if (t && t->d_future_table)
+            save.appendTable(t->d_future_table->snapshot(), windowGeometryInfo(w));
+        else if (m)
+            save.appendMatrix(m->d_future_matrix->snapshot(), windowGeometryInfo(w));
+        else
+            save.append(w->saveToString(windowGeometryInfo(w)));
+    }
+    foreach (Folder *subfolder, folder->folders()) {
+        save.append(folderStartTag(subfolder, subfolder == current_folder));
+        snapshotFolder(subfolder, save);
+        save.append("</folder>\n");
+    }
+}
+
+void ApplicationWindow::autoSaveProject()
+{
+    if (needsNewFileName(projectname)) {
+        saveProject();
+        return;
+    }
+    // the previous autosave is still being written, so the disk is busy enough already
+    if (d_autosave)
+        return;
+
+    d_autosave.reset(new AutoSave);
+    AutoSave &save = *d_autosave;
+    save.file_name = projectname;
+    save.binary_data = getSettings().value("/General/BinaryProjectData", false).toBool();
+    save.compression_level =
+            getSettings().value("/General/CompressionLevel", GzipDevice::default_level).toInt();
+    save.append(SciDAVis::schemaVersion() + " project file\n");
+    save.append("<scripting-lang>\t" + QString(scriptEnv->objectName()) + "\n");
+    save.append("<windows>\t" + QString::number(projectFolder()->windowCount(true)) + "\n");
+    snapshotFolder(projectFolder(), save);
+    save.append("<log>\n" + logInfo + "</log>");
+
+    // changes made from now on mark the project as modified again
+    setWindowTitle("SciDAVis - " + projectname);
+    savedProject();
+    actionUndo->setEnabled(false);
+    actionRedo->setEnabled(false);
+
+    save.thread = std::thread([this, &save]() {
+        save.write();
+        save.done = true;
+        QMetaObject::invokeMethod(this, "finishAutoSave", Qt::QueuedConnection);
+    });
+}
+
+void ApplicationWindow::finishAutoSave()
+{
+    // the notification may arrive after waitForAutoSave() has already started the next autosave
+    if (d_autosave && d_autosave->done)
+        waitForAutoSave();
+}
+
+void ApplicationWindow::waitForAutoSave()
+{
+    if (!d_autosave)
+        return;
+    std::unique_ptr<AutoSave> save(std::move(d_autosave));
+    save->thread.join();
+    if (save->error.isEmpty())
+        return;
+    modifiedProject();
+    QMessageBox::critical(this, tr("Autosave failed"), save->error);
+}
+
 void ApplicationWindow::saveAsProject()
 {
     saveFolderAsProject(current_folder);
@@ -12343,15 +12657,10 @@ void ApplicationWindow::saveFolderAsProject(Folder *f)
         if (!baseName.endsWith(".sciprj") && !baseName.endsWith(".sciprj.gz")) {
             fn.append(".sciprj");
         }
-        bool compress = false;
-        if (fn.endsWith(".gz")) {
-            fn = fn.left(fn.length() - 3);
-            compress = true;
-        }
+        if (selectedFilter.contains(".gz") && !fn.endsWith(".gz"))
+            fn.append(".gz");
 
         saveFolder(f, fn);
-        if (selectedFilter.contains(".gz") || compress)
-            file_compress(QFile::encodeName(fn).constData(), "wb9");
     }
 }
 
@@ -13696,6 +14005,15 @@ void ApplicationWindow::showHistory()
     QUndoView undo_view(d_project->undoStack());
 
     layout.addWidget(&undo_view);
+    QLabel memory_label;
+    auto update_memory_label = [&memory_label]() {
+        memory_label.setText(tr("Memory used: %1 MB (%2 MB moved to disk)")
+                                     .arg(UndoMemory::usage() / (1024. * 1024.), 0, 'f', 1)
+                                     .arg(UndoMemory::diskUsage() / (1024. * 1024.), 0, 'f', 1));
+    };
+    update_memory_label();
+    connect(d_project->undoStack(), &QUndoStack::indexChanged, &memory_label, update_memory_label);
+    layout.addWidget(&memory_label);
     layout.addWidget(&button_box);
 
     dialog.setWindowTitle(tr("Undo/Redo History"));
@@ -48,6 +48,8 @@
 #include <QMdiArea>
 #include <QSettings>
 
+#include <memory>
+
 #ifdef _MSC_VER
 #define NOMINMAX
 #endif
@@ -58,6 +60,7 @@
 #include "SciDAVisObject.h"
 
 class QPixmap;
+class QTemporaryFile;
 class QCloseEvent;
 class QDropEvent;
 class QTimerEvent;
@@ -179,11 +182,11 @@ public slots:
     void open();
     /// args are any argument to be passed to fn if a script
     ApplicationWindow *open(const QString &fn, const QStringList &args = QStringList());
-    //! Returns temporary file ready for reading uncompressed content
+    //! Returns a device reading the uncompressed content of a gzip-compressed file
     /**
      * Close and delete after you're done with it.
      */
-    QFile *openCompressedFile(const QString &fn);
+    QIODevice *openCompressedFile(const QString &fn);
     ApplicationWindow *openProject(const QString &fn);
     ///* load project file \a into this
     ///* @return true if project load successful
@@ -219,6 +222,13 @@ public slots:
 
     void saveProjectAs();
     bool saveProject();
+    //! Save a snapshot of the project in a background thread
+    /**
+     * Takes a copy-on-write snapshot of all tables and matrices and serializes the remaining
+     * windows, which is cheap, then writes and compresses the project file in a background
+     * thread. Falls back to saveProject() if the project has no file name yet.
+     */
+    void autoSaveProject();
 
     //! Set the project status to modifed
     void modifiedProject();
@@ -700,6 +710,8 @@ public slots:
     void showSmoothSavGolDialog();
     void showSmoothFFTDialog();
     void showSmoothAverageDialog();
+    void showSmoothMedianDialog();
+    void showSmoothExponentialDialog();
     void showSmoothDialog(int m);
     void showFilterDialog(int filter);
     void lowPassFilterDialog();
@@ -875,7 +887,8 @@ public slots:
     void saveAsProject();
     void saveFolderAsProject(Folder *f);
     void saveFolder(Folder *folder, const QString &fn);
-    void rawSaveFolder(Folder *folder, QIODevice *device);
+    //! Write the windows of \c folder and its subfolders, see Table::saveToDevice()
+    void rawSaveFolder(Folder *folder, QIODevice *device, bool binary_data);
 
     //!  adds a folder list item to the list view "lv"
     void addFolderListViewItem(Folder *f);
@@ -991,6 +1004,8 @@ public:
     enum { MaxRecentProjects = 10 };
     //! File version code used when opening project files (= maj * 100 + min * 10 + patch)
     int d_file_version;
+    //! While opening a project lazily, the file holding the XML of tables and matrices not read yet
+    std::shared_ptr<QTemporaryFile> d_pending_xml;
 
     QColor workspaceColor, panelsColor, panelsTextColor;
     QString appStyle, workingDir;
@@ -1014,6 +1029,8 @@ public:
     int majTicksLength, minTicksLength, defaultPlotMargin;
     int defaultCurveStyle, defaultCurveLineWidth, defaultSymbolSize;
     int undoLimit;
+    //! Memory the undo history may use before moving data to disk, in MB
+    int undoMemoryLimit;
     QFont appFont, plot3DTitleFont, plot3DNumbersFont, plot3DAxesFont;
     QFont tableTextFont, tableHeaderFont, plotAxesFont, plotLegendFont, plotNumbersFont,
             plotTitleFont;
@@ -1071,6 +1088,14 @@ protected:
 private:
     bool m_batch;
 
+    //! A project snapshot being written by autoSaveProject()
+    struct AutoSave;
+    std::unique_ptr<AutoSave> d_autosave;
+    //! Build the part of an autosave snapshot which corresponds to rawSaveFolder()
+    void snapshotFolder(Folder *folder, AutoSave &save);
+    //! Wait until a running autosave is written and report errors
+    void waitForAutoSave();
+
     //! Create a menu for toggeling the toolbars
     QMenu *createToolbarsMenu();
 
@@ -1164,7 +1189,8 @@ private:
             *actionPlot3DWireSurface;
     QAction *actionColorMap, *actionContourMap, *actionGrayMap;
     QAction *actionDeleteFitTables, *actionShowGridDialog, *actionTimeStamp;
-    QAction *actionSmoothSavGol, *actionSmoothFFT, *actionSmoothAverage, *actionFFT;
+    QAction *actionSmoothSavGol, *actionSmoothFFT, *actionSmoothAverage, *actionSmoothMedian;
+    QAction *actionSmoothExponential, *actionFFT;
     QAction *actionLowPassFilter, *actionHighPassFilter, *actionBandPassFilter,
             *actionBandBlockFilter;
     QAction *actionConvolute, *actionDeconvolute, *actionCorrelate, *actionAutoCorrelate;
@@ -1241,6 +1267,8 @@ private slots:
 
     void handleAspectAdded(const AbstractAspect *aspect, int index);
     void handleAspectAboutToBeRemoved(const AbstractAspect *aspect, int index);
+    //! Called when the thread of an autosave is done, see waitForAutoSave()
+    void finishAutoSave();
 protected slots:
     void lockToolbar(const bool status);
 };
@@ -0,0 +1,387 @@
+/***************************************************************************
+    File                 : AutoDiffFormula.cpp
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Evaluate a formula together with its parameter gradient
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#include "AutoDiffFormula.h"
+
+#include <gsl/gsl_math.h>
+#include <gsl/gsl_sf_erf.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+double sign(double x)
+{
+    return x > 0 ? 1.0 : (x < 0 ? -1.0 : 0.0);
+}
+double zero(double)
+{
+    return 0.0;
+}
+
+//! Elementary functions together with their first derivatives
+const struct
+{
+    const char *name;
+    double (*f)(double);
+    double (*df)(double);
+} functions[] = {
+    { "sin", [](double x) { return sin(x); }, [](double x) { return cos(x); } },
+    { "cos", [](double x) { return cos(x); }, [](double x) { return -sin(x); } },
+    { "tan", [](double x) { return tan(x); }, [](double x) { return 1.0 + tan(x) * tan(x); } },
+    { "asin", [](double x) { return asin(x); },
+      [](double x) { return 1.0 / sqrt(1.0 - x * x); } },
+    { "acos", [](double x) { return acos(x); },
+      [](double x) { return -1.0 / sqrt(1.0 - x * x); } },
+    { "atan", [](double x) { return atan(x); }, [](double x) { return 1.0 / (1.0 + x * x); } },
+    { "sinh", [](double x) { return sinh(x); }, [](double x) { return cosh(x); } },
+    { "cosh", [](double x) { return cosh(x); }, [](double x) { return sinh(x); } },
+    { "tanh", [](double x) { return tanh(x); },
+      [](double x) { return 1.0 - tanh(x) * tanh(x); } },
+    { "asinh", [](double x) { return asinh(x); },
+      [](double x) { return 1.0 / sqrt(x * x + 1.0); } },
+    { "acosh", [](double x) { return acosh(x); },
+      [](double x) { return 1.0 / sqrt(x * x - 1.0); } },
+    { "atanh", [](double x) { return atanh(x); }, [](double x) { return 1.0 / (1.0 - x * x); } },
+    { "exp", [](double x) { return exp(x); }, [](double x) { return exp(x); } },
+    { "ln", [](double x) { return log(x); }, [](double x) { return 1.0 / x; } },
+    { "log", [](double x) { return log10(x); }, [](double x) { return 1.0 / (x * M_LN10); } },
+    { "log10", [](double x) { return log10(x); }, [](double x) { return 1.0 / (x * M_LN10); } },
+    { "log2", [](double x) { return log2(x); }, [](double x) { return 1.0 / (x * M_LN2); } },
+    { "sqrt", [](double x) { return sqrt(x); }, [](double x) { return 0.5 / sqrt(x); } },
+    { "abs", [](double x) { return fabs(x); }, sign },
+    { "sign", sign, zero },
+    { "rint", [](double x) { return rint(x); }, zero },
+    { "floor", [](double x) { return floor(x); }, zero },
+    { "ceil", [](double x) { return ceil(x); }, zero },
+    { "erf", [](double x) { return gsl_sf_erf(x); },
+      [](double x) { return M_2_SQRTPI * exp(-x * x); } },
+    { "erfc", [](double x) { return gsl_sf_erfc(x); },
+      [](double x) { return -M_2_SQRTPI * exp(-x * x); } },
+    { nullptr, nullptr, nullptr }
+};
+} // namespace
+
+//! Recursive descent parser generating the stack program
+/**
+ * Precedences follow muParser: + and - bind weakest, then * and /, then unary signs; ^ binds
+ * strongest and is right-associative (so -x^2 means -(x^2) and 2^-1 is allowed).
+ */
+class AutoDiffFormula::Parser
+{
+public:
+    Parser(const QString &input, const QStringList &parameters, const QString &variable,
+           std::vector<Instruction> &program)
+        : d_input(input), d_parameters(parameters), d_variable(variable), d_program(program)
+    {
+    }
+
+    //! Parse the whole input, returning false on anything not supported.
+    bool parse()
+    {
+        if (!expression())
+            return false;
+        skipSpace();
+        return d_pos == d_input.size();
+    }
+
+    int maxDepth() const { return d_maxDepth; }
+
+private:
+    bool expression()
+    {
+        if (!term())
+            return false;
+        for (;;) {
+            QChar c = peek();
+            if (c != '+' && c != '-')
+                return true;
+            d_pos++;
+            if (!term())
+                return false;
+            append(c == '+' ? Add : Subtract);
+        }
+    }
+
+    bool term()
+    {
+        if (!unary())
+            return false;
+        for (;;) {
+            QChar c = peek();
+            if (c != '*' && c != '/')
+                return true;
+            d_pos++;
+            if (!unary())
+                return false;
+            append(c == '*' ? Multiply : Divide);
+        }
+    }
+
+    bool unary()
+    {
+        QChar c = peek();
+        if (c == '-' || c == '+') {
+            d_pos++;
+            if (!unary())
+                return false;
+            if (c == '-')
+                append(Negate);
+            return true;
+        }
+        return power();
+    }
+
+    bool power()
+    {
+        if (!primary())
+            return false;
+        if (peek() != '^')
+            return true;
+        d_pos++;
+        if (!unary())
+            return false;
+        append(Power);
+        return true;
+    }
+
+    bool primary()
+    {
+        QChar c = peek();
+        if (c == '(') {
+            d_pos++;
+            if (!expression() || peek() != ')')
+                return false;
+            d_pos++;
+            return true;
+        }
+        if (c.isDigit() || c == '.')
+            return number();
+        if (c.isLetter() || c == '_')
+            return name();
+        return false;
+    }
+
+    bool number()
+    {
+        int start = d_pos;
+        while (d_pos < d_input.size() && (d_input.at(d_pos).isDigit() || d_input.at(d_pos) == '.'))
+            d_pos++;
+        if (d_pos < d_input.size() && (d_input.at(d_pos) == 'e' || d_input.at(d_pos) == 'E')) {
+            int exponent = d_pos + 1;
+            if (exponent < d_input.size()
+                && (d_input.at(exponent) == '+' || d_input.at(exponent) == '-'))
+                exponent++;
+            if (exponent < d_input.size() && d_input.at(exponent).isDigit()) {
+                d_pos = exponent;
+                while (d_pos < d_input.size() && d_input.at(d_pos).isDigit())
+                    d_pos++;
+            }
+        }
+        bool ok;
+        double value = d_input.mid(start, d_pos - start).toDouble(&ok);
+        if (!ok)
+            return false;
+        append(Constant, value);
+        return true;
+    }
+
+    bool name()
+    {
+        int start = d_pos;
+        while (d_pos < d_input.size()
+               && (d_input.at(d_pos).isLetterOrNumber() || d_input.at(d_pos) == '_'))
+            d_pos++;
+        QString name = d_input.mid(start, d_pos - start);
+
+        if (peek() == '(') {
+            for (int i = 0; functions[i].name; i++)
+                if (name == functions[i].name) {
+                    d_pos++;
+                    if (!expression() || peek() != ')')
+                        return false;
+                    d_pos++;
+                    append(Function, 0.0, i);
+                    return true;
+                }
+            return false;
+        }
+
+        if (name == d_variable)
+            append(Variable);
+        else if (d_parameters.contains(name))
+            append(Parameter, 0.0, d_parameters.indexOf(name));
+        else if (name == "pi" || name == "Pi" || name == "PI" || name == "_pi")
+            append(Constant, M_PI);
+        else if (name == "e" || name == "E" || name == "_e")
+            append(Constant, M_E);
+        else
+            return false;
+        return true;
+    }
+
+    QChar peek()
+    {
+        skipSpace();
+        return d_pos < d_input.size() ? d_input.at(d_pos) : QChar();
+    }
+
+    void skipSpace()
+    {
+        while (d_pos < d_input.size() && d_input.at(d_pos).isSpace())
+            d_pos++;
+    }
+
+    void append(Opcode op, double value = 0.0, int index = 0)
+    {
+        d_program.push_back({ op, value, index });
+        switch (op) {
+        case Constant:
+        case Variable:
+        case Parameter:
+            d_maxDepth = std::max(d_maxDepth, ++d_depth);
+            break;
+        case Add:
+        case Subtract:
+        case Multiply:
+        case Divide:
+        case Power:
+            d_depth--;
+            break;
+        case Negate:
+        case Function:
+            break;
+        }
+    }
+
+    const QString &d_input;
+    const QStringList &d_parameters;
+    const QString &d_variable;
+    std::vector<Instruction> &d_program;
+    int d_pos = 0;
+    int d_depth = 0;
+    int d_maxDepth = 0;
+};
+
+bool AutoDiffFormula::compile(const QString &formula, const QStringList &parameters,
+                              const QString &variable)
+{
+    d_program.clear();
+    d_parameters = parameters.size();
+    Parser parser(formula, parameters, variable, d_program);
+    if (!parser.parse()) {
+        d_program.clear();
+        return false;
+    }
+    d_stackDepth = parser.maxDepth();
+    d_stack.resize(d_stackDepth * (d_parameters + 1));
+    return true;
+}
+
+double AutoDiffFormula::evaluate(double x, const double *parameters, double *gradient) const
+{
+    // each stack entry is a dual number: the value followed by its partial derivatives
+    const int width = d_parameters + 1;
+    double *top = d_stack.data() - width;
+    for (const Instruction &instruction : d_program) {
+        switch (instruction.op) {
+        case Constant:
+        case Variable:
+        case Parameter:
+            top += width;
+            std::fill_n(top + 1, d_parameters, 0.0);
+            if (instruction.op == Constant)
+                top[0] = instruction.value;
+            else if (instruction.op == Variable)
+                top[0] = x;
+            else {
+                top[0] = parameters[instruction.index];
+                top[1 + instruction.index] = 1.0;
+            }
+            break;
+        case Add:
+            top -= width;
+            for (int k = 0; k < width; k++)
+                top[k] += top[width + k];
+            break;
+        case Subtract:
+            top -= width;
+            for (int k = 0; k < width; k++)
+                top[k] -= top[width + k];
+            break;
+        case Multiply: {
+            top -= width;
+            const double *rhs = top + width;
+            for (int k = 1; k < width; k++)
+                top[k] = top[k] * rhs[0] + top[0] * rhs[k];
+            top[0] *= rhs[0];
+            break;
+        }
+        case Divide: {
+            top -= width;
+            const double *rhs = top + width;
+            double quotient = top[0] / rhs[0];
+            for (int k = 1; k < width; k++)
+                top[k] = (top[k] - quotient * rhs[k]) / rhs[0];
+            top[0] = quotient;
+            break;
+        }
+        case Power: {
+            top -= width;
+            const double *rhs = top + width;
+            double base = top[0];
+            double result = pow(base, rhs[0]);
+            bool constantExponent =
+                    std::all_of(rhs + 1, rhs + width, [](double d) { return d == 0; });
+            if (constantExponent) {
+                // also valid for negative bases
+                double factor = rhs[0] == 0 ? 0.0 : rhs[0] * pow(base, rhs[0] - 1.0);
+                for (int k = 1; k < width; k++)
+                    top[k] *= factor;
+            } else {
+                double logBase = log(base);
+                for (int k = 1; k < width; k++)
+                    top[k] = result * (rhs[k] * logBase + rhs[0] * top[k] / base);
+            }
+            top[0] = result;
+            break;
+        }
+        case Negate:
+            for (int k = 0; k < width; k++)
+                top[k] = -top[k];
+            break;
+        case Function: {
+            double factor = functions[instruction.index].df(top[0]);
+            top[0] = functions[instruction.index].f(top[0]);
+            for (int k = 1; k < width; k++)
+                top[k] *= factor;
+            break;
+        }
+        }
+    }
+    std::copy(top + 1, top + width, gradient);
+    return top[0];
+}
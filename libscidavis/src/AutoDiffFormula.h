@@ -0,0 +1,92 @@
+/***************************************************************************
+    File                 : AutoDiffFormula.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Evaluate a formula together with its parameter gradient
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef AUTODIFFFORMULA_H
+#define AUTODIFFFORMULA_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+//! Forward-mode automatic differentiation of fit formulas
+/**
+ * Parses the subset of muParser syntax typically used for fit functions (arithmetic operators,
+ * powers, parentheses, numbers, the constants pi and e and elementary one-argument functions) into
+ * a stack program. evaluate() runs this program on dual numbers, yielding the value of the formula
+ * and its exact partial derivatives with respect to all parameters in a single pass.
+ *
+ * Anything else (comparisons, the ternary operator, multiple statements, special functions, user
+ * variables) makes compile() fail; callers are expected to fall back to numerical differentiation
+ * in this case. Since muParser is the reference, callers should also compare a few values
+ * against the script before trusting the gradients (see Fit::evaluate_df()).
+ *
+ * An instance keeps its evaluation stack as scratch space, so it must not be used by several
+ * threads at once; copies are independent, though.
+ */
+class AutoDiffFormula
+{
+public:
+    //! Compile \c formula as a function of \c variable and \c parameters.
+    /**
+     * Returns false if the formula uses constructs not supported here.
+     */
+    bool compile(const QString &formula, const QStringList &parameters,
+                 const QString &variable = "x");
+    //! Return whether the last call to compile() succeeded.
+    bool isCompiled() const { return !d_program.empty(); }
+    //! Forget the compiled formula.
+    void clear() { d_program.clear(); }
+    //! Return the number of parameters the formula was compiled for.
+    int numParameters() const { return d_parameters; }
+
+    //! Evaluate the formula at \c x.
+    /**
+     * \param x value of the variable
+     * \param parameters numParameters() parameter values
+     * \param gradient receives the numParameters() partial derivatives
+     */
+    double evaluate(double x, const double *parameters, double *gradient) const;
+
+private:
+    enum Opcode { Constant, Variable, Parameter, Add, Subtract, Multiply, Divide, Power, Negate,
+                  Function };
+    struct Instruction
+    {
+        Opcode op;
+        double value;
+        int index;
+    };
+
+    class Parser;
+
+    std::vector<Instruction> d_program;
+    int d_parameters = 0;
+    int d_stackDepth = 0;
+    mutable std::vector<double> d_stack;
+};
+
+#endif // ifndef AUTODIFFFORMULA_H
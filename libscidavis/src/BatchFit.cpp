@@ -0,0 +1,196 @@
+/***************************************************************************
+    File                 : BatchFit.cpp
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Fit one model to many data sets using several threads
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#include "BatchFit.h"
+#include "ApplicationWindow.h"
+#include "Fit.h"
+#include "Table.h"
+#include "core/column/Column.h"
+#include "lib/ParallelFor.h"
+
+#include <gsl/gsl_errno.h>
+
+#include <QApplication>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+BatchFit::BatchFit(ApplicationWindow *parent, FitFactory factory)
+    : QObject(parent), d_factory(factory)
+{
+}
+
+void BatchFit::addDataSet(Table *table, const QString &xColName, const QString &yColName)
+{
+    d_data_sets << DataSet{ table, xColName, yColName };
+}
+
+void BatchFit::setDataRange(double from, double to)
+{
+    d_from = std::min(from, to);
+    d_to = std::max(from, to);
+}
+
+void BatchFit::setRandomStarts(int starts, double spread)
+{
+    d_starts = std::max(1, starts);
+    d_spread = spread;
+}
+
+Table *BatchFit::run(const QString &tableName)
+{
+    std::unique_ptr<Fit> model(d_factory());
+    if (!model)
+        return nullptr;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    // Fit objects and their scripts must be created in the GUI thread
+    std::vector<std::unique_ptr<Fit>> fits;
+    std::vector<int> fitDataSet;
+    QStringList messages;
+    // a fixed seed makes repeated batch fits give the same results
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> perturbation(-d_spread, d_spread);
+    // linear fits don't depend on the initial guesses
+    int starts = model->isNonLinear() ? d_starts : 1;
+    for (int i = 0; i < d_data_sets.size(); i++) {
+        const DataSet &set = d_data_sets.at(i);
+        messages << QString();
+        for (int start = 0; start < starts; start++) {
+            std::unique_ptr<Fit> fit(d_factory());
+            if (!fit)
+                break;
+            if (!fit->setDataFromTable(set.table, set.xColName, set.yColName, d_from, d_to)) {
+                messages[i] = tr("Invalid or too few data points");
+                break;
+            }
+            QString error = fit->fitError();
+            if (!error.isEmpty()) {
+                messages[i] = error;
+                break;
+            }
+            if (start > 0)
+                for (int p = 0; p < fit->numParameters(); p++) {
+                    double guess = fit->initialGuess(p);
+                    double scale = guess == 0.0 ? 1.0 : fabs(guess);
+                    fit->setInitialGuess(p, guess + scale * perturbation(generator));
+                }
+            fit->initScript();
+            // the fits are all part of the model's job, so they are cancelled together
+            fit->d_parent_job = model.get();
+            fits.push_back(std::move(fit));
+            fitDataSet.push_back(i);
+        }
+    }
+
+    int count = fits.size();
+    std::vector<int> iterations(count, 0), status(count, GSL_FAILURE);
+    std::atomic<int> done(0);
+    auto computeFits = [&](int, int begin, int end) {
+        for (int k = begin; k < end && !model->isCancelled(); k++) {
+            fits[k]->computeFit(iterations[k], status[k]);
+            model->setProgress(double(++done) / count);
+        }
+    };
+    // fit functions in other languages than muParser have to be evaluated in the GUI thread
+    bool parallel = std::all_of(fits.begin(), fits.end(), [](const std::unique_ptr<Fit> &fit) {
+        return fit->canComputeInBackground();
+    });
+    if (parallel) {
+        if (!model->runInBackground(
+                    [&]() { parallelFor(0, count, parallelChunks(count, 1), computeFits); })) {
+            QApplication::restoreOverrideCursor();
+            return nullptr;
+        }
+    } else
+        computeFits(0, 0, count);
+
+    // of several starts, take the successful one with the smallest chi^2
+    std::vector<int> best(d_data_sets.size(), -1);
+    for (int k = 0; k < count; k++) {
+        int &b = best[fitDataSet[k]];
+        if (b < 0 || (status[k] == GSL_SUCCESS && status[b] != GSL_SUCCESS)
+            || (status[k] == GSL_SUCCESS && fits[k]->chiSquare() < fits[b]->chiSquare()))
+            b = k;
+    }
+
+    Column *tableCol = new Column(tr("Table"), SciDAVis::ColumnMode::Text);
+    Column *xCol = new Column(tr("X"), SciDAVis::ColumnMode::Text);
+    Column *yCol = new Column(tr("Y"), SciDAVis::ColumnMode::Text);
+    QList<Column *> valueCols, errorCols;
+    for (const QString &name : model->parameterNames()) {
+        valueCols << new Column(name, SciDAVis::ColumnMode::Numeric);
+        errorCols << new Column(name + "Err", SciDAVis::ColumnMode::Numeric);
+        errorCols.last()->setPlotDesignation(SciDAVis::yErr);
+    }
+    Column *chiCol = new Column(tr("ChiSquare"), SciDAVis::ColumnMode::Numeric);
+    Column *rCol = new Column(tr("RSquare"), SciDAVis::ColumnMode::Numeric);
+    Column *iterationsCol = new Column(tr("Iterations"), SciDAVis::ColumnMode::Numeric);
+    Column *statusCol = new Column(tr("Status"), SciDAVis::ColumnMode::Text);
+
+    // fill the columns before adding them to the table, so as not to generate undo commands
+    for (int i = 0; i < d_data_sets.size(); i++) {
+        const DataSet &set = d_data_sets.at(i);
+        tableCol->setTextAt(i, set.table ? set.table->name() : QString());
+        xCol->setTextAt(i, set.xColName);
+        yCol->setTextAt(i, set.yColName);
+        if (best[i] < 0) {
+            statusCol->setTextAt(i, messages.at(i));
+            continue;
+        }
+        Fit *fit = fits[best[i]].get();
+        const std::vector<double> &results = fit->results();
+        const std::vector<double> &errors = fit->errors();
+        for (int p = 0; p < valueCols.size() && p < int(results.size()); p++) {
+            valueCols[p]->setValueAt(i, results[p]);
+            errorCols[p]->setValueAt(i, errors[p]);
+        }
+        chiCol->setValueAt(i, fit->chiSquare());
+        rCol->setValueAt(i, fit->rSquare());
+        iterationsCol->setValueAt(i, iterations[best[i]]);
+        statusCol->setTextAt(i, QString::fromUtf8(gsl_strerror(status[best[i]])));
+    }
+
+    QList<Column *> columns;
+    columns << tableCol << xCol << yCol;
+    for (int p = 0; p < valueCols.size(); p++)
+        columns << valueCols[p] << errorCols[p];
+    columns << chiCol << rCol << iterationsCol << statusCol;
+
+    ApplicationWindow *app = (ApplicationWindow *)parent();
+    Table *t = app->newTable(
+            app->generateUniqueName(tableName.isEmpty() ? tr("BatchFit") : tableName),
+            tr("Batch fit of %1").arg(model->formula()), columns);
+    t->showNormal();
+
+    QApplication::restoreOverrideCursor();
+    return t;
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+    File                 : BatchFit.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Fit one model to many data sets using several threads
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef BATCHFIT_H
+#define BATCHFIT_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+
+#include <cfloat>
+#include <functional>
+
+class ApplicationWindow;
+class Fit;
+class Table;
+
+//! Fits the same model to many data sets and collects the results in one table
+/**
+ * All fits are set up in the GUI thread, using a factory function returning a Fit with model,
+ * initial guesses and solver settings already set; only the fitting itself (Fit::computeFit())
+ * is distributed among threads, and only if the model is evaluated by muParser (see
+ * Fit::canComputeInBackground()). In that case, a progress dialog allows cancelling the fits.
+ *
+ * Optionally, each data set is fitted several times starting from randomly perturbed initial
+ * guesses (multi-start), keeping the result with the smallest chi^2. This helps with models that
+ * have local minima.
+ */
+class BatchFit : public QObject
+{
+    Q_OBJECT
+
+public:
+    //! Returns a newly allocated Fit without data, which is deleted by BatchFit.
+    typedef std::function<Fit *()> FitFactory;
+
+    BatchFit(ApplicationWindow *parent, FitFactory factory);
+
+    //! Adds a data set given by two columns of a table (see Fit::setDataFromTable()).
+    void addDataSet(Table *table, const QString &xColName, const QString &yColName);
+    //! Restricts the fits to data with x values between \c from and \c to.
+    void setDataRange(double from, double to);
+    //! Fits each data set \c starts times, perturbing the initial guesses by up to \c spread.
+    /**
+     * \c spread is relative to the initial guess (absolute for initial guesses of zero). The
+     * first start always uses the unperturbed guesses; linear fits are only done once anyway.
+     */
+    void setRandomStarts(int starts, double spread = 0.5);
+
+    //! Does all fits and returns a new table with one row of results per data set.
+    /**
+     * Returns nullptr if the user cancelled the fits.
+     */
+    Table *run(const QString &tableName = QString());
+
+private:
+    struct DataSet
+    {
+        Table *table;
+        QString xColName;
+        QString yColName;
+    };
+
+    FitFactory d_factory;
+    QList<DataSet> d_data_sets;
+    double d_from = -DBL_MAX;
+    double d_to = DBL_MAX;
+    int d_starts = 1;
+    double d_spread = 0.5;
+};
+
+#endif // ifndef BATCHFIT_H
@@ -32,6 +32,8 @@
 #include "Graph.h"
 #include "Matrix.h"
 #include "ColorButton.h"
+#include "lib/GzipDevice.h"
+#include "lib/UndoMemory.h"
 
 #include <QLocale>
 #include <QPushButton>
@@ -556,13 +558,41 @@ void ConfigDialog::initAppPage()
     boxUndoLimit->setValue(app->undoLimit);
     topBoxLayout->addWidget(boxUndoLimit, 5, 1);
 
+    lblUndoMemoryLimit = new QLabel();
+    topBoxLayout->addWidget(lblUndoMemoryLimit, 6, 0);
+    boxUndoMemoryLimit = new QSpinBox();
+    boxUndoMemoryLimit->setRange(16, 1024 * 1024);
+    boxUndoMemoryLimit->setSingleStep(64);
+    boxUndoMemoryLimit->setValue(app->undoMemoryLimit);
+    topBoxLayout->addWidget(boxUndoMemoryLimit, 6, 1);
+
+    boxBinaryProjectData = new QCheckBox();
+    boxBinaryProjectData->setChecked(
+            ApplicationWindow::getSettings().value("/General/BinaryProjectData", false).toBool());
+    topBoxLayout->addWidget(boxBinaryProjectData, 7, 0, 1, 2);
+
+    boxLazyProjectLoading = new QCheckBox();
+    boxLazyProjectLoading->setChecked(
+            ApplicationWindow::getSettings().value("/General/LazyProjectLoading", false).toBool());
+    topBoxLayout->addWidget(boxLazyProjectLoading, 8, 0, 1, 2);
+
+    lblCompressionLevel = new QLabel();
+    topBoxLayout->addWidget(lblCompressionLevel, 9, 0);
+    boxCompressionLevel = new QSpinBox();
+    boxCompressionLevel->setRange(1, 9);
+    boxCompressionLevel->setValue(
+            ApplicationWindow::getSettings()
+                    .value("/General/CompressionLevel", GzipDevice::default_level)
+                    .toInt());
+    topBoxLayout->addWidget(boxCompressionLevel, 9, 1);
+
 #ifdef SEARCH_FOR_UPDATES
     boxSearchUpdates = new QCheckBox();
     boxSearchUpdates->setChecked(app->autoSearchUpdates);
-    topBoxLayout->addWidget(boxSearchUpdates, 6, 0, 1, 2);
+    topBoxLayout->addWidget(boxSearchUpdates, 10, 0, 1, 2);
 #endif
 
-    topBoxLayout->setRowStretch(7, 1);
+    topBoxLayout->setRowStretch(11, 1);
 
     appTabWidget->addTab(application, QString());
 
@@ -922,7 +952,23 @@ void ConfigDialog::languageChange()
     lblPanelsText->setText(tr("Panels text"));
     lblPanels->setText(tr("Panels"));
     lblUndoLimit->setText(tr("Undo/Redo History limit"));
+    lblUndoMemoryLimit->setText(tr("Undo/Redo History memory"));
+    lblUndoMemoryLimit->setToolTip(
+            tr("When the history needs more memory, the oldest data is moved to disk"));
+    boxUndoMemoryLimit->setSuffix(tr(" MB"));
     boxSave->setText(tr("Save every"));
+    boxBinaryProjectData->setText(tr("Save numeric data in compact binary form"));
+    boxBinaryProjectData->setToolTip(
+            tr("Makes saving and opening large projects much faster, but projects can't be "
+               "opened with older versions of SciDAVis any more."));
+    boxLazyProjectLoading->setText(tr("Read table and matrix data only when needed"));
+    boxLazyProjectLoading->setToolTip(
+            tr("When opening a project, the data of a table or matrix is read only once its "
+               "window is shown, it is plotted or used by a formula."));
+    lblCompressionLevel->setText(tr("Compression level of .gz projects"));
+    lblCompressionLevel->setToolTip(
+            tr("Lower levels save compressed projects considerably faster, at the cost of "
+               "slightly larger files."));
 #ifdef SEARCH_FOR_UPDATES
     boxSearchUpdates->setText(tr("Check for new versions at startup"));
 #endif
@@ -1138,6 +1184,14 @@ void ConfigDialog::apply()
     app->defaultScriptingLang = boxScriptingLanguage->currentText();
 
     app->undoLimit = boxUndoLimit->value(); // FIXME: can apply only after restart
+    app->undoMemoryLimit = boxUndoMemoryLimit->value();
+    UndoMemory::setBudget(qint64(app->undoMemoryLimit) * 1024 * 1024);
+    ApplicationWindow::getSettings().setValue("/General/BinaryProjectData",
+                                              boxBinaryProjectData->isChecked());
+    ApplicationWindow::getSettings().setValue("/General/LazyProjectLoading",
+                                              boxLazyProjectLoading->isChecked());
+    ApplicationWindow::getSettings().setValue("/General/CompressionLevel",
+                                              boxCompressionLevel->value());
 
     // general page: numeric format tab
     app->d_decimal_digits = boxAppPrecision->value();
@@ -146,6 +146,8 @@ private:
     QCheckBox *boxSearchUpdates, *boxOrthogonal, *logBox, *plotLabelBox, *scaleErrorsBox;
     QCheckBox *boxTitle, *boxFrame, *boxPlots3D, *boxPlots2D, *boxTables, *boxNotes, *boxFolders;
     QCheckBox *boxSave, *boxBackbones, *boxAllAxes, *boxShowLegend, *boxSmoothMesh;
+    QCheckBox *boxBinaryProjectData;
+    QCheckBox *boxLazyProjectLoading;
     QCheckBox *boxAutoscaling, *boxShowProjection, *boxMatrices, *boxScaleFonts, *boxResize,
             *boxUseGroupSeparator, *boxUseForeignSeparator, *boxConvertToTextColumn;
     QComboBox *boxMajTicks, *boxMinTicks, *boxStyle, *boxCurveStyle, *boxSeparator, *boxLanguage,
@@ -159,7 +161,7 @@ private:
             *boxAppPrecision;
     QSpinBox *boxCurveLineWidth, *boxSymbolSize, *boxMinTicksLength, *boxMajTicksLength,
             *generatePointsBox;
-    QSpinBox *boxUndoLimit;
+    QSpinBox *boxUndoLimit, *boxUndoMemoryLimit, *boxCompressionLevel;
     ColorButton *btnWorkspace, *btnPanels, *btnPanelsText;
     QListWidget *itemsList;
     QLabel *labelFrameWidth, *lblLanguage, *lblWorkspace, *lblPanels, *lblPageHeader;
@@ -171,7 +173,7 @@ private:
     QGroupBox *groupBox3DFonts, *groupBox3DCol;
     QLabel *lblMargin, *lblMajTicks, *lblMajTicksLength, *lblLineWidth, *lblMinTicks,
             *lblMinTicksLength, *lblPoints, *lblPeaksColor;
-    QLabel *lblUndoLimit;
+    QLabel *lblUndoLimit, *lblUndoMemoryLimit, *lblCompressionLevel;
     QGroupBox *groupBoxFittingCurve, *groupBoxFitParameters;
     QRadioButton *samePointsBtn, *generatePointsBtn;
     QGroupBox *groupBoxMultiPeak;
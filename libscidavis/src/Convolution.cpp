@@ -33,9 +33,15 @@
 #include "ColorButton.h"
 #include "core/column/Column.h"
 
+#include "FourierTransform.h"
+#include "lib/ParallelFor.h"
+
 #include <QMessageBox>
 #include <QLocale>
-#include <gsl/gsl_fft_halfcomplex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 Convolution::Convolution(ApplicationWindow *parent, Table *t, const QString &signalColName,
                          const QString &responseColName)
@@ -95,9 +101,8 @@ void Convolution::setDataFromTable(Table *t, const QString &signalColName,
 
     d_n = rows;
 
-    d_n_signal = 16; // tmp number of points
-    while (unsigned(d_n_signal) < d_n + d_n_response / 2)
-        d_n_signal *= 2;
+    // the zero-padding keeps the ends of the signal from wrapping around
+    d_n_signal = int(FourierTransform::fastLength(d_n + d_n_response / 2));
 
     d_x = new double[d_n_signal]; // signal
     d_y = new double[d_n_response]; // response
@@ -118,8 +123,8 @@ void Convolution::setDataFromTable(Table *t, const QString &signalColName,
 
 void Convolution::output()
 {
-    convlv(d_x, d_n_signal, d_y, d_n_response, 1);
-    addResultCurve();
+    if (runInBackground([this]() { convlv(d_x, d_n_signal, d_y, d_n_response, 1); }))
+        addResultCurve();
 }
 
 void Convolution::addResultCurve()
@@ -163,47 +168,72 @@ void Convolution::addResultCurve()
 
 void Convolution::convlv(double *sig, int n, double *dres, int m, int sign)
 {
-    double *res = new double[n];
-    memset(res, 0, n * sizeof(double));
-    int i, m2 = m / 2;
-    for (i = 0; i < m2; i++) { // store the response in wrap around order, see Numerical Recipes doc
+    int m2 = m / 2;
+    // Three FFTs take about 3 n log2(n) operations; direct convolution with a short response
+    // takes n m, and doesn't need to zero-pad the response to the length of the signal.
+    if (sign == 1 && m < 3 * std::log2(double(n))) {
+        std::vector<double> result(n);
+        parallelFor(0, n, parallelChunks(n, 65536), [&](int chunk, int begin, int end) {
+            for (int i = begin; i < end && !isCancelled(); i++) {
+                // sig is zero-padded by at least m2 points, so points beyond its ends are zero
+                int first = std::max(0, i + m2 - n + 1), last = std::min(m - 1, i + m2);
+                double sum = 0.0;
+                for (int j = first; j <= last; j++)
+                    sum += dres[j] * sig[i + m2 - j];
+                result[i] = sum;
+                // the chunks are equally large, so the first one stands for all of them
+                if (chunk == 0 && (i - begin) % 4096 == 0)
+                    setProgress(double(i - begin) / (end - begin));
+            }
+        });
+        std::copy(result.begin(), result.end(), sig);
+        return;
+    }
+
+    // store the response in wrap around order, see Numerical Recipes doc
+    std::vector<double> res(n);
+    for (int i = 0; i < m2; i++) {
         res[i] = dres[m2 + i];
         res[n - m2 + i] = dres[i];
     }
+    res[m2] = dres[m - 1];
 
-    if (m2 % 2 == 1)
-        res[m2] = dres[m - 1];
+    // calculate ffts; they can't be interrupted, so cancelling takes effect afterwards
+    FourierTransform::realForward(res.data(), n);
+    FourierTransform::realForward(sig, n);
+    setProgress(2.0 / 3);
+    if (isCancelled())
+        return;
 
-    // calculate ffts
-    gsl_fft_real_radix2_transform(res, 1, n);
-    gsl_fft_real_radix2_transform(sig, 1, n);
+    // frequency 0 and (for even n) the Nyquist frequency have no imaginary part
+    auto multiplyReal = [&](int i) {
+        if (sign == 1)
+            sig[i] = res[i] * sig[i];
+        else
+            sig[i] = sig[i] / res[i];
+    };
+    multiplyReal(0);
+    if (n % 2 == 0)
+        multiplyReal(n / 2);
 
     double re, im, size;
-    for (i = 0; i < n / 2; i++) { // multiply/divide both ffts
-        if (i == 0 || i == n / 2 - 1) {
-            if (sign == 1)
-                sig[i] = res[i] * sig[i];
-            else
-                sig[i] = sig[i] / res[i];
+    for (int i = 1; i < (n + 1) / 2; i++) { // multiply/divide both ffts
+        int ni = n - i;
+        if (sign == 1) {
+            re = res[i] * sig[i] - res[ni] * sig[ni];
+            im = res[i] * sig[ni] + res[ni] * sig[i];
         } else {
-            int ni = n - i;
-            if (sign == 1) {
-                re = res[i] * sig[i] - res[ni] * sig[ni];
-                im = res[i] * sig[ni] + res[ni] * sig[i];
-            } else {
-                size = res[i] * res[i] + res[ni] * res[ni];
-                re = res[i] * sig[i] + res[ni] * sig[ni];
-                im = res[i] * sig[ni] - res[ni] * sig[i];
-                re /= size;
-                im /= size;
-            }
-
-            sig[i] = re;
-            sig[ni] = im;
+            size = res[i] * res[i] + res[ni] * res[ni];
+            re = res[i] * sig[i] + res[ni] * sig[ni];
+            im = res[i] * sig[ni] - res[ni] * sig[i];
+            re /= size;
+            im /= size;
         }
+
+        sig[i] = re;
+        sig[ni] = im;
     }
-    delete[] res;
-    gsl_fft_halfcomplex_radix2_inverse(sig, 1, n); // inverse fft
+    FourierTransform::halfcomplexInverse(sig, n); // inverse fft
 }
 /**************************************************************************
  *             Class Deconvolution                                         *
@@ -219,6 +249,6 @@ Deconvolution::Deconvolution(ApplicationWindow *parent, Table *t, const QString
 
 void Deconvolution::output()
 {
-    convlv(d_x, signalDataSize(), d_y, responseDataSize(), -1);
-    addResultCurve();
+    if (runInBackground([this]() { convlv(d_x, signalDataSize(), d_y, responseDataSize(), -1); }))
+        addResultCurve();
 }
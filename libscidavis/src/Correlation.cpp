@@ -35,7 +35,7 @@
 #include <QLocale>
 #include "core/column/Column.h"
 
-#include <gsl/gsl_fft_halfcomplex.h>
+#include "FourierTransform.h"
 #include <vector>
 
 Correlation::Correlation(ApplicationWindow *parent, Table *t, const QString &colName1,
@@ -72,9 +72,8 @@ void Correlation::setDataFromTable(Table *t, const QString &colName1, const QStr
     }
 
     unsigned rows = d_table->numRows();
-    d_n = 16; // tmp number of points
-    while (d_n < rows)
-        d_n *= 2;
+    // lags up to rows/2 are shown; the zero-padding keeps them free of wrap-around
+    d_n = FourierTransform::fastLength(rows + rows / 2);
 
     d_x = new double[d_n];
     d_y = new double[d_n];
@@ -96,30 +95,36 @@ void Correlation::setDataFromTable(Table *t, const QString &colName1, const QStr
 
 void Correlation::output()
 {
-    // calculate the FFTs of the two functions
-    if (gsl_fft_real_radix2_transform(d_x, 1, d_n) == 0
-        && gsl_fft_real_radix2_transform(d_y, 1, d_n) == 0) {
-        // multiply the FFT by its complex conjugate
-        for (unsigned i = 0; i < d_n / 2; i++) {
-            if (i == 0 || i == (d_n / 2) - 1)
-                d_x[i] *= d_x[i];
-            else {
-                int ni = d_n - i;
-                double dReal = d_x[i] * d_y[i] + d_x[ni] * d_y[ni];
-                double dImag = d_x[i] * d_y[ni] - d_x[ni] * d_y[i];
-                d_x[i] = dReal;
-                d_x[ni] = dImag;
+    bool success = true;
+    auto correlate = [&]() {
+        // calculate the FFTs of the two functions; they can't be interrupted, so cancelling takes
+        // effect between them
+        for (double *data : { d_x, d_y }) {
+            if (!FourierTransform::realForward(data, d_n)) {
+                showError(tr("Error in GSL forward FFT operation!"));
+                success = false;
+                return;
             }
+            setProgress(data == d_x ? 1.0 / 3 : 2.0 / 3);
+            if (isCancelled())
+                return;
         }
-    } else {
-        QMessageBox::warning((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                             tr("Error in GSL forward FFT operation!"));
-        return;
-    }
-
-    gsl_fft_halfcomplex_radix2_inverse(d_x, 1, d_n); // inverse FFT
-
-    addResultCurve();
+        // multiply the second FFT by the complex conjugate of the first one
+        // frequency 0 and (for even lengths) the Nyquist frequency have no imaginary part
+        d_x[0] *= d_y[0];
+        if (d_n % 2 == 0)
+            d_x[d_n / 2] *= d_y[d_n / 2];
+        for (unsigned i = 1; i < (d_n + 1) / 2; i++) {
+            int ni = d_n - i;
+            double dReal = d_x[i] * d_y[i] + d_x[ni] * d_y[ni];
+            double dImag = d_x[i] * d_y[ni] - d_x[ni] * d_y[i];
+            d_x[i] = dReal;
+            d_x[ni] = dImag;
+        }
+        FourierTransform::halfcomplexInverse(d_x, d_n); // inverse FFT
+    };
+    if (runInBackground(correlate) && success)
+        addResultCurve();
 }
 
 void Correlation::addResultCurve()
@@ -31,12 +31,17 @@
 #include "Plot.h"
 #include "ColorButton.h"
 #include "core/column/Column.h"
+#include "FourierTransform.h"
+#include "Matrix.h"
+#include "lib/ParallelFor.h"
 
 #include <QMessageBox>
 #include <QLocale>
 
-#include <gsl/gsl_fft_complex.h>
-#include <gsl/gsl_fft_halfcomplex.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
 
 FFT::FFT(ApplicationWindow *parent, Table *t, const QString &realColName,
          const QString &imagColName)
@@ -68,35 +73,45 @@ void FFT::init()
     d_real_col = -1;
     d_imag_col = -1;
     d_sampling = 1.0;
+    d_window_size = 0;
+    d_window_overlap = 0;
+    d_window_function = Hann;
 }
 
-QList<Column *> FFT::fftTable()
+void FFT::setShortTime(int size, int overlap, WindowFunction window)
 {
-    double *amp = new double[d_n];
+    d_window_size = std::max(0, size);
+    d_window_overlap = std::max(0, std::min(overlap, d_window_size - 1));
+    d_window_function = window;
+}
 
-    gsl_fft_complex_wavetable *wavetable = gsl_fft_complex_wavetable_alloc(d_n);
-    gsl_fft_complex_workspace *workspace = gsl_fft_complex_workspace_alloc(d_n);
+bool FFT::transform(double *amp, double &aMax)
+{
+    bool success;
+    if (!d_inverse && d_imag_col < 0) {
+        // all imaginary parts are zero, so the cheaper real transform suffices
+        std::vector<double> real(d_n);
+        for (size_t i = 0; i < d_n; i++)
+            real[i] = d_y[2 * i];
+        success = FourierTransform::realForward(real.data(), d_n);
+        if (success)
+            FourierTransform::unpackHalfcomplex(real.data(), d_y, d_n);
+    } else
+        success = FourierTransform::complex(
+                d_y, d_n, d_inverse ? FourierTransform::Inverse : FourierTransform::Forward);
 
-    if (!amp || !wavetable || !workspace) {
-        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                              tr("Could not allocate memory, operation aborted!"));
+    if (!success) {
+        showError(tr("Could not allocate memory, operation aborted!"));
         d_init_err = true;
-        return QList<Column *>();
+        return false;
     }
+    // the transform itself can't be interrupted, but takes most of the time
+    setProgress(0.9);
+    if (isCancelled())
+        return false;
 
     double df = 1.0 / (double)(d_n * d_sampling); // frequency sampling
-    double aMax = 0.0; // max amplitude
-    QList<Column *> columns;
-    if (!d_inverse) {
-        columns << new Column(tr("Frequency"), SciDAVis::ColumnMode::Numeric);
-        gsl_fft_complex_forward(d_y, 1, d_n, wavetable, workspace);
-    } else {
-        columns << new Column(tr("Time"), SciDAVis::ColumnMode::Numeric);
-        gsl_fft_complex_inverse(d_y, 1, d_n, wavetable, workspace);
-    }
-
-    gsl_fft_complex_wavetable_free(wavetable);
-    gsl_fft_complex_workspace_free(workspace);
+    aMax = 0.0; // max amplitude
 
     if (d_shift_order) {
         int n2 = d_n / 2;
@@ -119,7 +134,22 @@ QList<Column *> FFT::fftTable()
         if (a > aMax)
             aMax = a;
     }
+    return true;
+}
+
+QList<Column *> FFT::fftTable()
+{
+    std::vector<double> amp(d_n);
+    double aMax = 0.0;
+    bool success = false;
+    if (!runInBackground([&]() { success = transform(amp.data(), aMax); }) || !success)
+        return QList<Column *>();
 
+    QList<Column *> columns;
+    if (!d_inverse)
+        columns << new Column(tr("Frequency"), SciDAVis::ColumnMode::Numeric);
+    else
+        columns << new Column(tr("Time"), SciDAVis::ColumnMode::Numeric);
     columns << new Column(tr("Real"), SciDAVis::ColumnMode::Numeric);
     columns << new Column(tr("Imaginary"), SciDAVis::ColumnMode::Numeric);
     columns << new Column(tr("Amplitude"), SciDAVis::ColumnMode::Numeric);
@@ -135,7 +165,6 @@ QList<Column *> FFT::fftTable()
             columns.at(3)->setValueAt(i, amp[i]);
         columns.at(4)->setValueAt(i, atan(d_y[i2 + 1] / d_y[i2]));
     }
-    delete[] amp;
     columns.at(0)->setPlotDesignation(SciDAVis::X);
     columns.at(1)->setPlotDesignation(SciDAVis::Y);
     columns.at(2)->setPlotDesignation(SciDAVis::Y);
@@ -144,8 +173,103 @@ QList<Column *> FFT::fftTable()
     return columns;
 }
 
+bool FFT::shortTimeTransform(QVector<qreal> &amplitudes, int windows)
+{
+    const int size = d_window_size;
+    const int step = size - d_window_overlap;
+    const int frequencies = size / 2 + 1;
+
+    std::vector<double> weights(size, 1.0);
+    for (int i = 0; i < size && d_window_function != Rectangular; i++) {
+        double phase = 2 * M_PI * i / (size > 1 ? size - 1 : 1);
+        switch (d_window_function) {
+        case Hann:
+            weights[i] = 0.5 - 0.5 * cos(phase);
+            break;
+        case Hamming:
+            weights[i] = 0.54 - 0.46 * cos(phase);
+            break;
+        case Blackman:
+            weights[i] = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2 * phase);
+            break;
+        default:
+            break;
+        }
+    }
+
+    amplitudes.resize(windows * frequencies);
+    std::atomic<int> done(0);
+    std::atomic<bool> failed(false);
+    parallelFor(0, windows, parallelChunks(windows, 8), [&](int chunk, int begin, int end) {
+        std::vector<double> buffer(size);
+        for (int w = begin; w < end && !failed && !isCancelled(); w++) {
+            // d_y holds interleaved real and imaginary parts
+            const double *start = d_y + 2 * size_t(w) * step;
+            for (int i = 0; i < size; i++)
+                buffer[i] = start[2 * i] * weights[i];
+            if (!FourierTransform::realForward(buffer.data(), size)) {
+                failed = true;
+                break;
+            }
+            double *amplitude = amplitudes.data() + size_t(w) * frequencies;
+            for (int k = 0; k < frequencies; k++)
+                amplitude[k] = k == 0 || 2 * k == size ? fabs(buffer[k])
+                                                       : hypot(buffer[k], buffer[size - k]);
+            done++;
+            if (chunk == 0)
+                setProgress(double(done) / windows);
+        }
+    });
+    if (failed) {
+        showError(tr("Could not allocate memory, operation aborted!"));
+        return false;
+    }
+    return !isCancelled();
+}
+
+void FFT::outputSpectrogram()
+{
+    if (int(d_n) < d_window_size || d_window_size < 2) {
+        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
+                              tr("The window must contain at least 2 and at most %1 points!")
+                                      .arg(d_n));
+        return;
+    }
+    const int step = d_window_size - d_window_overlap;
+    const int windows = 1 + (int(d_n) - d_window_size) / step;
+    const int frequencies = d_window_size / 2 + 1;
+
+    QVector<qreal> amplitudes;
+    bool success = false;
+    if (!runInBackground([&]() { success = shortTimeTransform(amplitudes, windows); })
+        || !success)
+        return;
+
+    if (d_normalize) {
+        double aMax = *std::max_element(amplitudes.constBegin(), amplitudes.constEnd());
+        if (aMax > 0)
+            for (qreal &a : amplitudes)
+                a /= aMax;
+    }
+
+    ApplicationWindow *app = (ApplicationWindow *)parent();
+    Matrix *m = app->newMatrix(app->generateUniqueName(tr("Spectrogram")), frequencies, windows);
+    m->setWindowLabel(d_explanation);
+    m->setCells(amplitudes);
+    // windows are placed at their centers, frequencies range from 0 to the Nyquist frequency
+    double first = 0.5 * (d_window_size - 1) * d_sampling;
+    m->setCoordinates(first, first + (windows - 1) * step * d_sampling, 0.0,
+                      (frequencies - 1) / (d_window_size * d_sampling));
+    app->plotSpectrogram(m, Graph::ColorMap);
+}
+
 void FFT::output()
 {
+    if (d_y && d_window_size > 0) {
+        outputSpectrogram();
+        return;
+    }
+
     QList<Column *> columns;
     if (d_y)
         columns = fftTable();
@@ -31,6 +31,8 @@
 
 #include "Filter.h"
 
+#include <QVector>
+
 class FFT : public Filter
 {
     Q_OBJECT
@@ -45,12 +47,28 @@ public:
     void normalizeAmplitudes(bool norm = true) { d_normalize = norm; };
     void shiftFrequencies(bool shift = true) { d_shift_order = shift; };
 
+    //! Window functions for short-time transforms
+    enum WindowFunction { Rectangular, Hann, Hamming, Blackman };
+    //! Compute a spectrogram of the real part instead of a single spectrum
+    /**
+     * The data is split into windows of \c size points, each starting \c size - \c overlap
+     * points after the previous one and multiplied by \c window. The amplitude spectra of the
+     * windows become the columns of a new matrix, which is shown as a color map. Setting \c size
+     * to 0 switches back to a single transform of the whole data.
+     */
+    void setShortTime(int size, int overlap = 0, WindowFunction window = Hann);
+
 private:
     void init();
     void output();
     void output(QList<Column *> columns);
 
+    //! Does the actual transform and computes the amplitudes; may run on a worker thread.
+    bool transform(double *amp, double &aMax);
     QList<Column *> fftTable();
+    //! Computes the amplitude spectra of all windows in parallel; may run on a worker thread.
+    bool shortTimeTransform(QVector<qreal> &amplitudes, int windows);
+    void outputSpectrogram();
 
     void setDataFromTable(Table *t, const QString &realColName,
                           const QString &imagColName = QString());
@@ -64,6 +82,12 @@ private:
     bool d_shift_order;
 
     int d_real_col, d_imag_col;
+
+    //! Number of points per window of a short-time transform, or 0 for a single transform
+    int d_window_size;
+    //! Number of points shared by consecutive windows
+    int d_window_overlap;
+    WindowFunction d_window_function;
 };
 
 #endif
@@ -43,6 +43,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QSpinBox>
 #include <QLayout>
 
 #include <memory>
@@ -101,11 +102,34 @@ FFTDialog::FFTDialog(int type, QWidget *parent, Qt::WindowFlags fl) : QDialog(pa
     boxOrder = new QCheckBox(tr("&Shift Results"));
     boxOrder->setChecked(true);
 
+    boxShortTime = new QGroupBox(tr("Short-Time FFT (&Spectrogram)"));
+    boxShortTime->setCheckable(true);
+    boxShortTime->setChecked(false);
+    QGridLayout *gl2 = new QGridLayout(boxShortTime);
+    gl2->addWidget(new QLabel(tr("Window Size")), 0, 0);
+    boxWindowSize = new QSpinBox();
+    boxWindowSize->setRange(2, 1 << 24);
+    boxWindowSize->setValue(256);
+    gl2->addWidget(boxWindowSize, 0, 1);
+    gl2->addWidget(new QLabel(tr("Overlap")), 1, 0);
+    boxOverlap = new QSpinBox();
+    boxOverlap->setRange(0, 255);
+    boxOverlap->setValue(128);
+    gl2->addWidget(boxOverlap, 1, 1);
+    gl2->addWidget(new QLabel(tr("Window Function")), 2, 0);
+    boxWindowFunction = new QComboBox();
+    // same order as FFT::WindowFunction
+    boxWindowFunction->addItems(QStringList() << tr("Rectangular") << tr("Hann") << tr("Hamming")
+                                              << tr("Blackman"));
+    boxWindowFunction->setCurrentIndex(FFT::Hann);
+    gl2->addWidget(boxWindowFunction, 2, 1);
+
     QVBoxLayout *vbox1 = new QVBoxLayout();
     vbox1->addWidget(gb1);
     vbox1->addWidget(gb2);
     vbox1->addWidget(boxNormalize);
     vbox1->addWidget(boxOrder);
+    vbox1->addWidget(boxShortTime);
     vbox1->addStretch();
 
     buttonOK = new QPushButton(tr("&OK"));
@@ -128,6 +152,25 @@ FFTDialog::FFTDialog(int type, QWidget *parent, Qt::WindowFlags fl) : QDialog(pa
             SLOT(activateCurve(const QString &)));
     connect(buttonOK, SIGNAL(clicked()), this, SLOT(accept()));
     connect(buttonCancel, SIGNAL(clicked()), this, SLOT(reject()));
+    connect(boxShortTime, SIGNAL(toggled(bool)), this, SLOT(enableShortTimeOptions(bool)));
+    connect(boxWindowSize, SIGNAL(valueChanged(int)), this, SLOT(updateOverlapRange(int)));
+}
+
+void FFTDialog::updateOverlapRange(int windowSize)
+{
+    // consecutive windows have to advance by at least one sample
+    boxOverlap->setMaximum(windowSize - 1);
+}
+
+void FFTDialog::enableShortTimeOptions(bool on)
+{
+    // spectrograms are computed from real data only
+    if (on)
+        forwardBtn->setChecked(true);
+    backwardBtn->setEnabled(!on);
+    boxOrder->setEnabled(!on);
+    if (d_type == onTable)
+        boxImaginary->setEnabled(!on);
 }
 
 void FFTDialog::accept()
@@ -154,13 +197,17 @@ void FFTDialog::accept()
             boxReal->setFocus();
             return;
         }
-        fft.reset(new FFT(app, d_table, boxReal->currentText(), boxImaginary->currentText()));
+        QString imaginary = boxShortTime->isChecked() ? QString() : boxImaginary->currentText();
+        fft.reset(new FFT(app, d_table, boxReal->currentText(), imaginary));
     }
     if (fft) {
         fft->setInverseFFT(backwardBtn->isChecked());
         fft->setSampling(sampling);
         fft->normalizeAmplitudes(boxNormalize->isChecked());
         fft->shiftFrequencies(boxOrder->isChecked());
+        if (boxShortTime->isChecked())
+            fft->setShortTime(boxWindowSize->value(), boxOverlap->value(),
+                              FFT::WindowFunction(boxWindowFunction->currentIndex()));
         fft->run();
     }
     close();
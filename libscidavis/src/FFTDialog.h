@@ -36,6 +36,8 @@ class QRadioButton;
 class QLineEdit;
 class QComboBox;
 class QCheckBox;
+class QGroupBox;
+class QSpinBox;
 class Graph;
 class Table;
 
@@ -56,12 +58,17 @@ public:
     QComboBox *boxName, *boxReal, *boxImaginary;
     QLineEdit *boxSampling;
     QCheckBox *boxNormalize, *boxOrder;
+    QGroupBox *boxShortTime;
+    QSpinBox *boxWindowSize, *boxOverlap;
+    QComboBox *boxWindowFunction;
 
 public slots:
     void setGraph(Graph *g);
     void setTable(Table *t);
     void activateCurve(const QString &curveName);
     void accept();
+    void enableShortTimeOptions(bool on);
+    void updateOverlapRange(int windowSize);
 
 private:
     Graph *graph;
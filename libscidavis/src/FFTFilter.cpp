@@ -31,7 +31,7 @@
 #include <QMessageBox>
 #include <QLocale>
 
-#include <gsl/gsl_fft_halfcomplex.h>
+#include "FourierTransform.h"
 
 FFTFilter::FFTFilter(ApplicationWindow *parent, Graph *g, const QString &curveTitle, int m)
     : Filter(parent, g)
@@ -121,34 +121,36 @@ void FFTFilter::calculateOutputData(double *x, double *y)
 
     double df = 1.0 / (x[d_n - 1] - x[0]);
 
-    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(d_n);
-    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(d_n);
-
-    gsl_fft_real_transform(y, 1, d_n, real, work);
-    gsl_fft_real_wavetable_free(real);
+    if (!FourierTransform::realForward(y, d_n)) {
+        showError(tr("Could not allocate memory, operation aborted!"));
+        return;
+    }
 
     d_explanation = QLocale().toString(d_low_freq) + " ";
     if (d_filter_type > 2)
         d_explanation += tr("to") + " " + QLocale().toString(d_high_freq) + " ";
     d_explanation += tr("Hz") + " ";
 
+    auto frequency = [&](unsigned i) { return FourierTransform::frequencyIndex(i, d_n) * df; };
     switch ((int)d_filter_type) {
     case 1: // low pass
         d_explanation += tr("Low Pass FFT Filter");
-        for (int i = d_n - 1; i >= 0 && ((i + 1) / 2) * df > d_low_freq; i--)
-            y[i] = 0;
+        for (unsigned i = 0; i < d_n; i++)
+            if (frequency(i) > d_low_freq)
+                y[i] = 0;
         break;
 
     case 2: // high pass
         d_explanation += tr("High Pass FFT Filter");
-        for (unsigned i = 0; i < d_n && ((i + 1) / 2) * df < d_low_freq; i++)
-            y[i] = 0;
+        for (unsigned i = 0; i < d_n; i++)
+            if (frequency(i) < d_low_freq)
+                y[i] = 0;
         break;
 
     case 3: // band pass
         d_explanation += tr("Band Pass FFT Filter");
         for (unsigned i = d_offset ? 1 : 0; i < d_n; i++)
-            if ((((i + 1) / 2) * df <= d_low_freq) || (((i + 1) / 2) * df >= d_high_freq))
+            if (frequency(i) <= d_low_freq || frequency(i) >= d_high_freq)
                 y[i] = 0;
         break;
 
@@ -159,13 +161,10 @@ void FFTFilter::calculateOutputData(double *x, double *y)
             y[0] = 0; // substract DC offset
 
         for (unsigned i = 1; i < d_n; i++)
-            if ((((i + 1) / 2) * df > d_low_freq) && (((i + 1) / 2) * df < d_high_freq))
+            if (frequency(i) > d_low_freq && frequency(i) < d_high_freq)
                 y[i] = 0;
         break;
     }
 
-    gsl_fft_halfcomplex_wavetable *hc = gsl_fft_halfcomplex_wavetable_alloc(d_n);
-    gsl_fft_halfcomplex_inverse(y, 1, d_n, hc, work);
-    gsl_fft_halfcomplex_wavetable_free(hc);
-    gsl_fft_real_workspace_free(work);
+    FourierTransform::halfcomplexInverse(y, d_n);
 }
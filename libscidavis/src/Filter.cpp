@@ -37,10 +37,15 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QLocale>
+#include <QProgressDialog>
+#include <QThread>
 
 #include <gsl/gsl_sort.h>
 
 #include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
 using namespace std;
 
 Filter::Filter(ApplicationWindow *parent, Graph *g, QString name) : QObject(parent)
@@ -72,6 +77,8 @@ void Filter::init()
     d_explanation = objectName();
     d_graph = 0;
     d_table = 0;
+    d_progress = 0;
+    d_cancelled = false;
 }
 
 void Filter::setInterval(double from, double to)
@@ -230,20 +237,83 @@ bool Filter::run()
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
+    d_cancelled = false;
     output(); // data analysis and output
+    if (d_cancelled) {
+        QApplication::restoreOverrideCursor();
+        return false;
+    }
     ((ApplicationWindow *)parent())->updateLog(logInfo());
 
     QApplication::restoreOverrideCursor();
     return true;
 }
 
+bool Filter::runInBackground(const std::function<void()> &job, bool cancellable)
+{
+    d_progress = 0;
+    d_cancelled = false;
+    d_job_error.clear();
+
+    atomic<bool> finished(false);
+    exception_ptr exception;
+    thread worker([&]() {
+        try {
+            job();
+        } catch (...) {
+            exception = current_exception();
+        }
+        finished = true;
+    });
+
+    // keep the GUI alive, but don't let the user change anything while the job is running
+    QApplication::setOverrideCursor(Qt::BusyCursor);
+    QProgressDialog progress(tr("%1 in progress...").arg(objectName()),
+                             cancellable ? tr("&Cancel") : QString(), 0, cancellable ? 1000 : 0,
+                             (ApplicationWindow *)parent());
+    progress.setWindowModality(Qt::ApplicationModal);
+    progress.setMinimumDuration(500);
+    while (!finished) {
+        if (progress.wasCanceled())
+            d_cancelled = true;
+        // reaching the maximum would close the dialog
+        if (cancellable)
+            progress.setValue(qBound(0, d_progress.load(), 999));
+        // until the dialog shows up and blocks the rest of the application, ignore user input
+        QApplication::processEvents(progress.isVisible() ? QEventLoop::AllEvents
+                                                         : QEventLoop::ExcludeUserInputEvents,
+                                    50);
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    worker.join();
+    progress.reset();
+    QApplication::restoreOverrideCursor();
+
+    if (exception)
+        rethrow_exception(exception);
+    if (!d_job_error.isEmpty())
+        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
+                              d_job_error);
+    return !d_cancelled;
+}
+
+void Filter::showError(const QString &message)
+{
+    if (QThread::currentThread() == qApp->thread())
+        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
+                              message);
+    else if (d_job_error.isEmpty())
+        d_job_error = message;
+}
+
 void Filter::output()
 {
     vector<double> X(d_points);
     vector<double> Y(d_points);
 
     // do the data analysis
-    calculateOutputData(&X[0], &Y[0]);
+    if (!runInBackground([&]() { calculateOutputData(&X[0], &Y[0]); }))
+        return;
 
     addResultCurve(&X[0], &Y[0]);
 }
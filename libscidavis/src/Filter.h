@@ -33,6 +33,9 @@
 
 #include "ApplicationWindow.h"
 
+#include <atomic>
+#include <functional>
+
 class QwtPlotCurve;
 class Graph;
 class Table;
@@ -114,6 +117,31 @@ protected:
     //! Performs the data analysis and takes care of the output
     virtual void output();
 
+    //! Runs \c job on a worker thread while showing a progress dialog.
+    /**
+     * Jobs should only work on the filter's own data (d_x, d_y and the like), which are a copy of
+     * the input, so the user can't change it in the meantime. Anything creating QObjects, like
+     * columns or curves, has to be done afterwards in the GUI thread.
+     *
+     * Jobs that can't stop early, like a single GSL call, pass \c cancellable = false; their
+     * dialog shows a busy indicator instead of a progress bar and a Cancel button.
+     *
+     * Returns false if the user cancelled the job.
+     */
+    bool runInBackground(const std::function<void()> &job, bool cancellable = true);
+
+    //! Reports the progress of the current job (see runInBackground()) as a fraction from 0 to 1.
+    void setProgress(double fraction) { d_progress = static_cast<int>(1000 * fraction); }
+
+    //! Tells whether the user has asked to cancel the current job (see runInBackground()).
+    bool isCancelled() const
+    {
+        return d_cancelled || (d_parent_job && d_parent_job->isCancelled());
+    }
+
+    //! Shows an error message; in contrast to QMessageBox, this may be called from jobs.
+    void showError(const QString &message);
+
     //! Calculates the data for the output curve and store it in the X an Y vectors
     virtual void calculateOutputData(double *X, double *Y)
     {
@@ -168,6 +196,22 @@ protected:
 
     //! String explaining the operation in the comment of the result table and in the project explorer
     QString d_explanation;
+
+private:
+    //! Progress of the current job in thousandths
+    std::atomic<int> d_progress;
+
+    //! Whether the current job should be cancelled
+    std::atomic<bool> d_cancelled;
+
+    //! The first error message reported by the current job
+    QString d_job_error;
+
+    //! Filter running the job this one is part of; cancelling that job cancels this one as well
+    const Filter *d_parent_job = nullptr;
+
+    // BatchFit runs many fits as part of a single job
+    friend class BatchFit;
 };
 
 #endif
@@ -35,7 +35,11 @@
 #include "FunctionCurve.h"
 #include "ColorButton.h"
 #include "Script.h"
+#include "AutoDiffFormula.h"
 #include "core/column/Column.h"
+#ifdef SCRIPTING_MUPARSER
+#include "MuParserScript.h"
+#endif
 
 #include <gsl/gsl_statistics.h>
 #include <gsl/gsl_blas.h>
@@ -47,6 +51,8 @@
 #include <QDateTime>
 #include <QLocale>
 
+#include <algorithm>
+
 using namespace std;
 
 Fit::Fit(ApplicationWindow *parent, Graph *g, QString name)
@@ -104,7 +110,8 @@ vector<double> Fit::fitGslMultifit(int &iterations, int &status)
         return result;
 
     // iterate solver algorithm
-    for (iterations = 0; iterations < d_max_iterations; iterations++) {
+    for (iterations = 0; iterations < d_max_iterations && !isCancelled(); iterations++) {
+        setProgress(double(iterations) / d_max_iterations);
         status = gsl_multifit_fdfsolver_iterate(s);
         if (status)
             break;
@@ -163,7 +170,8 @@ vector<double> Fit::fitGslMultimin(int &iterations, int &status)
     gsl_multimin_fminimizer_set(s_min, &f, d_param_init, ss);
 
     // iterate minimization algorithm
-    for (iterations = 0; iterations < d_max_iterations; iterations++) {
+    for (iterations = 0; iterations < d_max_iterations && !isCancelled(); iterations++) {
+        setProgress(double(iterations) / d_max_iterations);
         status = gsl_multimin_fminimizer_iterate(s_min);
         if (status)
             break;
@@ -204,6 +212,62 @@ void Fit::setDataCurve(int curve, double start, double end)
         setYErrorSource(UnknownErrors);
 }
 
+/**
+ * Unlike setDataFromCurve(), this doesn't need a graph and doesn't ask any questions, so it can be
+ * used to set up many fits at once (see BatchFit). Rows where one of the columns is empty or
+ * invalid are skipped; the column names are the short ones, without the table name.
+ */
+bool Fit::setDataFromTable(Table *t, const QString &xColName, const QString &yColName,
+                           double from, double to)
+{
+    if (d_n > 0) { // delete previousely allocated memory
+        delete[] d_x;
+        delete[] d_y;
+        d_n = 0;
+    }
+
+    Column *xCol = t ? t->column(xColName) : nullptr;
+    Column *yCol = t ? t->column(yColName) : nullptr;
+    d_init_err = !xCol || !yCol || xCol->dataType() != SciDAVis::TypeDouble
+            || yCol->dataType() != SciDAVis::TypeDouble;
+    if (d_init_err)
+        return false;
+
+    vector<pair<double, double>> points;
+    int rows = min(xCol->rowCount(), yCol->rowCount());
+    for (int i = 0; i < rows; i++) {
+        if (xCol->isInvalid(i) || yCol->isInvalid(i))
+            continue;
+        double x = xCol->valueAt(i);
+        if (x >= from && x <= to)
+            points.emplace_back(x, yCol->valueAt(i));
+    }
+    if (d_sort_data)
+        stable_sort(points.begin(), points.end(),
+                    [](const pair<double, double> &a, const pair<double, double> &b) {
+                        return a.first < b.first;
+                    });
+
+    d_table = t;
+    d_curve = 0;
+    d_n = points.size();
+    d_x = new double[d_n];
+    d_y = new double[d_n];
+    for (unsigned i = 0; i < d_n; i++) {
+        d_x[i] = points[i].first;
+        d_y[i] = points[i].second;
+    }
+    if (d_n > 0) {
+        d_from = *min_element(d_x, d_x + d_n);
+        d_to = *max_element(d_x, d_x + d_n);
+    }
+
+    d_y_errors.resize(d_n);
+    setYErrorSource(UnknownErrors);
+    d_init_err = d_n < unsigned(d_min_points);
+    return !d_init_err;
+}
+
 void Fit::setInitialGuesses(double *x_init)
 {
     for (unsigned i = 0; i < d_p; i++)
@@ -447,57 +511,87 @@ const vector<double> &Fit::errors()
     return d_result_errors;
 }
 
+QString Fit::fitError() const
+{
+    if (!d_n)
+        return tr("You didn't specify a valid data set for this fit operation. "
+                  "Operation aborted!");
+    if (!d_p)
+        return tr("There are no parameters specified for this fit operation. Operation aborted!");
+    if (unsigned(d_p) > d_n)
+        return tr("You need at least %1 data points for this fit operation. Operation aborted!")
+                .arg(d_p);
+    if (d_formula.isEmpty())
+        return tr("You must specify a valid fit function first. Operation aborted!");
+    return QString();
+}
+
+void Fit::initScript()
+{
+    d_script.reset(scriptEnv->newScript(d_formula, this, metaObject()->className()));
+    d_bulk_evaluation = true;
+    d_derivatives.reset(new AutoDiffFormula);
+    if (!d_derivatives->compile(d_formula, d_param_names))
+        d_derivatives.reset();
+    d_derivatives_checked = false;
+}
+
+vector<double> Fit::computeFit(int &iterations, int &status)
+{
+    vector<double> par;
+    iterations = 0;
+    d_result_errors.clear();
+    if (d_solver == NelderMeadSimplex)
+        par = fitGslMultimin(iterations, status);
+    else
+        par = fitGslMultifit(iterations, status);
+
+    storeCustomFitResults(par);
+    return par;
+}
+
+bool Fit::canComputeInBackground() const
+{
+#ifdef SCRIPTING_MUPARSER
+    return qobject_cast<MuParserScript *>(d_script.get()) != nullptr;
+#else
+    return false;
+#endif
+}
+
 void Fit::fit()
 {
     if (!d_graph || d_init_err)
         return;
 
-    if (!d_n) {
-        QMessageBox::critical((ApplicationWindow *)parent(), tr("Fit Error"),
-                              tr("You didn't specify a valid data set for this fit operation. "
-                                 "Operation aborted!"));
-        return;
-    }
-    if (!d_p) {
-        QMessageBox::critical(
-                (ApplicationWindow *)parent(), tr("Fit Error"),
-                tr("There are no parameters specified for this fit operation. Operation aborted!"));
-        return;
-    }
-    if (unsigned(d_p) > d_n) {
-        QMessageBox::critical(
-                (ApplicationWindow *)parent(), tr("Fit Error"),
-                tr("You need at least %1 data points for this fit operation. Operation aborted!")
-                        .arg(d_p));
-        return;
-    }
-    if (d_formula.isEmpty()) {
-        QMessageBox::critical(
-                (ApplicationWindow *)parent(), tr("Fit Error"),
-                tr("You must specify a valid fit function first. Operation aborted!"));
+    QString error = fitError();
+    if (!error.isEmpty()) {
+        QMessageBox::critical((ApplicationWindow *)parent(), tr("Fit Error"), error);
         return;
     }
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
     int status, iterations;
-    vector<double> par;
-    d_script.reset(scriptEnv->newScript(d_formula, this, metaObject()->className()));
+    initScript();
     connect(d_script.get(), SIGNAL(error(const QString &, const QString &, int)), this,
             SLOT(scriptError(const QString &, const QString &, int)));
 
-    if (d_solver == NelderMeadSimplex)
-        par = fitGslMultimin(iterations, status);
+    vector<double> par;
+    auto job = [&]() { par = computeFit(iterations, status); };
+    bool finished = true;
+    if (canComputeInBackground())
+        finished = runInBackground(job);
     else
-        par = fitGslMultifit(iterations, status);
-
-    storeCustomFitResults(par);
-    if (status == GSL_SUCCESS)
-        generateFitCurve(par);
-
-    ApplicationWindow *app = (ApplicationWindow *)parent();
-    if (app->writeFitResultsToLog)
-        app->updateLog(logFitInfo(d_results, iterations, status, d_graph->parentPlotName()));
+        job();
+    if (finished) {
+        if (status == GSL_SUCCESS)
+            generateFitCurve(par);
+
+        ApplicationWindow *app = (ApplicationWindow *)parent();
+        if (app->writeFitResultsToLog)
+            app->updateLog(logFitInfo(d_results, iterations, status, d_graph->parentPlotName()));
+    }
     disconnect(d_script.get(), SIGNAL(error(const QString &, const QString &, int)), this,
                SLOT(scriptError(const QString &, const QString &, int)));
     QApplication::restoreOverrideCursor();
@@ -511,6 +605,13 @@ void Fit::scriptError(const QString &message, const QString &script_name, int li
 
 int Fit::evaluate_f(const gsl_vector *x, gsl_vector *f)
 {
+    vector<double> values;
+    if (evaluateBulk(x, values)) {
+        for (unsigned j = 0; j < d_n; j++)
+            gsl_vector_set(f, j, (values[j] - d_y[j]) / d_y_errors[j]);
+        return GSL_SUCCESS;
+    }
+
     for (unsigned i = 0; i < d_p; i++) {
         d_script->setDouble(gsl_vector_get(x, i), d_param_names[i].toUtf8());
     }
@@ -531,6 +632,13 @@ int Fit::evaluate_f(const gsl_vector *x, gsl_vector *f)
 double Fit::evaluate_d(const gsl_vector *x)
 {
     double result = 0.0;
+    vector<double> values;
+    if (evaluateBulk(x, values)) {
+        for (unsigned j = 0; j < d_n; j++)
+            result += pow((values[j] - d_y[j]) / d_y_errors[j], 2);
+        return result;
+    }
+
     for (unsigned i = 0; i < d_p; i++)
         d_script->setDouble(gsl_vector_get(x, i), d_param_names[i].toUtf8());
     for (unsigned j = 0; j < d_n; j++) {
@@ -543,6 +651,30 @@ double Fit::evaluate_d(const gsl_vector *x)
     return result;
 }
 
+/**
+ * Instead of setting "x" and evaluating d_script once per data point, this has muParser evaluate
+ * the formula over the whole d_x array (see MuParserScript::evalArray()). If that isn't possible,
+ * it is not tried again during the current fit.
+ */
+bool Fit::evaluateBulk(const gsl_vector *x, vector<double> &values)
+{
+#ifdef SCRIPTING_MUPARSER
+    auto script = dynamic_cast<MuParserScript *>(d_script.get());
+    if (!d_bulk_evaluation || !script)
+        return false;
+    for (unsigned i = 0; i < d_p; i++)
+        script->setDouble(gsl_vector_get(x, i), d_param_names[i].toUtf8());
+    values.resize(d_n);
+    if (script->evalArray("x", d_x, d_n, values.data()))
+        return true;
+    d_bulk_evaluation = false;
+#else
+    Q_UNUSED(x);
+    Q_UNUSED(values);
+#endif
+    return false;
+}
+
 typedef struct
 {
     Script *script;
@@ -563,8 +695,16 @@ double Fit::evaluate_df_helper(double x, void *params)
     return result;
 }
 
+/**
+ * The Jacobian is computed exactly by d_derivatives if the fit formula is simple enough for
+ * AutoDiffFormula; otherwise, it is approximated numerically, which needs several script
+ * evaluations per data point and parameter.
+ */
 int Fit::evaluate_df(const gsl_vector *x, gsl_matrix *J)
 {
+    if (d_derivatives && evaluateExactDerivatives(x, J))
+        return GSL_SUCCESS;
+
     double result, abserr;
     gsl_function F;
     F.function = &evaluate_df_helper;
@@ -581,12 +721,45 @@ int Fit::evaluate_df(const gsl_vector *x, gsl_matrix *J)
             gsl_deriv_central(&F, gsl_vector_get(x, j), 1e-8, &result, &abserr);
             if (!data.success)
                 return GSL_EINVAL;
-            gsl_matrix_set(J, i, j, result / d_y_errors[j]);
+            // gsl_deriv_central() leaves the parameter at a shifted value
+            d_script->setDouble(gsl_vector_get(x, j), d_param_names[j].toUtf8());
+            gsl_matrix_set(J, i, j, result / d_y_errors[i]);
         }
     }
     return GSL_SUCCESS;
 }
 
+bool Fit::evaluateExactDerivatives(const gsl_vector *x, gsl_matrix *J)
+{
+    vector<double> par(d_p), gradient(d_p);
+    for (unsigned i = 0; i < d_p; i++)
+        par[i] = gsl_vector_get(x, i);
+
+    if (!d_derivatives_checked) {
+        // muParser is the reference, so make sure we agree on what the formula means
+        d_derivatives_checked = true;
+        for (unsigned i = 0; i < d_p; i++)
+            d_script->setDouble(par[i], d_param_names[i].toUtf8());
+        for (unsigned j : { 0u, d_n / 2, d_n - 1 }) {
+            d_script->setDouble(d_x[j], "x");
+            bool success;
+            double reference = d_script->eval().toDouble(&success);
+            double value = d_derivatives->evaluate(d_x[j], par.data(), gradient.data());
+            if (!success || !(fabs(value - reference) <= 1e-9 * (1.0 + fabs(reference)))) {
+                d_derivatives.reset();
+                return false;
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < d_n; i++) {
+        d_derivatives->evaluate(d_x[i], par.data(), gradient.data());
+        for (unsigned j = 0; j < d_p; j++)
+            gsl_matrix_set(J, i, j, gradient[j] / d_y_errors[i]);
+    }
+    return true;
+}
+
 void Fit::generateFitCurve(const vector<double> &par)
 {
     if (!d_gen_function)
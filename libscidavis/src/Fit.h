@@ -37,12 +37,14 @@
 #include <gsl/gsl_multifit_nlin.h>
 #include <gsl/gsl_multimin.h>
 
+#include <cfloat>
 #include <vector>
 
 class Table;
 class Matrix;
 class ApplicationWindow;
 class Script;
+class AutoDiffFormula;
 
 //! Fit base class
 class Fit : public Filter, public scripted
@@ -64,13 +66,37 @@ public:
     //! Actually does the fit. Should be reimplemented in derived classes.
     virtual void fit();
 
+    //! Returns why fit() would refuse to run, or an empty string if it's fine.
+    QString fitError() const;
+    //! Sets up the script evaluating the fit formula; must be called before computeFit().
+    void initScript();
+    //! Does the fit without any output or user interaction.
+    /**
+     * Returns the parameters as found by the solver, while results() may be transformed by
+     * storeCustomFitResults(). Unlike the rest of the class, this may be run on a worker thread,
+     * provided that initScript() was called and no two threads use the same Fit (see BatchFit).
+     */
+    virtual std::vector<double> computeFit(int &iterations, int &status);
+    //! Whether computeFit() may run on a worker thread; initScript() must have been called.
+    /**
+     * This is only the case for muParser formulas: Python functions need the interpreter lock,
+     * which is only held by the GUI thread.
+     */
+    bool canComputeInBackground() const;
+
     //! Sets the data set to be used as source of Y errors.
     bool setYErrorSource(ErrorSource err, const QString &colName = {}, bool fail_silently = false);
 
     void setDataCurve(int curve, double start, double end);
+    bool setDataFromTable(Table *t, const QString &xColName, const QString &yColName,
+                          double from = -DBL_MAX, double to = DBL_MAX);
 
     QString formula() { return d_formula; };
     int numParameters() { return d_p; }
+    const QStringList &parameterNames() const { return d_param_names; }
+    bool isNonLinear() const { return is_non_linear; }
+
+    double initialGuess(int parIndex) const { return gsl_vector_get(d_param_init, parIndex); }
 
     void setInitialGuess(int parIndex, double val) { gsl_vector_set(d_param_init, parIndex, val); };
     void setInitialGuesses(double *x_init);
@@ -118,6 +144,12 @@ private:
     //! Execute the fit using GSL non-linear least-squares fitting (Levenberg-Marquardt).
     std::vector<double> fitGslMultifit(int &iterations, int &status);
 
+    //! Evaluates the fit formula for all of d_x at once; returns false if this is not possible.
+    bool evaluateBulk(const gsl_vector *x, std::vector<double> &values);
+
+    //! Computes the Jacobian using d_derivatives; returns false if this is not possible.
+    bool evaluateExactDerivatives(const gsl_vector *x, gsl_matrix *J);
+
     //! Customs and stores the fit results according to the derived class specifications. Used by exponential fits.
     virtual void storeCustomFitResults(const std::vector<double> &par) { d_results = par; }
 
@@ -200,6 +232,15 @@ protected:
 
     //! Script used to evaluate user-defined functions.
     std::unique_ptr<Script> d_script;
+
+    //! Whether evaluateBulk() is worth trying for d_script.
+    bool d_bulk_evaluation = false;
+
+    //! Exact derivatives of user-defined functions, if supported (see evaluate_df()).
+    std::unique_ptr<AutoDiffFormula> d_derivatives;
+
+    //! Whether d_derivatives has been checked against d_script.
+    bool d_derivatives_checked = false;
 };
 
 #endif
@@ -37,6 +37,8 @@
 #include "PluginFit.h"
 #include "NonLinearFit.h"
 #include "SigmoidalFit.h"
+#include "BatchFit.h"
+#include "PlotCurve.h"
 #include "Matrix.h"
 #include <muParserError.h>
 
@@ -166,6 +168,13 @@ void FitDialog::initFitPage()
     gl3->addWidget(new QLabel(tr("Tolerance")), 1, 0);
     boxTolerance = new QLineEdit("1e-4");
     gl3->addWidget(boxTolerance, 1, 1);
+    gl3->addWidget(new QLabel(tr("Starts")), 2, 0);
+    boxStarts = new QSpinBox();
+    boxStarts->setRange(1, 1000);
+    boxStarts->setValue(1);
+    boxStarts->setToolTip(tr("When fitting all curves, fit each one this many times, starting "
+                             "from randomly varied initial guesses, and keep the best result"));
+    gl3->addWidget(boxStarts, 2, 1);
     QGroupBox *gb3 = new QGroupBox();
     gb3->setLayout(gl3);
 
@@ -199,6 +208,8 @@ void FitDialog::initFitPage()
     buttonOk = new QPushButton(tr("&Fit"));
     buttonOk->setDefault(true);
     hbox3->addWidget(buttonOk);
+    buttonFitAll = new QPushButton(tr("Fit &All Curves"));
+    hbox3->addWidget(buttonFitAll);
     buttonCancel1 = new QPushButton(tr("&Close"));
     hbox3->addWidget(buttonCancel1);
     buttonAdvanced = new QPushButton(tr("Custom &Output >>"));
@@ -218,6 +229,7 @@ void FitDialog::initFitPage()
     connect(boxCurve, SIGNAL(activated(const QString &)), this,
             SLOT(activateCurve(const QString &)));
     connect(buttonOk, SIGNAL(clicked()), this, SLOT(accept()));
+    connect(buttonFitAll, SIGNAL(clicked()), this, SLOT(fitAllCurves()));
     connect(buttonCancel1, SIGNAL(clicked()), this, SLOT(close()));
     connect(buttonEdit, SIGNAL(clicked()), this, SLOT(showEditPage()));
     connect(btnDeleteFitCurves, SIGNAL(clicked()), this, SLOT(deleteFitCurves()));
@@ -1024,9 +1036,50 @@ void FitDialog::accept()
         return;
     }
 
-    if (!validInitialValues())
+    FitSettings settings;
+    if (!readFitSettings(settings))
+        return;
+
+    if (d_fitter) {
+        delete d_fitter;
+        d_fitter = 0;
+    }
+
+    d_fitter = newFitter(settings);
+    if (!d_fitter)
         return;
 
+    if (!d_fitter->setDataFromCurve(curve, settings.start, settings.end)
+        || !d_fitter->setYErrorSource((Fit::ErrorSource)boxYErrorSource->currentIndex(),
+                                      tableNamesBox->currentText() + "_"
+                                              + colNamesBox->currentText())) {
+        delete d_fitter;
+        d_fitter = 0;
+        return;
+    }
+
+    d_fitter->fit();
+    auto res = d_fitter->results();
+    int rows = boxParams->rowCount();
+    if (!boxParams->isColumnHidden(2)) {
+        int j = 0;
+        for (int i = 0; i < rows; i++) {
+            QCheckBox *cb = (QCheckBox *)boxParams->cellWidget(i, 2);
+            if (!cb->isChecked())
+                boxParams->item(i, 1)->setText(
+                        QLocale().toString(res[j++], 'g', boxPrecision->value()));
+        }
+    } else {
+        for (int i = 0; i < rows; i++)
+            boxParams->item(i, 1)->setText(QLocale().toString(res[i], 'g', boxPrecision->value()));
+    }
+}
+
+bool FitDialog::readFitSettings(FitSettings &settings)
+{
+    if (!validInitialValues())
+        return false;
+
     QString from = boxFrom->text().toLower();
     QString to = boxTo->text().toLower();
     QString tolerance = boxTolerance->text().toLower();
@@ -1038,7 +1091,7 @@ void FitDialog::accept()
     } catch (mu::ParserError &e) {
         QMessageBox::critical(this, tr("Start limit error"), QStringFromString(e.GetMsg()));
         boxFrom->setFocus();
-        return;
+        return false;
     }
 
     try {
@@ -1048,14 +1101,14 @@ void FitDialog::accept()
     } catch (mu::ParserError &e) {
         QMessageBox::critical(this, tr("End limit error"), QStringFromString(e.GetMsg()));
         boxTo->setFocus();
-        return;
+        return false;
     }
 
     if (start >= end) {
         QMessageBox::critical(0, tr("Input error"),
                               tr("Please enter x limits that satisfy: from < end!"));
         boxTo->setFocus();
-        return;
+        return false;
     }
 
     try {
@@ -1065,14 +1118,14 @@ void FitDialog::accept()
     } catch (mu::ParserError &e) {
         QMessageBox::critical(0, tr("Tolerance input error"), QStringFromString(e.GetMsg()));
         boxTolerance->setFocus();
-        return;
+        return false;
     }
 
     if (eps < 0 || eps >= 1) {
         QMessageBox::critical(0, tr("Tolerance input error"),
                               tr("The tolerance value must be positive and less than 1!"));
         boxTolerance->setFocus();
-        return;
+        return false;
     }
 
     int i, n = 0, rows = boxParams->rowCount();
@@ -1129,98 +1182,108 @@ void FitDialog::accept()
         }
     }
 
-    ApplicationWindow *app = (ApplicationWindow *)this->parent();
-
-    if (d_fitter) {
-        delete d_fitter;
-        d_fitter = 0;
-    }
+    settings.start = start;
+    settings.end = end;
+    settings.tolerance = eps;
+    settings.formula = formula;
+    settings.parameters = parameters;
+    settings.initialGuesses.assign(paramsInit, paramsInit + n);
+    delete[] paramsInit;
+    return true;
+}
 
+Fit *FitDialog::newFitter(FitSettings settings)
+{
+    ApplicationWindow *app = (ApplicationWindow *)this->parent();
+    Fit *fitter;
     if (boxUseBuiltIn->isChecked() && categoryBox->currentRow() == 1)
-        fitBuiltInFunction(funcBox->currentItem()->text(), paramsInit);
+        fitter = fitBuiltInFunction(funcBox->currentItem()->text(),
+                                    settings.initialGuesses.data());
     else if (boxUseBuiltIn->isChecked() && categoryBox->currentRow() == 3) {
-        d_fitter = new PluginFit(app, d_graph);
-        if (!((PluginFit *)d_fitter)->load(d_plugin_files_list[funcBox->currentRow()])) {
-            d_fitter = 0;
-            return;
+        fitter = new PluginFit(app, d_graph);
+        if (!((PluginFit *)fitter)->load(d_plugin_files_list[funcBox->currentRow()])) {
+            delete fitter;
+            return nullptr;
         }
-        d_fitter->setInitialGuesses(paramsInit);
+        fitter->setInitialGuesses(settings.initialGuesses.data());
     } else {
-        d_fitter = new NonLinearFit(app, d_graph);
-        ((NonLinearFit *)d_fitter)->setParametersList(parameters);
-        ((NonLinearFit *)d_fitter)->setFormula(formula);
-        d_fitter->setInitialGuesses(paramsInit);
+        fitter = new NonLinearFit(app, d_graph);
+        ((NonLinearFit *)fitter)->setParametersList(settings.parameters);
+        ((NonLinearFit *)fitter)->setFormula(settings.formula);
+        fitter->setInitialGuesses(settings.initialGuesses.data());
     }
-    delete[] paramsInit;
-
-    if (!d_fitter->setDataFromCurve(curve, start, end)
-        || !d_fitter->setYErrorSource((Fit::ErrorSource)boxYErrorSource->currentIndex(),
-                                      tableNamesBox->currentText() + "_"
-                                              + colNamesBox->currentText())) {
-        delete d_fitter;
-        d_fitter = 0;
-        return;
+    if (!fitter)
+        return nullptr;
+
+    fitter->setTolerance(settings.tolerance);
+    fitter->setAlgorithm((Fit::Algorithm)boxAlgorithm->currentIndex());
+    fitter->setColor(btnColor->color());
+    fitter->generateFunction(generatePointsBtn->isChecked(), generatePointsBox->value());
+    fitter->setMaximumIterations(boxPoints->value());
+    fitter->scaleErrors(scaleErrorsBox->isChecked());
+
+    if (fitter->objectName() == tr("MultiPeak") && ((MultiPeakFit *)fitter)->peaks() > 1) {
+        ((MultiPeakFit *)fitter)->enablePeakCurves(app->generatePeakCurves);
+        ((MultiPeakFit *)fitter)->setPeakCurvesColor(app->peakCurvesColor);
     }
+    return fitter;
+}
 
-    d_fitter->setTolerance(eps);
-    d_fitter->setAlgorithm((Fit::Algorithm)boxAlgorithm->currentIndex());
-    d_fitter->setColor(btnColor->color());
-    d_fitter->generateFunction(generatePointsBtn->isChecked(), generatePointsBox->value());
-    d_fitter->setMaximumIterations(boxPoints->value());
-    d_fitter->scaleErrors(scaleErrorsBox->isChecked());
-
-    if (d_fitter->objectName() == tr("MultiPeak") && ((MultiPeakFit *)d_fitter)->peaks() > 1) {
-        ((MultiPeakFit *)d_fitter)->enablePeakCurves(app->generatePeakCurves);
-        ((MultiPeakFit *)d_fitter)->setPeakCurvesColor(app->peakCurvesColor);
-    }
+void FitDialog::fitAllCurves()
+{
+    FitSettings settings;
+    if (!readFitSettings(settings))
+        return;
 
-    d_fitter->fit();
-    auto res = d_fitter->results();
-    if (!boxParams->isColumnHidden(2)) {
-        int j = 0;
-        for (i = 0; i < rows; i++) {
-            QCheckBox *cb = (QCheckBox *)boxParams->cellWidget(i, 2);
-            if (!cb->isChecked())
-                boxParams->item(i, 1)->setText(
-                        QLocale().toString(res[j++], 'g', boxPrecision->value()));
-        }
-    } else {
-        for (i = 0; i < rows; i++)
-            boxParams->item(i, 1)->setText(QLocale().toString(res[i], 'g', boxPrecision->value()));
+    ApplicationWindow *app = (ApplicationWindow *)this->parent();
+    BatchFit batch(app, [=]() { return newFitter(settings); });
+    batch.setDataRange(settings.start, settings.end);
+    batch.setRandomStarts(boxStarts->value());
+    for (int i = 0; i < d_graph->curves(); i++) {
+        DataCurve *c = dynamic_cast<DataCurve *>(d_graph->curve(i));
+        if (!c || !c->table() || c->type() == Graph::Function || c->type() == Graph::ErrorBars)
+            continue;
+        // the curve refers to columns by their full names
+        QString prefix = c->table()->name() + "_";
+        batch.addDataSet(c->table(), c->xColumnName().mid(prefix.length()),
+                         c->yColumnName().mid(prefix.length()));
     }
+    batch.run();
 }
 
-void FitDialog::fitBuiltInFunction(const QString &function, double *initVal)
+Fit *FitDialog::fitBuiltInFunction(const QString &function, double *initVal)
 {
     ApplicationWindow *app = (ApplicationWindow *)this->parent();
+    Fit *fitter = nullptr;
     if (function == "ExpDecay1") {
         initVal[1] = 1 / initVal[1];
-        d_fitter = new ExponentialFit(app, d_graph);
+        fitter = new ExponentialFit(app, d_graph);
     } else if (function == "ExpGrowth") {
         initVal[1] = -1 / initVal[1];
-        d_fitter = new ExponentialFit(app, d_graph, true);
+        fitter = new ExponentialFit(app, d_graph, true);
     } else if (function == "ExpDecay2") {
         initVal[1] = 1 / initVal[1];
         initVal[3] = 1 / initVal[3];
-        d_fitter = new TwoExpFit(app, d_graph);
+        fitter = new TwoExpFit(app, d_graph);
     } else if (function == "ExpDecay3") {
         initVal[1] = 1 / initVal[1];
         initVal[3] = 1 / initVal[3];
         initVal[5] = 1 / initVal[5];
-        d_fitter = new ThreeExpFit(app, d_graph);
+        fitter = new ThreeExpFit(app, d_graph);
     } else if (function == "Boltzmann")
-        d_fitter = new SigmoidalFit(app, d_graph);
+        fitter = new SigmoidalFit(app, d_graph);
     else if (function == "GaussAmp")
-        d_fitter = new GaussAmpFit(app, d_graph);
+        fitter = new GaussAmpFit(app, d_graph);
     else if (function == "Gauss")
-        d_fitter = new MultiPeakFit(app, d_graph, MultiPeakFit::Gauss, polynomOrderBox->value());
+        fitter = new MultiPeakFit(app, d_graph, MultiPeakFit::Gauss, polynomOrderBox->value());
     else if (function == "Lorentz")
-        d_fitter = new MultiPeakFit(app, d_graph, MultiPeakFit::Lorentz, polynomOrderBox->value());
+        fitter = new MultiPeakFit(app, d_graph, MultiPeakFit::Lorentz, polynomOrderBox->value());
     else if (function == "Polynomial")
-        d_fitter = new PolynomialFit(app, d_graph, polynomOrderBox->value());
+        fitter = new PolynomialFit(app, d_graph, polynomOrderBox->value());
 
-    if (function != "Polynomial")
-        d_fitter->setInitialGuesses(initVal);
+    if (fitter && function != "Polynomial")
+        fitter->setInitialGuesses(initVal);
+    return fitter;
 }
 
 bool FitDialog::containsUserFunctionName(const QString &function)
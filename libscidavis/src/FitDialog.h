@@ -31,6 +31,8 @@
 
 #include "Graph.h"
 
+#include <vector>
+
 class QPushButton;
 class QLineEdit;
 class QComboBox;
@@ -117,7 +119,9 @@ public slots:
     //! Read the selected data range from the graph
     void changeDataRange();
     //! Fit using a built-in function
-    void fitBuiltInFunction(const QString &function, double *initVal);
+    Fit *fitBuiltInFunction(const QString &function, double *initVal);
+    //! Fit the current function to all data curves of the graph, writing the results to a table
+    void fitAllCurves();
 
     //! Populate the list of tables containing data displayed in the corresponding graph
     void setSrcTables(QList<MyWidget *> *tables);
@@ -147,6 +151,22 @@ signals:
     void saveFunctionsList(const QStringList &);
 
 private:
+    //! What the user entered for the fit to come, see readFitSettings()
+    struct FitSettings
+    {
+        double start, end, tolerance;
+        QString formula;
+        QStringList parameters;
+        std::vector<double> initialGuesses;
+    };
+    //! Reads the data range, tolerance and fit function; complains and returns false if invalid
+    bool readFitSettings(FitSettings &settings);
+    //! Create and set up a fitter for the current function, without data
+    /**
+     * \c settings is taken by value, since built-in functions may transform the initial guesses.
+     */
+    Fit *newFitter(FitSettings settings);
+
     Fit *d_fitter;
     Graph *d_graph;
     QStringList d_user_functions, d_user_function_names, d_user_function_params;
@@ -157,6 +177,7 @@ private:
     QCheckBox *boxUseBuiltIn;
     QStackedWidget *tw;
     QPushButton *buttonOk;
+    QPushButton *buttonFitAll;
     QPushButton *buttonCancel1;
     QPushButton *buttonCancel2;
     QPushButton *buttonCancel3;
@@ -171,7 +192,7 @@ private:
     QLineEdit *boxFrom;
     QLineEdit *boxTo;
     QLineEdit *boxTolerance;
-    QSpinBox *boxPoints, *generatePointsBox, *boxPrecision, *polynomOrderBox;
+    QSpinBox *boxPoints, *generatePointsBox, *boxPrecision, *polynomOrderBox, *boxStarts;
     QWidget *fitPage, *editPage, *advancedPage;
     QTextEdit *editBox, *explainBox, *boxFunction;
     QListWidget *categoryBox, *funcBox;
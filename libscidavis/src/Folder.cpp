@@ -152,8 +152,11 @@ MyWidget *Folder::findWindow(const QString &s, bool windowNames, bool labels, bo
 MyWidget *Folder::window(const QString &name, const char *cls, bool recursive)
 {
     foreach (MyWidget *w, lstWindows)
-        if (w->inherits(cls) && name == w->name().mid(0, w->name().indexOf("@")))
+        if (w->inherits(cls) && name == w->name().mid(0, w->name().indexOf("@"))) {
+            // like ApplicationWindow::table(), hand out windows with all their data
+            w->loadPendingData();
             return w;
+        }
     if (!recursive)
         return NULL;
     foreach (QObject *f, children()) {
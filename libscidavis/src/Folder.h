@@ -107,7 +107,8 @@ public:
     /**
      * Returns the first window with given name that inherits class cls;
      * NULL on failure. If recursive is true, do a depth-first recursive
-     * search.
+     * search. Data of the window not read yet (see MyWidget::loadPendingData()) is read now, so
+     * this must be called from the GUI thread unless the window is known to be complete.
      */
     MyWidget *window(const QString &name, const char *cls = "myWidget", bool recursive = false);
     //! Return table named name or NULL
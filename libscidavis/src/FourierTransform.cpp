@@ -0,0 +1,305 @@
+/***************************************************************************
+    File                 : FourierTransform.cpp
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Fast Fourier transforms with cached plans
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#include "FourierTransform.h"
+
+#include <algorithm>
+#include <climits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef HAVE_FFTW3
+#include <fftw3.h>
+#else
+#include <gsl/gsl_fft_complex.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+#include <gsl/gsl_fft_real.h>
+#endif
+
+namespace {
+//! Trigonometric tables or FFTW plans for one length, created when first needed
+struct Plan
+{
+    explicit Plan(size_t n) : n(n) { }
+    ~Plan();
+    Plan(const Plan &) = delete;
+    Plan &operator=(const Plan &) = delete;
+
+    const size_t n;
+#ifdef HAVE_FFTW3
+    fftw_plan r2hc = nullptr;
+    fftw_plan hc2r = nullptr;
+    fftw_plan forward = nullptr;
+    fftw_plan backward = nullptr;
+#else
+    gsl_fft_real_wavetable *real = nullptr;
+    gsl_fft_halfcomplex_wavetable *halfcomplex = nullptr;
+    gsl_fft_complex_wavetable *complex = nullptr;
+#endif
+};
+
+//! Number of lengths whose plans are kept; tables for long transforms need a lot of memory
+const size_t cached_lengths = 4;
+//! Guards the cache and the FFTW planner, which isn't thread-safe
+/**
+ * Plans still in use when they are dropped from the cache are destroyed by the last thread
+ * using them, so this needs to be recursive.
+ */
+std::recursive_mutex cache_mutex;
+//! Plans of the most recently used lengths, most recent first
+std::list<std::shared_ptr<Plan>> cache;
+
+Plan::~Plan()
+{
+    std::lock_guard<std::recursive_mutex> lock(cache_mutex);
+#ifdef HAVE_FFTW3
+    for (fftw_plan plan : { r2hc, hc2r, forward, backward })
+        if (plan)
+            fftw_destroy_plan(plan);
+#else
+    if (real)
+        gsl_fft_real_wavetable_free(real);
+    if (halfcomplex)
+        gsl_fft_halfcomplex_wavetable_free(halfcomplex);
+    if (complex)
+        gsl_fft_complex_wavetable_free(complex);
+#endif
+}
+
+//! Return the plans for length \c n; cache_mutex must be locked
+std::shared_ptr<Plan> planFor(size_t n)
+{
+    for (auto it = cache.begin(); it != cache.end(); ++it)
+        if ((*it)->n == n) {
+            cache.splice(cache.begin(), cache, it);
+            return cache.front();
+        }
+    cache.push_front(std::make_shared<Plan>(n));
+    if (cache.size() > cached_lengths)
+        cache.pop_back();
+    return cache.front();
+}
+
+#ifdef HAVE_FFTW3
+// Plans are made for in-place transforms of arbitrarily aligned arrays, so they can be executed
+// on any array of the same length with the new-array execute functions. With FFTW_ESTIMATE,
+// the array passed for planning isn't touched.
+const unsigned plan_flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+
+//! Return a plan for a real transform of \c data; \c plan keeps it alive while it's being used
+fftw_plan realPlan(size_t n, double *data, fftw_r2r_kind kind, std::shared_ptr<Plan> &plan)
+{
+    std::lock_guard<std::recursive_mutex> lock(cache_mutex);
+    plan = planFor(n);
+    fftw_plan &result = kind == FFTW_R2HC ? plan->r2hc : plan->hc2r;
+    if (!result)
+        result = fftw_plan_r2r_1d(int(n), data, data, kind, plan_flags);
+    return result;
+}
+
+//! Return a plan for a complex transform of \c data; \c plan keeps it alive while it's being used
+fftw_plan complexPlan(size_t n, double *data, int sign, std::shared_ptr<Plan> &plan)
+{
+    std::lock_guard<std::recursive_mutex> lock(cache_mutex);
+    plan = planFor(n);
+    fftw_plan &result = sign == FFTW_FORWARD ? plan->forward : plan->backward;
+    if (!result) {
+        fftw_complex *c = reinterpret_cast<fftw_complex *>(data);
+        result = fftw_plan_dft_1d(int(n), c, c, sign, plan_flags);
+    }
+    return result;
+}
+#else
+bool isPowerOfTwo(size_t n)
+{
+    return (n & (n - 1)) == 0;
+}
+#endif
+} // namespace
+
+bool FourierTransform::realForward(double *data, size_t n)
+{
+    if (n == 0 || n > INT_MAX)
+        return false;
+#ifdef HAVE_FFTW3
+    std::shared_ptr<Plan> owner;
+    fftw_plan plan = realPlan(n, data, FFTW_R2HC, owner);
+    if (!plan)
+        return false;
+    fftw_execute_r2r(plan, data, data);
+    return true;
+#else
+    if (isPowerOfTwo(n))
+        return gsl_fft_real_radix2_transform(data, 1, n) == 0;
+
+    std::shared_ptr<Plan> plan;
+    {
+        std::lock_guard<std::recursive_mutex> lock(cache_mutex);
+        plan = planFor(n);
+        if (!plan->real)
+            plan->real = gsl_fft_real_wavetable_alloc(n);
+    }
+    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(n);
+    if (!plan->real || !work) {
+        if (work)
+            gsl_fft_real_workspace_free(work);
+        return false;
+    }
+    int status = gsl_fft_real_transform(data, 1, n, plan->real, work);
+    gsl_fft_real_workspace_free(work);
+    if (status != 0)
+        return false;
+
+    // the mixed-radix transform packs real and imaginary parts of each frequency together
+    std::vector<double> packed(data, data + n);
+    for (size_t k = 1; 2 * k - 1 < n; k++) {
+        data[k] = packed[2 * k - 1];
+        if (2 * k < n)
+            data[n - k] = packed[2 * k];
+    }
+    return true;
+#endif
+}
+
+bool FourierTransform::halfcomplexInverse(double *data, size_t n)
+{
+    if (n == 0 || n > INT_MAX)
+        return false;
+#ifdef HAVE_FFTW3
+    std::shared_ptr<Plan> owner;
+    fftw_plan plan = realPlan(n, data, FFTW_HC2R, owner);
+    if (!plan)
+        return false;
+    fftw_execute_r2r(plan, data, data);
+    double scale = 1.0 / n;
+    for (size_t i = 0; i < n; i++)
+        data[i] *= scale;
+    return true;
+#else
+    if (isPowerOfTwo(n))
+        return gsl_fft_halfcomplex_radix2_inverse(data, 1, n) == 0;
+
+    std::shared_ptr<Plan> plan;
+    {
+        std::lock_guard<std::recursive_mutex> lock(cache_mutex);
+        plan = planFor(n);
+        if (!plan->halfcomplex)
+            plan->halfcomplex = gsl_fft_halfcomplex_wavetable_alloc(n);
+    }
+    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(n);
+    if (!plan->halfcomplex || !work) {
+        if (work)
+            gsl_fft_real_workspace_free(work);
+        return false;
+    }
+
+    std::vector<double> halfcomplex(data, data + n);
+    for (size_t k = 1; 2 * k - 1 < n; k++) {
+        data[2 * k - 1] = halfcomplex[k];
+        if (2 * k < n)
+            data[2 * k] = halfcomplex[n - k];
+    }
+    int status = gsl_fft_halfcomplex_inverse(data, 1, n, plan->halfcomplex, work);
+    gsl_fft_real_workspace_free(work);
+    return status == 0;
+#endif
+}
+
+bool FourierTransform::complex(double *data, size_t n, Direction direction)
+{
+    if (n == 0 || n > INT_MAX)
+        return false;
+#ifdef HAVE_FFTW3
+    std::shared_ptr<Plan> owner;
+    fftw_plan plan =
+            complexPlan(n, data, direction == Forward ? FFTW_FORWARD : FFTW_BACKWARD, owner);
+    if (!plan)
+        return false;
+    fftw_complex *c = reinterpret_cast<fftw_complex *>(data);
+    fftw_execute_dft(plan, c, c);
+    if (direction == Inverse) {
+        double scale = 1.0 / n;
+        for (size_t i = 0; i < 2 * n; i++)
+            data[i] *= scale;
+    }
+    return true;
+#else
+    std::shared_ptr<Plan> plan;
+    {
+        std::lock_guard<std::recursive_mutex> lock(cache_mutex);
+        plan = planFor(n);
+        if (!plan->complex)
+            plan->complex = gsl_fft_complex_wavetable_alloc(n);
+    }
+    gsl_fft_complex_workspace *work = gsl_fft_complex_workspace_alloc(n);
+    if (!plan->complex || !work) {
+        if (work)
+            gsl_fft_complex_workspace_free(work);
+        return false;
+    }
+    int status = direction == Forward
+            ? gsl_fft_complex_forward(data, 1, n, plan->complex, work)
+            : gsl_fft_complex_inverse(data, 1, n, plan->complex, work);
+    gsl_fft_complex_workspace_free(work);
+    return status == 0;
+#endif
+}
+
+void FourierTransform::unpackHalfcomplex(const double *halfcomplex, double *complex, size_t n)
+{
+    for (size_t k = 0; k < n; k++) {
+        size_t f = frequencyIndex(k, n);
+        complex[2 * k] = halfcomplex[f];
+        if (f == 0 || 2 * f == n)
+            complex[2 * k + 1] = 0;
+        else
+            // the upper half of the spectrum is the complex conjugate of the lower one
+            complex[2 * k + 1] = k == f ? halfcomplex[n - f] : -halfcomplex[n - f];
+    }
+}
+
+size_t FourierTransform::fastLength(size_t minimum)
+{
+    for (size_t length = std::max<size_t>(minimum, 1);; length++) {
+        size_t rest = length;
+        for (size_t factor : { 2, 3, 5, 7 })
+            while (rest % factor == 0)
+                rest /= factor;
+        if (rest == 1)
+            return length;
+    }
+}
+
+const char *FourierTransform::backend()
+{
+#ifdef HAVE_FFTW3
+    return "FFTW";
+#else
+    return "GSL";
+#endif
+}
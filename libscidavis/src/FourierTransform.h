@@ -0,0 +1,80 @@
+/***************************************************************************
+    File                 : FourierTransform.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Fast Fourier transforms with cached plans
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef FOURIERTRANSFORM_H
+#define FOURIERTRANSFORM_H
+
+#include <cstddef>
+
+//! Fast Fourier transforms of arbitrary length, shared by the FFT based filters
+/**
+ * The trigonometric tables (or FFTW plans, if SciDAVis was built with FFTW) needed for a
+ * transform are computed once per length and kept for the next transforms of the same length.
+ * All functions may be called from several threads at the same time.
+ *
+ * Real transforms use the halfcomplex layout of FFTW and gsl_fft_real_radix2_transform():
+ * for a sequence of length n, data[k] is the real part of frequency k for 0 <= k <= n/2, and
+ * data[n - k] its imaginary part for 0 < k < (n + 1)/2. The imaginary parts of frequency 0 and
+ * (for even n) n/2 are zero and not stored. frequencyIndex() maps positions to frequencies.
+ */
+class FourierTransform
+{
+public:
+    enum Direction { Forward, Inverse };
+
+    //! Transform \c n real values in place into the halfcomplex layout described above
+    static bool realForward(double *data, size_t n);
+    //! Inverse of realForward(), including the normalization by 1/n
+    static bool halfcomplexInverse(double *data, size_t n);
+    //! Transform \c n complex numbers, stored as interleaved real and imaginary parts, in place
+    /**
+     * Like gsl_fft_complex_inverse(), the inverse transform is normalized by 1/n.
+     */
+    static bool complex(double *data, size_t n, Direction direction);
+
+    //! Expand a halfcomplex sequence into \c n interleaved complex numbers
+    /**
+     * The missing half of the spectrum of real data follows from its symmetry.
+     */
+    static void unpackHalfcomplex(const double *halfcomplex, double *complex, size_t n);
+    //! Return the frequency stored at \c position of a halfcomplex sequence of length \c n
+    static size_t frequencyIndex(size_t position, size_t n)
+    {
+        return position <= n / 2 ? position : n - position;
+    }
+
+    //! Return the smallest length >= \c minimum which can be transformed efficiently
+    /**
+     * These are lengths without prime factors larger than 7. Zero-padding data to such a length
+     * instead of the next power of two wastes at most a few percent of memory and time.
+     */
+    static size_t fastLength(size_t minimum);
+
+    //! Return the name of the library doing the actual work
+    static const char *backend();
+};
+
+#endif // ifndef FOURIERTRANSFORM_H
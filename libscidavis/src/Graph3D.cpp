@@ -35,6 +35,7 @@
 #include "MyParser.h"
 #include "ColorButton.h"
 #include "core/column/Column.h"
+#include "lib/ParallelFor.h"
 
 #include <QApplication>
 #include <QMessageBox>
@@ -52,13 +53,21 @@
 #include <qwt3d_coordsys.h>
 
 #include <gsl/gsl_vector.h>
+#include <algorithm>
 #include <fstream>
 #include <stdexcept>
 using namespace std;
 
-UserFunction::UserFunction(const QString &s, SurfacePlot &pw) : Function(pw)
+UserFunction::UserFunction(const QString &s, SurfacePlot &pw)
+    : Function(pw), formula(s), d_parser(new MyParser), d_x(0.0), d_y(0.0)
 {
-    formula = s;
+    d_parser->DefineVar(_T("x"), &d_x);
+    d_parser->DefineVar(_T("y"), &d_y);
+    try {
+        d_parser->SetExpr(formula);
+    } catch (mu::ParserError &) {
+        // reported when evaluating
+    }
 }
 
 double UserFunction::operator()(double x, double y)
@@ -66,20 +75,95 @@ double UserFunction::operator()(double x, double y)
     if (formula.isEmpty())
         return 0.0;
 
-    MyParser parser;
     double result = 0.0;
     try {
-        parser.DefineVar(_T("x"), &x);
-        parser.DefineVar(_T("y"), &y);
-
-        parser.SetExpr(formula);
-        result = parser.Eval();
+        d_x = x;
+        d_y = y;
+        result = d_parser->Eval();
     } catch (mu::ParserError &e) {
         QMessageBox::critical(0, "Input function error", QStringFromString(e.GetMsg()));
     }
     return result;
 }
 
+bool UserFunction::evaluateMesh(double **data)
+{
+    int rows = umesh_p;
+    int columns = vmesh_p;
+    double dx = (maxu_p - minu_p) / (umesh_p - 1);
+    double dy = (maxv_p - minv_p) / (vmesh_p - 1);
+
+    if (formula.isEmpty()) {
+        for (int i = 0; i < rows; i++)
+            std::fill_n(data[i], columns, 0.0);
+        return true;
+    }
+    // parse errors are reported by the first evaluation, so do that here in the GUI thread
+    try {
+        d_x = minu_p;
+        d_y = minv_p;
+        d_parser->Eval();
+    } catch (mu::ParserError &e) {
+        QMessageBox::critical(0, "Input function error", QStringFromString(e.GetMsg()));
+        for (int i = 0; i < rows; i++)
+            std::fill_n(data[i], columns, 0.0);
+        return false;
+    }
+
+    // muParser instances can't be shared between threads, so every chunk of rows gets its own
+    int chunks = parallelChunks(rows * columns, 10000);
+    // errors depending on the point (e.g. from user defined functions) are reported afterwards
+    std::vector<QString> errors(chunks);
+    parallelFor(0, rows, chunks, [&](int chunk, int begin, int end) {
+        MyParser parser;
+        double x, y;
+        parser.DefineVar(_T("x"), &x);
+        parser.DefineVar(_T("y"), &y);
+        int i = begin;
+        try {
+            parser.SetExpr(formula);
+            for (; i < end; i++) {
+                x = minu_p + i * dx;
+                for (int j = 0; j < columns; j++) {
+                    y = minv_p + j * dy;
+                    data[i][j] = parser.Eval();
+                }
+            }
+        } catch (mu::ParserError &e) {
+            errors[chunk] = QStringFromString(e.GetMsg());
+            for (; i < end; i++)
+                std::fill_n(data[i], columns, 0.0);
+        }
+    });
+    for (const QString &error : errors)
+        if (!error.isEmpty()) {
+            QMessageBox::critical(0, "Input function error", error);
+            return false;
+        }
+    return true;
+}
+
+bool UserFunction::create()
+{
+    if ((umesh_p <= 2) || (vmesh_p <= 2) || !plotwidget_p)
+        return false;
+
+    double **data = Matrix::allocateMatrixData(umesh_p, vmesh_p);
+    evaluateMesh(data);
+    for (unsigned i = 0; i < umesh_p; i++)
+        for (unsigned j = 0; j < vmesh_p; j++) {
+            if (data[i][j] > range_p.maxVertex.z)
+                data[i][j] = range_p.maxVertex.z;
+            else if (data[i][j] < range_p.minVertex.z)
+                data[i][j] = range_p.minVertex.z;
+        }
+
+    static_cast<SurfacePlot *>(plotwidget_p)
+            ->loadFromData(data, umesh_p, vmesh_p, minu_p, maxu_p, minv_p, maxv_p);
+    Matrix::freeMatrixData(data, umesh_p);
+    return true;
+}
+
 UserFunction::~UserFunction() { }
 
 Graph3D::Graph3D(const QString &label, QWidget *parent, const char *name, Qt::WindowFlags f)
@@ -36,12 +36,15 @@
 #include <QVector>
 #include <QEvent>
 
+#include <memory>
+
 #include "Table.h"
 #include "Matrix.h"
 
 using namespace Qwt3D;
 
 class UserFunction;
+class MyParser;
 
 /*!\brief 3D graph widget.
  *
@@ -390,17 +393,27 @@ private:
     Qwt3D::PLOTSTYLE style_;
 };
 
-//! Class for user defined functions
+//! Surface of an analytic function z = f(x, y)
+/**
+ * The formula is parsed once; the parser's x and y variables are bound to members, so that
+ * evaluating a point only means running muParser's bytecode. For filling the whole mesh, create()
+ * uses evaluateMesh(), which splits the mesh rows among several threads.
+ */
 class UserFunction : public Function
 {
 public:
     UserFunction(const QString &s, SurfacePlot &pw);
     ~UserFunction();
-    double operator()(double x, double y);
+    double operator()(double x, double y) override;
+    bool create() override;
+    //! Evaluate the function on the current mesh and domain, without clipping to the z range.
+    bool evaluateMesh(double **data);
     QString function() { return formula; };
 
 private:
     QString formula;
+    std::unique_ptr<MyParser> d_parser;
+    double d_x, d_y;
 };
 
 #endif // Plot3D_H
@@ -118,9 +118,11 @@ void Interpolation::calculateOutputData(double *x, double *y)
     gsl_spline_init(interp, d_x, d_y, d_n);
 
     double step = (d_to - d_from) / (double)(d_points - 1);
-    for (int j = 0; j < d_points; j++) {
+    for (int j = 0; j < d_points && !isCancelled(); j++) {
         x[j] = d_from + j * step;
         y[j] = gsl_spline_eval(interp, x[j], acc);
+        if (j % 65536 == 0)
+            setProgress(double(j) / d_points);
     }
 
     gsl_spline_free(interp);
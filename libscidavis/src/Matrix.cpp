@@ -31,6 +31,10 @@
 #include "Matrix.h"
 #include "future/matrix/MatrixView.h"
 #include "ScriptEdit.h"
+#include "lib/ParallelFor.h"
+#ifdef SCRIPTING_MUPARSER
+#include "MuParserScript.h"
+#endif
 
 #include <QtGlobal>
 #include <QTextStream>
@@ -51,11 +55,14 @@
 #include <QPainter>
 #include <QLocale>
 #include <QXmlStreamWriter>
+#include <QTextCodec>
+#include <QTemporaryFile>
 #include <QtDebug>
 
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <atomic>
 
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_math.h>
@@ -123,6 +130,93 @@ void Matrix::init(int, int)
 
 Matrix::~Matrix() { }
 
+//! XML written by future::Matrix::save(), along with what it depends on (see Table::SerializedXml)
+struct Matrix::SerializedXml
+{
+    SerializedXml(const future::Matrix *matrix, bool binary_data);
+    //! Take XML which has already been written, e.g. AbstractPart::pendingData()
+    explicit SerializedXml(const QString &xml) : tmp_string(xml), xml_chars(xml.length()) { }
+    //! Write the complete <matrix> element to \c device
+    void write(QIODevice *device, const QString &geometry);
+    //! Whether the XML is in a file and still describes \c matrix
+    bool isValidFor(const future::Matrix *matrix, bool binary_data) const;
+
+    QTemporaryFile tmp_file;
+    QString tmp_string;
+    //! Whether the XML went to tmp_file, which is closed between saves to spare file handles
+    bool in_file = false;
+    //! Number of characters of the XML; this is needed in case there are newlines in it
+    int xml_chars = 0;
+    bool binary_data = false;
+    quint64 revision = 0;
+    // resizing header sections doesn't count as a modification, but sizes are saved
+    QList<int> column_widths;
+    QList<int> row_heights;
+};
+
+Matrix::SerializedXml::SerializedXml(const future::Matrix *matrix, bool binary_data)
+    : binary_data(binary_data)
+{
+    revision = matrix->revision();
+    for (int i = 0; i < matrix->columnCount(); i++)
+        column_widths << matrix->columnWidth(i);
+    for (int i = 0; i < matrix->rowCount(); i++)
+        row_heights << matrix->rowHeight(i);
+    QXmlStreamWriter xml(&tmp_string);
+    in_file = tmp_file.open();
+    if (in_file)
+        xml.setDevice(&tmp_file);
+    matrix->save(&xml, binary_data);
+
+    if (in_file) {
+        tmp_file.seek(0);
+        QTextStream count(&tmp_file);
+        count.setCodec(QTextCodec::codecForName("UTF-8"));
+        while (!count.atEnd())
+            xml_chars += count.read(65536).length();
+        tmp_file.close();
+    } else
+        xml_chars = tmp_string.length();
+}
+
+bool Matrix::SerializedXml::isValidFor(const future::Matrix *matrix, bool binary_data) const
+{
+    // temporary files may get cleaned up behind our back during long sessions
+    if (!in_file || !tmp_file.exists() || binary_data != this->binary_data
+        || matrix->revision() != revision || matrix->columnCount() != column_widths.size()
+        || matrix->rowCount() != row_heights.size())
+        return false;
+    for (int i = 0; i < column_widths.size(); i++)
+        if (matrix->columnWidth(i) != column_widths.at(i))
+            return false;
+    for (int i = 0; i < row_heights.size(); i++)
+        if (matrix->rowHeight(i) != row_heights.at(i))
+            return false;
+    return true;
+}
+
+void Matrix::SerializedXml::write(QIODevice *device, const QString &geometry)
+{
+    QTextStream stream(device);
+    stream.setCodec(QTextCodec::codecForName("UTF-8"));
+    stream << "<matrix>\n";
+    stream << xml_chars << "\n";
+    stream.flush();
+
+    if (in_file && tmp_file.open()) {
+        qint64 bytes_read;
+        char buffer[65536];
+        while ((bytes_read = tmp_file.read(buffer, sizeof(buffer))) > 0)
+            device->write(buffer, bytes_read);
+        tmp_file.close();
+    } else
+        stream << tmp_string;
+    stream << "\n";
+
+    stream << geometry << "\n";
+    stream << "</matrix>\n";
+}
+
 void Matrix::handleChange()
 {
     emit modifiedWindow(this);
@@ -174,6 +268,23 @@ void Matrix::setText(int row, int col, const QString &new_text)
     }
 }
 
+void Matrix::saveToDevice(QIODevice *device, const QString &geometry, bool binary_data)
+{
+    if (!d_saved_xml || !d_saved_xml->isValidFor(d_future_matrix, binary_data))
+        d_saved_xml.reset(new SerializedXml(d_future_matrix, binary_data));
+    d_saved_xml->write(device, geometry);
+}
+
+void Matrix::saveToDevice(const future::Matrix *matrix, QIODevice *device,
+                          const QString &geometry, bool binary_data)
+{
+    // parsing postponed XML would create undo commands, which only the GUI thread may do
+    if (matrix->hasPendingData())
+        SerializedXml(QString::fromUtf8(matrix->pendingData())).write(device, geometry);
+    else
+        SerializedXml(matrix, binary_data).write(device, geometry);
+}
+
 void Matrix::setCoordinates(double xs, double xe, double ys, double ye)
 {
     d_future_matrix->setCoordinates(xs, xe, ys, ye);
@@ -281,6 +392,7 @@ void Matrix::setDimensions(int rows, int cols)
 
 int Matrix::numRows()
 {
+    loadPendingData();
     return d_future_matrix->rowCount();
 }
 
@@ -291,6 +403,7 @@ void Matrix::setNumRows(int rows)
 
 int Matrix::numCols()
 {
+    loadPendingData();
     return d_future_matrix->columnCount();
 }
 
@@ -393,11 +506,22 @@ void Matrix::forgetSavedCells()
 bool Matrix::recalculate()
 {
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    Script *script = scriptEnv->newScript(formula(), this, QString("<%1>").arg(name()));
-    connect(script, SIGNAL(error(const QString &, const QString &, int)), scriptEnv,
-            SIGNAL(error(const QString &, const QString &, int)));
-    connect(script, SIGNAL(print(const QString &)), scriptEnv, SIGNAL(print(const QString &)));
-    if (!script->compile()) {
+    FirstScriptError first_error;
+    auto newScript = [&]() -> Script * {
+        Script *script = scriptEnv->newScript(formula(), this, QString("<%1>").arg(name()));
+        first_error.watch(script);
+        connect(script, SIGNAL(print(const QString &)), scriptEnv, SIGNAL(print(const QString &)));
+        if (!script->compile()) {
+            delete script;
+            return nullptr;
+        }
+        return script;
+    };
+    QList<Script *> scripts;
+    if (Script *script = newScript())
+        scripts << script;
+    else {
+        first_error.report(scriptEnv);
         QApplication::restoreOverrideCursor();
         return false;
     }
@@ -409,34 +533,68 @@ bool Matrix::recalculate()
     int startCol = firstSelectedColumn(false);
     int endCol = lastSelectedColumn(false);
 
-    QVariant ret;
     saveCellsToMemory();
+    double x0 = xStart();
+    double y0 = yStart();
     double dx = fabs(xEnd() - xStart()) / (double)(numRows() - 1);
     double dy = fabs(yEnd() - yStart()) / (double)(numCols() - 1);
     std::pair<double, bool> unsetValue(std::numeric_limits<double>::quiet_NaN(), false);
     std::vector<std::vector<std::pair<double, bool>>> calculatedValues(
             endRow - startRow + 1,
             std::vector<std::pair<double, bool>>(endCol - startCol + 1, unsetValue));
+    // the selection lives in the view, which can only be queried from the GUI thread
     for (int row = startRow; row <= endRow; row++)
-        for (int col = startCol; col <= endCol; col++) {
-            if (!isCellSelected(row, col))
-                continue;
-            script->setInt(row + 1, "i");
-            script->setInt(row + 1, "row");
-            script->setDouble(yStart() + row * dy, "y");
-            script->setInt(col + 1, "j");
-            script->setInt(col + 1, "col");
-            script->setDouble(xStart() + col * dx, "x");
-            ret = script->eval();
-            if (!ret.isValid()) {
-                forgetSavedCells();
-                blockSignals(false);
-                emit modifiedWindow(this);
-                QApplication::restoreOverrideCursor();
-                return false;
+        for (int col = startCol; col <= endCol; col++)
+            calculatedValues[row - startRow][col - startCol].second = isCellSelected(row, col);
+
+    // MuParserScript instances can run concurrently, so split the rows among several of them,
+    // unless the formula carries variables from one cell to the next
+    int chunks = 1;
+#ifdef SCRIPTING_MUPARSER
+    auto muparser_script = qobject_cast<MuParserScript *>(scripts.first());
+    // worker threads must not trigger reading postponed table data
+    if (muparser_script)
+        muparser_script->loadReferencedTables();
+    if (muparser_script
+        && muparser_script->isRowIndependent({ "i", "row", "y", "j", "col", "x" }))
+        chunks = parallelChunks((endRow - startRow + 1) * (endCol - startCol + 1), 1000);
+    while (scripts.size() < chunks) {
+        Script *script = newScript();
+        if (!script)
+            break;
+        scripts << script;
+    }
+    chunks = scripts.size();
+#endif
+    std::atomic<bool> failed(false);
+    parallelFor(startRow, endRow + 1, chunks, [&](int chunk, int begin, int end) {
+        Script *script = scripts.at(chunk);
+        for (int row = begin; row < end && !failed; row++)
+            for (int col = startCol; col <= endCol && !failed; col++) {
+                std::pair<double, bool> &value = calculatedValues[row - startRow][col - startCol];
+                if (!value.second)
+                    continue;
+                script->setInt(row + 1, "i");
+                script->setInt(row + 1, "row");
+                script->setDouble(y0 + row * dy, "y");
+                script->setInt(col + 1, "j");
+                script->setInt(col + 1, "col");
+                script->setDouble(x0 + col * dx, "x");
+                QVariant ret = script->eval();
+                if (!ret.isValid())
+                    failed = true;
+                value.first = ret.toDouble();
             }
-            calculatedValues[row - startRow][col - startCol] = std::make_pair(ret.toDouble(), true);
-        }
+    });
+    qDeleteAll(scripts);
+    first_error.report(scriptEnv);
+    if (failed) {
+        forgetSavedCells();
+        blockSignals(false);
+        emit modifiedWindow(this);
+        QApplication::restoreOverrideCursor();
+        return false;
+    }
     d_future_matrix->setCells(startRow, startCol, calculatedValues);
     forgetSavedCells();
 
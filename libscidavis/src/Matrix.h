@@ -40,6 +40,7 @@
 #include "ScriptingEnv.h"
 #include "Script.h"
 #include <qwt_double_rect.h>
+#include <memory>
 #include "future/matrix/future_Matrix.h"
 #include "future/matrix/MatrixView.h"
 
@@ -122,6 +123,7 @@ public:
      */
     void customEvent(QEvent *e);
     void closeEvent(QCloseEvent *);
+    virtual void loadPendingData() { d_future_matrix->loadPendingData(); }
 
     void updateDecimalSeparators();
 
@@ -219,6 +221,14 @@ public slots:
 
     //! Return a string to save the matrix in a project file (\<matrix\> section)
     QString saveToString(const QString &info);
+    //! Write the matrix to \c device, see Table::saveToDevice()
+    void saveToDevice(QIODevice *device, const QString &geometry, bool binary_data);
+    //! Write \c matrix to \c device in the same format as saveToDevice()
+    /**
+     * This only accesses \c matrix, so it may run in a background thread.
+     */
+    static void saveToDevice(const future::Matrix *matrix, QIODevice *device,
+                             const QString &geometry, bool binary_data);
     //! Return a string conaining the data of the matrix (\<data\> section)
     QString saveText();
 
@@ -309,6 +319,10 @@ private:
     //! Initialize the matrix
     void init(int rows, int cols);
 
+    //! Serialized XML of d_future_matrix, kept across saves while the matrix doesn't change
+    struct SerializedXml;
+    std::unique_ptr<SerializedXml> d_saved_xml;
+
     //! Stores the matrix data only before the user opens the matrix dialog in order to avoid data loses during number format changes.
     double **dMatrix;
 
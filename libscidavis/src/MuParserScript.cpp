@@ -37,7 +37,9 @@
 #include "Table.h"
 #include "Matrix.h"
 #include "Folder.h"
+#include "lib/ParallelFor.h"
 #include <math.h>
+#include <algorithm>
 #include <QtCore/QByteArray>
 #include <QtCore/QRegExp>
 
@@ -131,51 +133,65 @@
  * need access to the current project and table/matrix (via #Context), so eval() sets this variable
  * before actually evaluating code for the benefit of column(), cell() etc. implementations.
  *
+ * The pointer is thread-local, so that different instances can be evaluated concurrently (e.g. in
+ * Table::recalculate()). All other state is held per instance; a single instance must not be used
+ * by more than one thread at a time.
+ *
  * \sa tableColumnFunction(), tableColumn_Function(), tableColumn__Function(), tableCellFunction()
  * \sa tableCell_Function(), matrixCellFunction()
  */
-MuParserScript *MuParserScript::s_currentInstance = 0;
+thread_local MuParserScript *MuParserScript::s_currentInstance = 0;
 
 MuParserScript::MuParserScript(ScriptingEnv *environment, const QString &code, QObject *context,
                                const QString &name)
-    : Script(environment, code, context, name)
+    : Script(environment, code, context, name), m_vectorCompiled(notCompiled)
 {
     m_parser.SetVarFactory(variableFactory, this);
 
+    initParser(m_parser);
+
+    // tell parser about table/matrix access functions
+    if (Context && Context->inherits("Table")) {
+        m_parser.DefineFun(_T("column"), tableColumnFunction, false);
+        m_parser.DefineFun(_T("column_"), tableColumn_Function, false);
+        m_parser.DefineFun(_T("column__"), tableColumn__Function, false);
+        m_parser.DefineFun(_T("cell"), tableCellFunction);
+        m_parser.DefineFun(_T("cell_"), tableCell_Function);
+    } else if (Context && Context->inherits("Matrix"))
+        m_parser.DefineFun(_T("cell"), matrixCellFunction);
+}
+
+/**
+ * \brief Define operator characters, constants and mathematical functions common to all parsers.
+ *
+ * Table/matrix access functions are not included, since they depend on #Context.
+ */
+void MuParserScript::initParser(mu::Parser &parser)
+{
     static const auto opChars =
             // standard operator chars as defined in mu::Parser::InitCharSets()
             _T("abcdefghijklmnopqrstuvwxyz")
             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
             "+-*^/?<>=#!$%&|~'_";
 
-    m_parser.DefineOprtChars(opChars);
-    m_parser.DefineInfixOprtChars(opChars);
+    parser.DefineOprtChars(opChars);
+    parser.DefineInfixOprtChars(opChars);
 
     // aliases for _pi and _e
-    m_parser.DefineConst(_T("pi"), M_PI);
-    m_parser.DefineConst(_T("Pi"), M_PI);
-    m_parser.DefineConst(_T("PI"), M_PI);
-    m_parser.DefineConst(_T("e"), M_E);
-    m_parser.DefineConst(_T("E"), M_E);
+    parser.DefineConst(_T("pi"), M_PI);
+    parser.DefineConst(_T("Pi"), M_PI);
+    parser.DefineConst(_T("PI"), M_PI);
+    parser.DefineConst(_T("e"), M_E);
+    parser.DefineConst(_T("E"), M_E);
 
     // tell parser about mathematical functions
     for (const MuParserScripting::mathFunction *i = MuParserScripting::math_functions; i->name; i++)
         if (i->numargs == 1 && i->fun1 != NULL)
-            m_parser.DefineFun(i->name, i->fun1);
+            parser.DefineFun(i->name, i->fun1);
         else if (i->numargs == 2 && i->fun2 != NULL)
-            m_parser.DefineFun(i->name, i->fun2);
+            parser.DefineFun(i->name, i->fun2);
         else if (i->numargs == 3 && i->fun3 != NULL)
-            m_parser.DefineFun(i->name, i->fun3);
-
-    // tell parser about table/matrix access functions
-    if (Context && Context->inherits("Table")) {
-        m_parser.DefineFun(_T("column"), tableColumnFunction, false);
-        m_parser.DefineFun(_T("column_"), tableColumn_Function, false);
-        m_parser.DefineFun(_T("column__"), tableColumn__Function, false);
-        m_parser.DefineFun(_T("cell"), tableCellFunction);
-        m_parser.DefineFun(_T("cell_"), tableCell_Function);
-    } else if (Context && Context->inherits("Matrix"))
-        m_parser.DefineFun(_T("cell"), matrixCellFunction);
+            parser.DefineFun(i->name, i->fun3);
 }
 
 /**
@@ -188,6 +204,7 @@ MuParserScript::MuParserScript(ScriptingEnv *environment, const QString &code, Q
 double *MuParserScript::variableFactory(const mu::string_type::value_type *name, void *self)
 {
     MuParserScript *me = static_cast<MuParserScript *>(self);
+    me->m_implicitVariables << QStringFromString(name);
     return me->m_variables.insert(QStringFromString(name), NAN).operator->();
 }
 
@@ -230,7 +247,7 @@ bool MuParserScript::setDouble(double value, const char *name)
  */
 double MuParserScript::tableColumnFunction(const mu::string_type::value_type *columnPath)
 {
-    Column *column = s_currentInstance->resolveColumnPath(QStringFromString(columnPath));
+    Column *column = s_currentInstance->cachedColumnPath(columnPath);
     if (!column)
         return NAN; // failsafe, shouldn't happen
     int row = qRound(s_currentInstance->m_variables["i"]) - 1;
@@ -318,7 +335,7 @@ double MuParserScript::tableColumn__Function(const mu::string_type::value_type *
 double MuParserScript::tableCellFunction(const mu::string_type::value_type *columnPath,
                                          double rowIndex)
 {
-    Column *column = s_currentInstance->resolveColumnPath(QStringFromString(columnPath));
+    Column *column = s_currentInstance->cachedColumnPath(columnPath);
     if (!column)
         return NAN; // failsafe, shouldn't happen
     int row = qRound(rowIndex) - 1;
@@ -471,6 +488,82 @@ Column *MuParserScript::resolveColumnPath(const QString &path)
     return result;
 }
 
+/**
+ * \brief Look up the column specified by path, reusing the result of earlier lookups.
+ *
+ * Column functions get called once per row, so resolving the path every time (see
+ * resolveColumnPath()) would dominate the cost of simple formulas. Instead, resolved columns are
+ * remembered until an aspect of the project is renamed, added or removed (see clearColumnCache()).
+ */
+Column *MuParserScript::cachedColumnPath(const mu::string_type &path)
+{
+    auto cached = m_columnCache.find(path);
+    if (cached != m_columnCache.end())
+        return cached->second;
+
+    Column *result = resolveColumnPath(QStringFromString(path));
+    const AbstractAspect *root = result;
+    while (root->parentAspect())
+        root = root->parentAspect();
+    connect(root, SIGNAL(aspectDescriptionChanged(const AbstractAspect *)), this,
+            SLOT(clearColumnCache()), Qt::UniqueConnection);
+    connect(root, SIGNAL(aspectAdded(const AbstractAspect *)), this, SLOT(clearColumnCache()),
+            Qt::UniqueConnection);
+    connect(root, SIGNAL(aspectAboutToBeRemoved(const AbstractAspect *)), this,
+            SLOT(clearColumnCache()), Qt::UniqueConnection);
+    connect(result, SIGNAL(destroyed()), this, SLOT(clearColumnCache()), Qt::UniqueConnection);
+    m_columnCache.emplace(path, result);
+    return result;
+}
+
+/**
+ * \brief Make sure the tables the expression refers to have read all their data.
+ *
+ * Tables of projects opened with data reading postponed (see AbstractPart::loadPendingData())
+ * read their data when they are looked up, which has to happen in the GUI thread. Scripts which
+ * are going to be evaluated on worker threads (see Table::recalculate()) therefore need to call
+ * this in the GUI thread first. Column paths are always string literals, so looking at the
+ * expression is enough. Errors are not reported here; eval() will do that.
+ */
+void MuParserScript::loadReferencedTables()
+{
+    if (compiled != Script::isCompiled && !compile())
+        return;
+    if (MyWidget *myContext = qobject_cast<MyWidget *>(Context))
+        myContext->loadPendingData();
+
+    // column("path") and cell("path", row)
+    QRegExp pathCall("(\\W|^)(column|cell)\\s*\\(\\s*\"((?:[^\"\\\\]|\\\\.)*)\"");
+    for (int pos = 0; (pos = pathCall.indexIn(m_expression, pos)) != -1;
+         pos += pathCall.matchedLength()) {
+        // muParser un-escapes quotation marks in string literals; the rest is up to resolveColumnPath()
+        QString path = pathCall.cap(3).replace("\\\"", "\"");
+        try {
+            cachedColumnPath(toString<mu::string_type>(path));
+        } catch (mu::ParserError &) {
+            // left to eval()
+        }
+    }
+
+    // column__("table", index)
+    Table *thisTable = qobject_cast<Table *>(Context);
+    QRegExp tableCall("(\\W|^)column__\\s*\\(\\s*\"((?:[^\"\\\\]|\\\\.)*)\"");
+    for (int pos = 0; thisTable && (pos = tableCall.indexIn(m_expression, pos)) != -1;
+         pos += tableCall.matchedLength())
+        thisTable->folder()->rootFolder()->table(tableCall.cap(2).replace("\\\"", "\""), true);
+}
+
+/**
+ * \brief Forget all columns resolved by cachedColumnPath().
+ *
+ * Renaming, adding or removing aspects (or moving tables between folders) can change which column
+ * a path refers to, so we don't try to be clever here.
+ */
+void MuParserScript::clearColumnCache()
+{
+    m_columnCache.clear();
+}
+
 /**
  * \brief Do in-place translation of overloaded functions.
  *
@@ -696,10 +789,208 @@ bool MuParserScript::compile(bool asFunction)
         return false;
     }
 
+    m_expression = intermediate;
+    m_vectorCompiled = notCompiled;
     compiled = isCompiled;
     return true;
 }
 
+/**
+ * \brief Build the vector program used by evalVector().
+ *
+ * Every column("path") call with a literal path is replaced by a variable which evalVector() binds
+ * to a buffer holding the values of the column. The resulting expression is handed to a separate
+ * parser which knows about the mathematical functions, but neither about cell access functions nor
+ * about user-defined variables. Expressions using these (or column_() and column__(), which depend
+ * on the current row in a way muParser's bulk mode can't follow) will fail to parse in evalVector()
+ * and need to be evaluated row by row.
+ */
+bool MuParserScript::compileVector()
+{
+    if (compiled != Script::isCompiled && !compile())
+        return false;
+    if (m_vectorCompiled != notCompiled)
+        return m_vectorCompiled == isCompiled;
+    m_vectorCompiled = compileErr;
+    m_vectorColumns.clear();
+
+    QString expression = m_expression;
+    QRegExp columnCall("(\\W|^)column\\s*\\(\\s*\"((?:[^\"\\\\]|\\\\.)*)\"\\s*\\)");
+    int pos = 0;
+    while ((pos = columnCall.indexIn(expression, pos)) != -1) {
+        // muParser un-escapes quotation marks in string literals, resolveColumnPath() does the rest
+        QString path = columnCall.cap(2).replace("\\\"", "\"");
+        int index = m_vectorColumns.indexOf(path);
+        if (index < 0) {
+            index = m_vectorColumns.size();
+            m_vectorColumns << path;
+        }
+        QString variable = QString("__column%1").arg(index);
+        int start = pos + columnCall.cap(1).length();
+        expression.replace(start, columnCall.matchedLength() - columnCall.cap(1).length(), variable);
+        pos = start + variable.length();
+    }
+
+    m_vectorParser.reset(new mu::Parser);
+    initParser(*m_vectorParser);
+    try {
+        m_vectorParser->SetExpr(toString<mu::string_type>(expression));
+    } catch (mu::ParserError &) {
+        m_vectorParser.reset();
+        return false;
+    }
+    m_vectorCompiled = isCompiled;
+    return true;
+}
+
+/**
+ * \brief Whether the rows (or cells) of a table or matrix can be evaluated independently.
+ *
+ * \arg \c rowVariables Variables which will be set for each row, like "i".
+ *
+ * This is not the case if the expression uses variables other than \c rowVariables and those set
+ * using setDouble() or setInt(): these are assigned to by the expression itself and may carry
+ * values from one row to the next, e.g. to accumulate a sum. Such expressions have to be
+ * evaluated by a single instance, row after row.
+ */
+bool MuParserScript::isRowIndependent(const QStringList &rowVariables)
+{
+    if (compiled != Script::isCompiled && !compile())
+        return false;
+    try {
+        const mu::varmap_type &used = m_parser.GetUsedVar();
+        for (auto it = used.begin(); it != used.end(); ++it) {
+            QString name = QStringFromString(it->first);
+            if (!rowVariables.contains(name)
+                && (!m_variables.contains(name) || m_implicitVariables.contains(name)))
+                return false;
+        }
+    } catch (mu::ParserError &) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Evaluate the script for a block of consecutive table rows in a single pass.
+ *
+ * \arg \c firstRow 0-based index of the first row to evaluate. The number of rows is given by the
+ * size of \c results.
+ * \arg \c results Receives one value per row.
+ * \arg \c scalarRows Receives the (ascending) indices of rows which still need to be evaluated
+ * individually using eval(), because one of the columns they refer to is invalid in that row.
+ *
+ * Instead of calling eval() once per row, this reads all referenced columns into buffers and lets
+ * muParser evaluate its bytecode over the whole block (using muParser's bulk mode). The row
+ * variable "i" runs from firstRow+1 onwards; other variables set using setDouble() or setInt() are
+ * constant over the block.
+ *
+ * Returns false if the expression can't be evaluated this way (see compileVector()), in which case
+ * the caller has to fall back to eval(). Errors are not reported here; eval() will do that.
+ */
+bool MuParserScript::evalVector(int firstRow, QVector<double> &results, QList<int> &scalarRows)
+{
+    scalarRows.clear();
+    if (!compileVector())
+        return false;
+
+    int rows = results.size();
+    // the parser keeps pointers into these buffers, so they must not be copied or reallocated
+    QList<QVector<double>> buffers;
+    auto defineBuffer = [&](const QString &name) {
+        buffers << QVector<double>(rows);
+        double *buffer = buffers.last().data();
+        m_vectorParser->DefineVar(toString<mu::string_type>(name), buffer);
+        return buffer;
+    };
+    try {
+        m_vectorParser->ClearVar();
+
+        // the row variable
+        double *rowNumbers = defineBuffer("i");
+        for (int k = 0; k < rows; k++)
+            rowNumbers[k] = firstRow + k + 1;
+
+        // in bulk mode, muParser reads every variable as an array; variables assigned to within
+        // the expression are left undefined, since they may carry state from one row to the next
+        for (auto it = m_variables.constBegin(); it != m_variables.constEnd(); ++it)
+            if (it.key() != "i" && !m_implicitVariables.contains(it.key()))
+                std::fill_n(defineBuffer(it.key()), rows, it.value());
+
+        // referenced columns; rows with invalid source values are left to eval()
+        QVector<bool> invalid(rows, false);
+        for (int c = 0; c < m_vectorColumns.size(); c++) {
+            Column *column = cachedColumnPath(toString<mu::string_type>(m_vectorColumns.at(c)));
+            double *values = defineBuffer(QString("__column%1").arg(c));
+            QVector<bool> columnInvalid = column->invalidBitmap(firstRow, rows);
+            for (int k = 0; k < rows; k++) {
+                if (columnInvalid.at(k))
+                    invalid[k] = true;
+                else
+                    values[k] = column->valueAt(firstRow + k);
+            }
+        }
+        for (int k = 0; k < rows; k++)
+            if (invalid.at(k))
+                scalarRows << firstRow + k;
+
+        if (rows > 0)
+            m_vectorParser->Eval(results.data(), rows);
+    } catch (mu::ParserError &) {
+        scalarRows.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Evaluate the script for many values of one variable in a single pass.
+ *
+ * Stores the result for the i-th element of \c values in \c results[i], as setting \c variable to
+ * that element using setDouble() and calling eval() would. Like evalVector(), this lets muParser
+ * evaluate its bytecode over the whole array. Large arrays are split among several threads, each
+ * using its own copy of the parser. All other variables set using setDouble() or setInt() are
+ * constant.
+ *
+ * Returns false if the expression can't be evaluated this way (see compileVector()); this includes
+ * expressions referring to table columns. Errors are not reported here; eval() will do that.
+ */
+bool MuParserScript::evalArray(const char *variable, const double *values, int count,
+                               double *results)
+{
+    if (!compileVector() || !m_vectorColumns.isEmpty())
+        return false;
+    if (count <= 0)
+        return true;
+
+    // the parsers keep pointers into these buffers, so they must not be reallocated; values is
+    // copied as well, since expressions may assign to variables
+    std::vector<std::pair<mu::string_type, std::vector<double>>> buffers;
+    buffers.emplace_back(toString<mu::string_type>(QString(variable)),
+                         std::vector<double>(values, values + count));
+    for (auto it = m_variables.constBegin(); it != m_variables.constEnd(); ++it)
+        if (it.key() != variable && !m_implicitVariables.contains(it.key()))
+            buffers.emplace_back(toString<mu::string_type>(it.key()),
+                                 std::vector<double>(count, it.value()));
+
+    int chunks = parallelChunks(count, 10000);
+    std::vector<std::unique_ptr<mu::Parser>> copies;
+    for (int chunk = 1; chunk < chunks; chunk++)
+        copies.emplace_back(new mu::Parser(*m_vectorParser));
+    try {
+        parallelFor(0, count, chunks, [&](int chunk, int begin, int end) {
+            mu::Parser &parser = chunk == 0 ? *m_vectorParser : *copies[chunk - 1];
+            parser.ClearVar();
+            for (auto &buffer : buffers)
+                parser.DefineVar(buffer.first, buffer.second.data() + begin);
+            parser.Eval(results + begin, end - begin);
+        });
+    } catch (mu::ParserError &) {
+        return false;
+    }
+    return true;
+}
+
 QVariant MuParserScript::eval()
 {
     if (compiled != Script::isCompiled && !compile())
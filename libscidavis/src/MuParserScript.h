@@ -33,7 +33,12 @@
 #include "Script.h"
 #include "QStringStdString.h"
 #include <QtCore/QMap>
+#include <QtCore/QVector>
+#include <QtCore/QStringList>
+#include <QtCore/QSet>
 #include <muParser.h>
+#include <memory>
+#include <unordered_map>
 
 class QByteArray;
 class Column;
@@ -67,7 +72,18 @@ public slots:
         return setDouble(static_cast<double>(value), name);
     }
 
+public:
+    bool evalVector(int firstRow, QVector<double> &results, QList<int> &scalarRows);
+    bool evalArray(const char *variable, const double *values, int count, double *results);
+    bool isRowIndependent(const QStringList &rowVariables);
+    void loadReferencedTables();
+
+private slots:
+    void clearColumnCache();
+
 private:
+    static void initParser(mu::Parser &parser);
+    bool compileVector();
     static double *variableFactory(const mu::string_type::value_type *name, void *self);
     static double tableColumnFunction(const mu::string_type::value_type *columnPath);
     static double tableColumn_Function(double columnIndex);
@@ -79,13 +95,21 @@ private:
 
 protected:
     Column *resolveColumnPath(const QString &path);
+    Column *cachedColumnPath(const mu::string_type &path);
     bool translateLegacyFunctions(QString &input);
 
 private:
     mu::Parser m_parser;
     QMap<QString, double> m_variables;
+    QSet<QString> m_implicitVariables;
+    QString m_expression;
+
+    std::unique_ptr<mu::Parser> m_vectorParser;
+    compileStatus m_vectorCompiled;
+    QStringList m_vectorColumns;
+    std::unordered_map<mu::string_type, Column *> m_columnCache;
 
-    static MuParserScript *s_currentInstance;
+    static thread_local MuParserScript *s_currentInstance;
 };
 
 #endif // ifndef MU_PARSER_SCRIPT_H
@@ -34,6 +34,7 @@
 #include <QMessageBox>
 #include <QEvent>
 #include <QCloseEvent>
+#include <QShowEvent>
 #include <QString>
 #include <QLocale>
 #include <QIcon>
@@ -132,11 +133,20 @@ void MyWidget::changeEvent(QEvent *event)
             w_status = Maximized;
         else
             w_status = Normal;
+        if (w_status != Minimized)
+            loadPendingData();
         emit statusChanged(this);
     }
     QMdiSubWindow::changeEvent(event);
 }
 
+void MyWidget::showEvent(QShowEvent *event)
+{
+    if (!isMinimized())
+        loadPendingData();
+    QMdiSubWindow::showEvent(event);
+}
+
 void MyWidget::contextMenuEvent(QContextMenuEvent *e)
 {
     if (!this->widget()->geometry().contains(e->pos())) {
@@ -34,6 +34,7 @@
 #include <QMdiSubWindow>
 class QEvent;
 class QCloseEvent;
+class QShowEvent;
 class QString;
 class Folder;
 
@@ -122,6 +123,13 @@ public:
 
     virtual QString saveToString(const QString &) { return QString(); };
 
+    //! Read content whose loading was postponed when opening the project
+    /**
+     * This is done automatically when the window is shown (other than minimized).
+     * \sa AbstractPart::setPendingData()
+     */
+    virtual void loadPendingData() {};
+
     //!Notifies that a window was hidden by a direct user action
     virtual void setHidden();
 
@@ -168,6 +176,7 @@ protected slots:
 
 protected:
     virtual void changeEvent(QEvent *event);
+    virtual void showEvent(QShowEvent *event);
     //!Pointer to the parent folder of the window
     Folder *parentFolder;
     //! The window label
@@ -134,17 +134,17 @@ QList<QVector<double>> DataCurve::convertData(const QList<Column *> &cols,
             end_row = col->rowCount() - 1;
 
     // determine rows for which all columns have valid content
-    QList<int> valid_rows;
-    for (int row = d_start_row; row <= end_row; row++) {
-        bool all_valid = true;
-        foreach (Column *col, cols)
-            if (col->isInvalid(row)) {
-                all_valid = false;
-                break;
-            }
-        if (all_valid)
-            valid_rows.push_back(row);
+    int row_count = end_row - d_start_row + 1;
+    QVector<bool> invalid(qMax(row_count, 0), false);
+    foreach (Column *col, cols) {
+        QVector<bool> col_invalid = col->invalidBitmap(d_start_row, row_count);
+        for (int i = 0; i < invalid.size(); i++)
+            invalid[i] = invalid[i] || col_invalid[i];
     }
+    QList<int> valid_rows;
+    for (int i = 0; i < invalid.size(); i++)
+        if (!invalid[i])
+            valid_rows.push_back(d_start_row + i);
 
     // initialize result list
     QList<QVector<double>> result;
@@ -125,6 +125,25 @@ void PolynomialFit::fit()
         return;
     }
 
+    int iterations, status;
+    // the fit is a single GSL call, which can't be cancelled
+    runInBackground([&]() { computeFit(iterations, status); }, false);
+
+    ApplicationWindow *app = (ApplicationWindow *)parent();
+    if (app->writeFitResultsToLog)
+        app->updateLog(logFitInfo(d_results, 0, 0, d_graph->parentPlotName()));
+
+    if (show_legend || app->pasteFitResultsToPlot)
+        showLegend();
+
+    generateFitCurve(d_results);
+}
+
+vector<double> PolynomialFit::computeFit(int &iterations, int &status)
+{
+    iterations = 0;
+    d_result_errors.clear();
+
     gsl_matrix *X = gsl_matrix_alloc(d_n, d_p);
     gsl_vector *c = gsl_vector_alloc(d_p);
 
@@ -142,9 +161,9 @@ void PolynomialFit::fit()
     gsl_multifit_linear_workspace *work = gsl_multifit_linear_alloc(d_n, d_p);
 
     if (d_y_error_source == UnknownErrors)
-        gsl_multifit_linear(X, &y.vector, c, covar, &chi_2, work);
+        status = gsl_multifit_linear(X, &y.vector, c, covar, &chi_2, work);
     else
-        gsl_multifit_wlinear(X, weights, &y.vector, c, covar, &chi_2, work);
+        status = gsl_multifit_wlinear(X, weights, &y.vector, c, covar, &chi_2, work);
 
     for (unsigned i = 0; i < d_p; i++)
         d_results[i] = gsl_vector_get(c, i);
@@ -153,15 +172,7 @@ void PolynomialFit::fit()
     gsl_matrix_free(X);
     gsl_vector_free(c);
     gsl_vector_free(weights);
-
-    ApplicationWindow *app = (ApplicationWindow *)parent();
-    if (app->writeFitResultsToLog)
-        app->updateLog(logFitInfo(d_results, 0, 0, d_graph->parentPlotName()));
-
-    if (show_legend || app->pasteFitResultsToPlot)
-        showLegend();
-
-    generateFitCurve(d_results);
+    return d_results;
 }
 
 QString PolynomialFit::legendInfo()
@@ -250,6 +261,22 @@ void LinearFit::fit()
         return;
     }
 
+    int iterations, status;
+    // the fit is a single GSL call, which can't be cancelled
+    runInBackground([&]() { computeFit(iterations, status); }, false);
+
+    ApplicationWindow *app = (ApplicationWindow *)parent();
+    if (app->writeFitResultsToLog)
+        app->updateLog(logFitInfo(d_results, 0, 0, d_graph->parentPlotName()));
+
+    generateFitCurve(d_results);
+}
+
+vector<double> LinearFit::computeFit(int &iterations, int &status)
+{
+    iterations = 0;
+    d_result_errors.clear();
+
     double c0, c1, cov00, cov01, cov11;
 
     std::vector<double> weights(d_n);
@@ -257,10 +284,10 @@ void LinearFit::fit()
         weights[i] = 1.0 / pow(d_y_errors[i], 2);
 
     if (d_y_error_source == UnknownErrors)
-        gsl_fit_linear(d_x, 1, d_y, 1, d_n, &c0, &c1, &cov00, &cov01, &cov11, &chi_2);
+        status = gsl_fit_linear(d_x, 1, d_y, 1, d_n, &c0, &c1, &cov00, &cov01, &cov11, &chi_2);
     else
-        gsl_fit_wlinear(d_x, 1, weights.data(), 1, d_y, 1, d_n, &c0, &c1, &cov00, &cov01, &cov11, &chi_2);
-
+        status = gsl_fit_wlinear(d_x, 1, weights.data(), 1, d_y, 1, d_n, &c0, &c1, &cov00,
+                                 &cov01, &cov11, &chi_2);
 
     d_results[0] = c0;
     d_results[1] = c1;
@@ -269,12 +296,7 @@ void LinearFit::fit()
     gsl_matrix_set(covar, 0, 1, cov01);
     gsl_matrix_set(covar, 1, 1, cov11);
     gsl_matrix_set(covar, 1, 0, cov01);
-
-    ApplicationWindow *app = (ApplicationWindow *)parent();
-    if (app->writeFitResultsToLog)
-        app->updateLog(logFitInfo(d_results, 0, 0, d_graph->parentPlotName()));
-
-    generateFitCurve(d_results);
+    return d_results;
 }
 
 bool LinearFit::calculateFitCurveData(const vector<double> &par, std::vector<double> &X,
@@ -44,6 +44,7 @@ public:
 
     QString legendInfo() override;
     void fit() override;
+    std::vector<double> computeFit(int &iterations, int &status) override;
 
     static QString generateFormula(int order);
     static QStringList generateParameterList(int order);
@@ -68,6 +69,7 @@ public:
               double end);
 
     void fit() override;
+    std::vector<double> computeFit(int &iterations, int &status) override;
 
 private:
     void init();
@@ -104,6 +104,29 @@ bool Script::exec()
     return false;
 }
 
+void FirstScriptError::watch(Script *script)
+{
+    // a direct connection, since the error is emitted in the thread running the script
+    QObject::connect(script, &Script::error,
+                     [this](const QString &message, const QString &script_name, int line_number) {
+                         std::lock_guard<std::mutex> lock(d_mutex);
+                         if (d_failed)
+                             return;
+                         d_failed = true;
+                         d_message = message;
+                         d_script_name = script_name;
+                         d_line_number = line_number;
+                     });
+}
+
+void FirstScriptError::report(ScriptingEnv *env)
+{
+    std::lock_guard<std::mutex> lock(d_mutex);
+    if (d_failed)
+        emit env->error(d_message, d_script_name, d_line_number);
+    d_failed = false;
+}
+
 scripted::scripted(ScriptingEnv *env)
 {
     env->incref();
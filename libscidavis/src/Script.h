@@ -38,6 +38,8 @@
 #include <QStringList>
 #include <QEvent>
 
+#include <mutex>
+
 #include "customevents.h"
 #include "ScriptingEnv.h"
 
@@ -139,6 +141,27 @@ protected:
     }
 };
 
+//! Passes on only the first error of scripts evaluated concurrently.
+/**
+ * Scripts run by parallelFor() would otherwise each report their error, so that a formula failing
+ * everywhere pops up one message box per thread. Errors of watched scripts are held back until
+ * report() is called from the GUI thread.
+ */
+class FirstScriptError
+{
+public:
+    //! Holds back the errors of \c script, which has to be deleted before this object.
+    void watch(Script *script);
+    //! Passes the first error held back since the last call, if any, on to \c env.
+    void report(ScriptingEnv *env);
+
+private:
+    std::mutex d_mutex;
+    bool d_failed = false;
+    QString d_message, d_script_name;
+    int d_line_number = 0;
+};
+
 //! keeps a static list of available interpreters and instantiates them on demand
 class ScriptingLangManager
 {
@@ -137,7 +137,7 @@ void SmoothCurveDialog::setGraph(Graph *g)
 
 void SmoothCurveDialog::activateCurve(const QString &curveName)
 {
-    if (smooth_method == SmoothFilter::Average) {
+    if (smooth_method == SmoothFilter::Average || smooth_method == SmoothFilter::Median) {
         QwtPlotCurve *c = graph->curve(curveName);
         if (!c || c->rtti() != QwtPlotItem::Rtti_PlotCurve)
             return;
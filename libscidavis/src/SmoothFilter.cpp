@@ -33,7 +33,18 @@
 #include <QApplication>
 #include <QMessageBox>
 
-#include <gsl/gsl_fft_halfcomplex.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "FourierTransform.h"
+#include "lib/ParallelFor.h"
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_poly.h>
@@ -65,10 +76,11 @@ void SmoothFilter::init(int m)
 
 void SmoothFilter::setMethod(int m)
 {
-    if (m < 1 || m > 3) {
+    if (m < 1 || m > 5) {
         QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
                               tr("Unknown smooth filter. Valid values are: 1 - Savitky-Golay, 2 - "
-                                 "FFT, 3 - Moving Window Average."));
+                                 "FFT, 3 - Moving Window Average, 4 - Moving Window Median, "
+                                 "5 - Exponential Moving Average."));
         d_init_err = true;
         return;
     }
@@ -98,127 +110,249 @@ void SmoothFilter::calculateOutputData(double *x, double *y)
                 + tr("average smoothing");
         smoothAverage(x, y);
         break;
+    case 4:
+        d_explanation = QString::number(d_right_points) + " " + tr("points") + " "
+                + tr("median smoothing");
+        smoothMedian(x, y);
+        break;
+    case 5:
+        d_explanation = QString::number(d_right_points) + " " + tr("points") + " "
+                + tr("exponential smoothing");
+        smoothExponential(x, y);
+        break;
     }
 }
 
 void SmoothFilter::smoothFFT(double *x, double *y)
 {
-    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(d_n);
-    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(d_n);
-    gsl_fft_real_transform(y, 1, d_n, real, work); // FFT forward
-    gsl_fft_real_wavetable_free(real);
+    if (!FourierTransform::realForward(y, d_n)) { // FFT forward
+        showError(tr("Could not allocate memory, operation aborted!"));
+        return;
+    }
 
     double df = 1.0 / (double)(x[1] - x[0]);
     double lf = df / (double)d_right_points; // frequency cutoff
-    df = 0.5 * df / (double)d_n;
+    df /= (double)d_n;
 
     for (unsigned i = 0; i < d_n; i++) {
         x[i] = d_x[i];
-        y[i] = i * df > lf ? 0 : y[i]; // filtering frequencies
+        // filtering frequencies
+        y[i] = FourierTransform::frequencyIndex(i, d_n) * df > lf ? 0 : y[i];
+    }
+
+    FourierTransform::halfcomplexInverse(y, d_n); // FFT inverse
+}
+
+namespace {
+//! Running sum with Neumaier's compensation, so that values leaving the window don't leave
+//! rounding errors behind, however many points pass through it
+class RunningSum
+{
+public:
+    void add(double value)
+    {
+        double sum = d_sum + value;
+        if (fabs(d_sum) >= fabs(value))
+            d_compensation += (d_sum - sum) + value;
+        else
+            d_compensation += (value - sum) + d_sum;
+        d_sum = sum;
     }
+    double value() const { return d_sum + d_compensation; }
+
+private:
+    double d_sum = 0.0;
+    double d_compensation = 0.0;
+};
 
-    gsl_fft_halfcomplex_wavetable *hc = gsl_fft_halfcomplex_wavetable_alloc(d_n);
-    gsl_fft_halfcomplex_inverse(y, 1, d_n, hc, work); // FFT inverse
-    gsl_fft_halfcomplex_wavetable_free(hc);
-    gsl_fft_real_workspace_free(work);
+//! Half width of the window centered on \c i; it shrinks near the edges to stay symmetric
+int windowRadius(int i, int n, int half_width)
+{
+    return std::min(std::min(i, n - 1 - i), half_width);
 }
+} // namespace
 
+/**
+ * \brief Moving window average over d_right_points points (rounded up to an odd number).
+ *
+ * Near the edges, the window shrinks so that it stays centered on the smoothed point; the first
+ * and last points are kept. Both ends of the window only ever move forward, so a running sum
+ * makes the cost independent of the window size.
+ */
 void SmoothFilter::smoothAverage(double *, double *y)
 {
-    int p2 = d_right_points / 2;
-    double m = double(2 * p2 + 1);
-    double aux = 0.0;
-    double *s = new double[d_n];
-
-    s[0] = y[0];
-    for (int i = 1; i < p2; i++) {
-        aux = 0.0;
-        for (int j = -i; j <= i; j++)
-            aux += y[i + j];
-
-        s[i] = aux / (double)(2 * i + 1);
+    const int n = int(d_n);
+    const int p2 = d_right_points / 2;
+    // input values of the current window, since y is overwritten behind its right end; there's
+    // room for one more, as the next point is added before the oldest one is dropped
+    std::vector<double> window(2 * p2 + 2);
+    // the window [first, last] has been summed up
+    int first = 0, last = -1;
+    RunningSum sum;
+    for (int i = 0; i < n && !isCancelled(); i++) {
+        int r = windowRadius(i, n, p2);
+        for (; last < i + r; last++) {
+            window[(last + 1) % window.size()] = y[last + 1];
+            sum.add(y[last + 1]);
+        }
+        for (; first < i - r; first++)
+            sum.add(-window[first % window.size()]);
+        y[i] = sum.value() / (2 * r + 1);
+        if (i % 65536 == 0)
+            setProgress(double(i) / n);
     }
-    for (unsigned i = p2; i < d_n - p2; i++) {
-        aux = 0.0;
-        for (int j = -p2; j <= p2; j++)
-            aux += y[i + j];
+}
 
-        s[i] = aux / m;
+/**
+ * \brief Moving window median, with the same window as smoothAverage().
+ *
+ * The window is kept split into its lower and upper half, so moving it costs O(log points).
+ */
+void SmoothFilter::smoothMedian(double *, double *y)
+{
+    const int n = int(d_n);
+    const int p2 = d_right_points / 2;
+    std::vector<double> window(2 * p2 + 2);
+    // lower holds one element more than upper; its largest one is the median
+    std::multiset<double> lower, upper;
+    auto balance = [&]() {
+        while (lower.size() > upper.size() + 1) {
+            upper.insert(*lower.rbegin());
+            lower.erase(std::prev(lower.end()));
+        }
+        while (upper.size() > lower.size()) {
+            lower.insert(*upper.begin());
+            upper.erase(upper.begin());
+        }
+    };
+    int first = 0, last = -1;
+    for (int i = 0; i < n && !isCancelled(); i++) {
+        int r = windowRadius(i, n, p2);
+        for (; last < i + r; last++) {
+            double value = y[last + 1];
+            window[(last + 1) % window.size()] = value;
+            if (lower.empty() || value <= *lower.rbegin())
+                lower.insert(value);
+            else
+                upper.insert(value);
+        }
+        for (; first < i - r; first++) {
+            double value = window[first % window.size()];
+            if (value <= *lower.rbegin())
+                lower.erase(lower.find(value));
+            else
+                upper.erase(upper.find(value));
+            // keep lower non-empty for the comparison above
+            balance();
+        }
+        balance();
+        y[i] = *lower.rbegin();
+        if (i % 65536 == 0)
+            setProgress(double(i) / n);
     }
-    for (unsigned i = d_n - p2; i < d_n - 1; i++) {
-        aux = 0.0;
-        for (int j = (int)(i + 1 - d_n); j < (int)(d_n - i); j++)
-            aux += y[i + j];
+}
 
-        s[i] = aux / (double)(2 * (d_n - i - 1) + 1);
+/**
+ * \brief Exponential moving average with a span of d_right_points points.
+ *
+ * The smoothing factor is 2/(points + 1), which gives the points the same mean age as in a
+ * moving window average over the span. The data is smoothed forwards and then backwards, so that
+ * the result doesn't lag behind the input.
+ */
+void SmoothFilter::smoothExponential(double *, double *y)
+{
+    const double alpha = 2.0 / (std::max(d_right_points, 1) + 1);
+    for (unsigned i = 1; i < d_n && !isCancelled(); i++) {
+        y[i] = y[i - 1] + alpha * (y[i] - y[i - 1]);
+        if (i % 65536 == 0)
+            setProgress(0.5 * i / d_n);
+    }
+    for (unsigned i = d_n - 1; i-- > 0 && !isCancelled();) {
+        y[i] = y[i + 1] + alpha * (y[i] - y[i + 1]);
+        if (i % 65536 == 0)
+            setProgress(1.0 - 0.5 * i / d_n);
     }
-    s[d_n - 1] = y[d_n - 1];
+}
 
-    for (unsigned i = 0; i < d_n; i++)
-        y[i] = s[i];
+namespace {
+//! Coefficients of one Savitzky-Golay smoothing window
+struct SavitzkyGolayKernel
+{
+    int left_points, right_points, polynom_order;
+    std::vector<double> coefficients;
+};
 
-    delete[] s;
-}
+//! Number of window shapes whose coefficients are kept
+const size_t cached_kernels = 8;
+std::mutex kernel_mutex;
+//! Most recently used coefficients first
+std::list<SavitzkyGolayKernel> kernels;
+} // namespace
 
 /**
- * \brief Compute Savitzky-Golay coefficients and store them into #h.
+ * \brief Compute the Savitzky-Golay coefficients of the point at the center of the window.
  *
- * This function follows GSL conventions in that it writes its result into a matrix allocated by
- * the caller and returns a non-zero result on error.
+ * This function follows GSL conventions in that it returns a non-zero result on error.
  *
  * The coefficient matrix is defined as the matrix H mapping a set of input values to the values
  * of the polynomial of order #polynom_order which minimizes squared deviations from the input
- * values. It is computed using the formula \$H=V(V^TV)^(-1)V^T\$, where \$V\$ is the Vandermonde
- * matrix of the point indices.
+ * values, i.e. \$H=V(V^TV)^(-1)V^T\$, where \$V\$ is the Vandermonde matrix of the point
+ * indices. Smoothing uses only the row of H belonging to the smoothed point (the one with
+ * #left_points points to its left). Since H is symmetric, this row is the least-squares fit to
+ * a unit vector, which a QR decomposition of V yields without ever forming H.
+ *
+ * The coefficients of the last few window shapes are cached.
  *
  * For a short description of the mathematical background, see
  * http://www.statistics4u.info/fundstat_eng/cc_filter_savgol_math.html
  */
-int SmoothFilter::savitzkyGolayCoefficients(int points, int polynom_order, gsl_matrix *h)
+int SmoothFilter::savitzkyGolayCoefficients(int left_points, int right_points, int polynom_order,
+                                            std::vector<double> &coefficients)
 {
-    int error = 0; // catch GSL error codes
+    std::lock_guard<std::mutex> lock(kernel_mutex);
+    for (auto it = kernels.begin(); it != kernels.end(); ++it)
+        if (it->left_points == left_points && it->right_points == right_points
+            && it->polynom_order == polynom_order) {
+            kernels.splice(kernels.begin(), kernels, it);
+            coefficients = it->coefficients;
+            return 0;
+        }
 
-    // compute Vandermonde matrix
+    int points = left_points + right_points + 1;
+    // H doesn't depend on the origin and scale of the indices, but powers of centered indices
+    // scaled to [-1, 1] keep V well-conditioned for long windows
+    double scale = std::max(1, std::max(left_points, right_points));
     gsl_matrix *vandermonde = gsl_matrix_alloc(points, polynom_order + 1);
     for (int i = 0; i < points; ++i) {
         gsl_matrix_set(vandermonde, i, 0, 1.0);
         for (int j = 1; j <= polynom_order; ++j)
-            gsl_matrix_set(vandermonde, i, j, gsl_matrix_get(vandermonde, i, j - 1) * i);
+            gsl_matrix_set(vandermonde, i, j,
+                           gsl_matrix_get(vandermonde, i, j - 1) * (i - left_points) / scale);
     }
+    gsl_vector *tau = gsl_vector_alloc(polynom_order + 1);
+    gsl_vector *unit = gsl_vector_calloc(points);
+    gsl_vector_set(unit, left_points, 1.0);
+    gsl_vector *poly = gsl_vector_alloc(polynom_order + 1);
+    gsl_vector *residual = gsl_vector_alloc(points);
 
-    // compute V^TV
-    gsl_matrix *vtv = gsl_matrix_alloc(polynom_order + 1, polynom_order + 1);
-    error = gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, vandermonde, vandermonde, 0.0, vtv);
-
+    int error = gsl_linalg_QR_decomp(vandermonde, tau);
+    if (!error)
+        error = gsl_linalg_QR_lssolve(vandermonde, tau, unit, poly, residual);
     if (!error) {
-        // compute (V^TV)^(-1) using LU decomposition
-        gsl_permutation *p = gsl_permutation_alloc(polynom_order + 1);
-        int signum;
-        error = gsl_linalg_LU_decomp(vtv, p, &signum);
-
-        if (!error) {
-            gsl_matrix *vtv_inv = gsl_matrix_alloc(polynom_order + 1, polynom_order + 1);
-            error = gsl_linalg_LU_invert(vtv, p, vtv_inv);
-            if (!error) {
-                // compute (V^TV)^(-1)V^T
-                gsl_matrix *vtv_inv_vt = gsl_matrix_alloc(polynom_order + 1, points);
-                error = gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, vtv_inv, vandermonde, 0.0,
-                                       vtv_inv_vt);
-
-                if (!error) {
-                    // finally, compute H = V(V^TV)^(-1)V^T
-                    error = gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, vandermonde, vtv_inv_vt,
-                                           0.0, h);
-                }
-                gsl_matrix_free(vtv_inv_vt);
-            }
-            gsl_matrix_free(vtv_inv);
-        }
-        gsl_permutation_free(p);
+        // the fit is the unit vector minus the residual
+        coefficients.resize(points);
+        for (int k = 0; k < points; k++)
+            coefficients[k] = gsl_vector_get(unit, k) - gsl_vector_get(residual, k);
+        kernels.push_front({ left_points, right_points, polynom_order, coefficients });
+        if (kernels.size() > cached_kernels)
+            kernels.pop_back();
     }
-    gsl_matrix_free(vtv);
-    gsl_matrix_free(vandermonde);
 
+    gsl_vector_free(residual);
+    gsl_vector_free(poly);
+    gsl_vector_free(unit);
+    gsl_vector_free(tau);
+    gsl_matrix_free(vandermonde);
     return error;
 }
 
@@ -228,7 +362,8 @@ int SmoothFilter::savitzkyGolayCoefficients(int points, int polynom_order, gsl_m
  * When the data is not uniformly distributed, Savitzky-Golay looses its interesting conservation
  * properties. On the other hand, a central point of the algorithm is that for uniform data, the
  * operation can be implemented as a convolution. This is considerably more efficient than a more
- * generic method (see smoothModifiedSavGol()) able to handle non-uniform input data.
+ * generic method (see smoothModifiedSavGol()) able to handle non-uniform input data. Short windows
+ * are convolved directly, long ones through FFTs.
  *
  * There are at least three possible approaches to handling edges of the data vector (cutting them
  * off, zero padding and using the left-/rightmost smoothing polynomial for computing smoothed
@@ -247,82 +382,81 @@ void SmoothFilter::smoothSavGol(double *, double *y_inout)
     int points = d_left_points + d_right_points + 1;
 
     if (points < d_polynom_order + 1) {
-        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                              tr("The polynomial order must be lower than the number of left "
-                                 "points plus the number of right points!"));
+        showError(tr("The polynomial order must be lower than the number of left "
+                     "points plus the number of right points!"));
         return;
     }
 
     if (d_n < unsigned(points)) {
-        QMessageBox::critical(
-                (ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                tr("Tried to smooth over more points (left+right+1=%1) than given as input (%2).")
-                        .arg(points)
-                        .arg(d_n));
+        showError(tr("Tried to smooth over more points (left+right+1=%1) than given as input (%2).")
+                          .arg(points)
+                          .arg(d_n));
         return;
     }
 
-    // Savitzky-Golay coefficient matrix, y' = H y
-    gsl_matrix *h = gsl_matrix_alloc(points, points);
-    if (int error = savitzkyGolayCoefficients(points, d_polynom_order, h)) {
-        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                              tr("Internal error in Savitzky-Golay algorithm.\n")
-                                      + gsl_strerror(error));
-        gsl_matrix_free(h);
+    // Savitzky-Golay coefficients, y'[i] = sum h[k] y[i - d_left_points + k]
+    std::vector<double> h;
+    if (int error = savitzkyGolayCoefficients(d_left_points, d_right_points, d_polynom_order, h)) {
+        showError(tr("Internal error in Savitzky-Golay algorithm.\n") + gsl_strerror(error));
         return;
     }
 
-    // allocate memory for the result (temporary; don't overwrite y_inout while we still read from
-    // it)
-    QVector<double> result(d_n);
-
-    // near left edge: use interpolation of (points) left-most input values
-    // i.e. we deviate from the specified left/right points to use
-    /*
-    for (int i=0; i<d_left_points; i++) {
-            double convolution = 0.0;
-            for (int k=0; k<points; k++)
-                    convolution += gsl_matrix_get(h, i, k) * y_inout[k];
-            result[i] =  convolution;
-    }
-    */
-    // legacy behaviour: handle left edge by zero padding
-    for (int i = 0; i < d_left_points; i++) {
-        double convolution = 0.0;
-        for (int k = d_left_points - i; k < points; k++)
-            convolution += gsl_matrix_get(h, d_left_points, k) * y_inout[i - d_left_points + k];
-        result[i] = convolution;
+    // legacy behaviour: handle edges by zero padding, so the whole result is a convolution
+    const int n = int(d_n);
+    const int left = d_left_points;
+    // see Convolution::convlv() for the choice between direct and FFT convolution
+    if (points < 3 * std::log2(double(n + points))) {
+        // don't overwrite y_inout while we still read from it
+        std::vector<double> result(n);
+        parallelFor(0, n, parallelChunks(n, 65536), [&](int chunk, int begin, int end) {
+            for (int i = begin; i < end && !isCancelled(); i++) {
+                int first = std::max(0, left - i), last = std::min(points - 1, n - 1 - i + left);
+                double convolution = 0.0;
+                for (int k = first; k <= last; k++)
+                    convolution += h[k] * y_inout[i - left + k];
+                result[i] = convolution;
+                // the chunks are equally large, so the first one stands for all of them
+                if (chunk == 0 && (i - begin) % 4096 == 0)
+                    setProgress(double(i - begin) / (end - begin));
+            }
+        });
+        std::copy(result.begin(), result.end(), y_inout);
+        return;
     }
-    // central part: convolve with fixed row of h (as given by number of left points to use)
-    for (unsigned i = d_left_points; i < d_n - d_right_points; i++) {
-        double convolution = 0.0;
-        for (int k = 0; k < points; k++)
-            convolution += gsl_matrix_get(h, d_left_points, k) * y_inout[i - d_left_points + k];
-        result[i] = convolution;
+
+    // zero-pad far enough that the ends of the data don't wrap around onto each other
+    const size_t length = FourierTransform::fastLength(d_n + points - 1);
+    std::vector<double> signal(length), kernel(length);
+    std::copy(y_inout, y_inout + d_n, signal.begin());
+    // the coefficients, reversed around the smoothed point and in wrap around order
+    for (int k = 0; k < points; k++)
+        kernel[(length + left - k) % length] = h[k];
+    if (!FourierTransform::realForward(signal.data(), length)
+        || !FourierTransform::realForward(kernel.data(), length)) {
+        showError(tr("Could not allocate memory, operation aborted!"));
+        return;
     }
-    // near right edge: use interpolation of (points) right-most input values
-    // i.e. we deviate from the specified left/right points to use
-    /*
-    for (int i=d_n-d_right_points; i<d_n; i++) {
-            double convolution = 0.0;
-            for (int k=0; k<points; k++)
-                    convolution += gsl_matrix_get(h, points-d_n+i, k) * y_inout[d_n-points+k];
-            result[i] = convolution;
+    // the transforms can't be interrupted, so cancelling takes effect between them
+    setProgress(2.0 / 3);
+    if (isCancelled())
+        return;
+
+    // frequency 0 and (for even lengths) the Nyquist frequency have no imaginary part
+    signal[0] *= kernel[0];
+    if (length % 2 == 0)
+        signal[length / 2] *= kernel[length / 2];
+    for (size_t i = 1; i < (length + 1) / 2; i++) {
+        size_t ni = length - i;
+        double re = signal[i] * kernel[i] - signal[ni] * kernel[ni];
+        double im = signal[i] * kernel[ni] + signal[ni] * kernel[i];
+        signal[i] = re;
+        signal[ni] = im;
     }
-    */
-    // legacy behaviour: handle right edge by zero padding
-    for (unsigned i = d_n - d_right_points; i < d_n; i++) {
-        double convolution = 0.0;
-        for (unsigned k = 0; i - d_left_points + k < d_n; k++)
-            convolution += gsl_matrix_get(h, d_left_points, k) * y_inout[i - d_left_points + k];
-        result[i] = convolution;
+    if (!FourierTransform::halfcomplexInverse(signal.data(), length)) {
+        showError(tr("Could not allocate memory, operation aborted!"));
+        return;
     }
-
-    // deallocate memory
-    gsl_matrix_free(h);
-
-    // write result into *y_inout
-    std::copy(result.begin(), result.end(), y_inout);
+    std::copy(signal.begin(), signal.begin() + d_n, y_inout);
 }
 
 /**
@@ -330,7 +464,8 @@ void SmoothFilter::smoothSavGol(double *, double *y_inout)
  *
  * In comparison to smoothSavGol(), this method trades proper handling of the X coordinates for
  * runtime efficiency by abandoning a central idea of Savitzky-Golay algorithm, namely that
- * polynomial smoothing can be expressed as a convolution.
+ * polynomial smoothing can be expressed as a convolution. The least-squares problems of the
+ * individual windows are independent, so they are solved on all cores.
  *
  * TODO: integrate this option into the GUI.
  */
@@ -340,70 +475,80 @@ void SmoothFilter::smoothModifiedSavGol(double *x_in, double *y_inout)
     int points = d_left_points + d_right_points + 1;
 
     if (points < d_polynom_order + 1) {
-        QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                              tr("The polynomial order must be lower than the number of left "
-                                 "points plus the number of right points!"));
+        showError(tr("The polynomial order must be lower than the number of left "
+                     "points plus the number of right points!"));
         return;
     }
 
     // allocate memory for the result
-    QVector<double> result(d_n);
-
-    // allocate memory for the linear algegra computations
-    // Vandermonde matrix for x values of points in the current smoothing window
-    gsl_matrix *vandermonde = gsl_matrix_alloc(points, d_polynom_order + 1);
-    // stores part of the QR decomposition of vandermonde
-    gsl_vector *tau = gsl_vector_alloc(qMin(points, d_polynom_order + 1));
-    // coefficients of polynomial approximation computed for each smoothing window
-    gsl_vector *poly = gsl_vector_alloc(d_polynom_order + 1);
-    // residual of the (least-squares) approximation (by-product of GSL's algorithm)
-    gsl_vector *residual = gsl_vector_alloc(points);
+    std::vector<double> result(d_n);
+    // GSL error codes of the first failed decomposition or least-squares solution
+    std::atomic<int> qr_error(0), lssolve_error(0);
+
+    const int n = int(d_n);
+    parallelFor(0, n, parallelChunks(n, 256), [&](int, int begin, int end) {
+        // allocate memory for the linear algegra computations
+        // Vandermonde matrix for x values of points in the current smoothing window
+        gsl_matrix *vandermonde = gsl_matrix_alloc(points, d_polynom_order + 1);
+        // stores part of the QR decomposition of vandermonde
+        gsl_vector *tau = gsl_vector_alloc(qMin(points, d_polynom_order + 1));
+        // coefficients of polynomial approximation computed for each smoothing window
+        gsl_vector *poly = gsl_vector_alloc(d_polynom_order + 1);
+        // residual of the (least-squares) approximation (by-product of GSL's algorithm)
+        gsl_vector *residual = gsl_vector_alloc(points);
+
+        for (int target_index = begin;
+             target_index < end && !qr_error && !lssolve_error && !isCancelled(); target_index++) {
+            int offset = target_index - d_left_points;
+            // use a fixed number of points; near left/right borders, use offset to change
+            // effective number of left/right points considered
+            if (target_index < d_left_points)
+                offset += d_left_points - target_index;
+            else if (target_index + d_right_points >= n)
+                offset += n - 1 - (target_index + d_right_points);
+
+            // fill Vandermonde matrix
+            for (int i = 0; i < points; ++i) {
+                gsl_matrix_set(vandermonde, i, 0, 1.0);
+                for (int j = 1; j <= d_polynom_order; ++j)
+                    gsl_matrix_set(vandermonde, i, j,
+                                   gsl_matrix_get(vandermonde, i, j - 1) * x_in[offset + i]);
+            }
 
-    for (unsigned target_index = 0; target_index < d_n; target_index++) {
-        int offset = target_index - d_left_points;
-        // use a fixed number of points; near left/right borders, use offset to change
-        // effective number of left/right points considered
-        if (target_index < unsigned(d_left_points))
-            offset += d_left_points - target_index;
-        else if (unsigned(target_index + d_right_points) >= d_n)
-            offset += d_n - 1 - (target_index + d_right_points);
-
-        // fill Vandermonde matrix
-        for (int i = 0; i < points; ++i) {
-            gsl_matrix_set(vandermonde, i, 0, 1.0);
-            for (int j = 1; j <= d_polynom_order; ++j)
-                gsl_matrix_set(vandermonde, i, j,
-                               gsl_matrix_get(vandermonde, i, j - 1) * x_in[offset + i]);
+            // Y values within current smoothing window
+            gsl_vector_view y_slice = gsl_vector_view_array(y_inout + offset, points);
+
+            // compute QR decomposition of Vandermonde matrix
+            if (int error = gsl_linalg_QR_decomp(vandermonde, tau))
+                qr_error = error;
+            // least-squares-solve vandermonde*poly=y_slice using the QR decomposition now stored
+            // in vandermonde and tau
+            else if (int error = gsl_linalg_QR_lssolve(vandermonde, tau, &y_slice.vector, poly,
+                                                       residual))
+                lssolve_error = error;
+            else
+                result[target_index] =
+                        gsl_poly_eval(poly->data, d_polynom_order + 1, x_in[target_index]);
         }
 
-        // Y values within current smoothing window
-        gsl_vector_view y_slice = gsl_vector_view_array(y_inout + offset, points);
-
-        // compute QR decomposition of Vandermonde matrix
-        if (int error = gsl_linalg_QR_decomp(vandermonde, tau))
-            QMessageBox::critical(
-                    (ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
-                    tr("Internal error in Savitzky-Golay algorithm: QR decomposition failed.\n")
-                            + gsl_strerror(error));
-        // least-squares-solve vandermonde*poly=y_slice using the QR decomposition now stored in
-        // vandermonde and tau
-        else if (int error =
-                         gsl_linalg_QR_lssolve(vandermonde, tau, &y_slice.vector, poly, residual))
-            QMessageBox::critical((ApplicationWindow *)parent(),
-                                  tr("SciDAVis") + " - " + tr("Error"),
-                                  tr("Internal error in Savitzky-Golay algorithm: least-squares "
-                                     "solution failed.\n")
-                                          + gsl_strerror(error));
-        else
-            result[target_index] =
-                    gsl_poly_eval(poly->data, d_polynom_order + 1, x_in[target_index]);
-    }
+        // deallocate memory
+        gsl_vector_free(residual);
+        gsl_vector_free(poly);
+        gsl_vector_free(tau);
+        gsl_matrix_free(vandermonde);
+    });
 
-    // deallocate memory
-    gsl_vector_free(residual);
-    gsl_vector_free(poly);
-    gsl_vector_free(tau);
-    gsl_matrix_free(vandermonde);
+    if (qr_error) {
+        showError(tr("Internal error in Savitzky-Golay algorithm: QR decomposition failed.\n")
+                  + gsl_strerror(qr_error));
+        return;
+    }
+    if (lssolve_error) {
+        showError(tr("Internal error in Savitzky-Golay algorithm: least-squares "
+                     "solution failed.\n")
+                  + gsl_strerror(lssolve_error));
+        return;
+    }
 
     // write result into *y_inout
     std::copy(result.begin(), result.end(), y_inout);
@@ -30,7 +30,8 @@
 #define SMOOTHFILTER_H
 
 #include "Filter.h"
-#include <gsl/gsl_matrix_double.h>
+
+#include <vector>
 
 class SmoothFilter : public Filter
 {
@@ -41,7 +42,7 @@ public:
     SmoothFilter(ApplicationWindow *parent, Graph *g, const QString &curveTitle, double start,
                  double end, int m = 3);
 
-    enum SmoothMethod { SavitzkyGolay = 1, FFT = 2, Average = 3 };
+    enum SmoothMethod { SavitzkyGolay = 1, FFT = 2, Average = 3, Median = 4, Exponential = 5 };
 
     int method() { return (int)d_method; };
     void setMethod(int m);
@@ -56,9 +57,12 @@ private:
     void calculateOutputData(double *x, double *y);
     void smoothFFT(double *x, double *y);
     void smoothAverage(double *x, double *y);
+    void smoothMedian(double *x, double *y);
+    void smoothExponential(double *x, double *y);
     void smoothSavGol(double *x, double *y);
     void smoothModifiedSavGol(double *x, double *y);
-    static int savitzkyGolayCoefficients(int points, int polynom_order, gsl_matrix *h);
+    static int savitzkyGolayCoefficients(int left_points, int right_points, int polynom_order,
+                                         std::vector<double> &coefficients);
 
     //! The smooth method.
     SmoothMethod d_method;
@@ -29,14 +29,18 @@
  *                                                                         *
  ***************************************************************************/
 #include "Table.h"
+#include "ApplicationWindow.h"
 #include "core/column/Column.h"
 #include "lib/Interval.h"
 #include "table/TableModel.h"
 #include "core/datatypes/Double2StringFilter.h"
-#include "core/datatypes/String2DoubleFilter.h"
 #include "core/datatypes/DateTime2StringFilter.h"
 #include "table/AsciiTableImportFilter.h"
 #include "ScriptEdit.h"
+#include "lib/ParallelFor.h"
+#ifdef SCRIPTING_MUPARSER
+#include "MuParserScript.h"
+#endif
 
 #include <QMessageBox>
 #include <QDateTime>
@@ -56,6 +60,7 @@
 #include <QTemporaryFile>
 #include <vector>
 #include <iostream>
+#include <atomic>
 using namespace std;
 
 Table::Table(ScriptingEnv *env, const QString &fname, const QString &sep, int ignoredLines,
@@ -94,6 +99,8 @@ Table::Table(ScriptingEnv *env, int r, int c, const QString &label, QWidget *par
     init();
 }
 
+Table::~Table() { }
+
 void Table::init()
 {
     if (d_future_table) {
@@ -444,51 +451,100 @@ bool Table::recalculate(int col, bool only_selected_rows)
         if (formula.isEmpty())
             continue;
 
-        Script *colscript = scriptEnv->newScript(formula, this, QString("<%1>").arg(colName(col)));
-        connect(colscript, SIGNAL(error(const QString &, const QString &, int)), scriptEnv,
-                SIGNAL(error(const QString &, const QString &, int)));
-        connect(colscript, SIGNAL(print(const QString &)), scriptEnv,
-                SIGNAL(print(const QString &)));
-
-        if (!colscript->compile()) {
-            delete colscript;
+        FirstScriptError first_error;
+        auto newColumnScript = [&]() -> Script * {
+            Script *script =
+                    scriptEnv->newScript(formula, this, QString("<%1>").arg(colName(col)));
+            first_error.watch(script);
+            connect(script, SIGNAL(print(const QString &)), scriptEnv,
+                    SIGNAL(print(const QString &)));
+            if (!script->compile()) {
+                delete script;
+                return nullptr;
+            }
+            script->setInt(col + 1, "j");
+            return script;
+        };
+        QList<Script *> scripts;
+        if (Script *colscript = newColumnScript())
+            scripts << colscript;
+        else {
+            first_error.report(scriptEnv);
             QApplication::restoreOverrideCursor();
             return false;
         }
-
-        colscript->setInt(col + 1, "j");
-        QVariant ret;
         int start_row = interval.start();
         int end_row = interval.end();
+
+        // Formulas referring to whole columns only are evaluated for all rows in a single pass.
+        // Rows the vector evaluation can't handle (or all of them, if the formula uses row-dependent
+        // functions or the scripting language doesn't support it) are evaluated one by one.
+        QVector<qreal> values(end_row - start_row + 1);
+        QList<int> scalar_rows;
+        int chunks = 1;
+#ifdef SCRIPTING_MUPARSER
+        MuParserScript *vector_script = qobject_cast<MuParserScript *>(scripts.first());
+        // worker threads must not trigger reading postponed table data
+        if (vector_script)
+            vector_script->loadReferencedTables();
+        if (!vector_script || !vector_script->evalVector(start_row, values, scalar_rows))
+#endif
+            for (int i = start_row; i <= end_row; i++)
+                scalar_rows << i;
+#ifdef SCRIPTING_MUPARSER
+        // MuParserScript instances can run concurrently, so split the remaining rows among
+        // several of them, unless the formula carries variables from one row to the next.
+        // Scripts are QObjects belonging to this table, so create them here.
+        if (vector_script && vector_script->isRowIndependent({ "i" }))
+            chunks = parallelChunks(scalar_rows.size(), 1000);
+        while (scripts.size() < chunks) {
+            Script *script = newColumnScript();
+            if (!script)
+                break;
+            scripts << script;
+        }
+        chunks = scripts.size();
+#endif
+
+        QVector<QVariant> scalar_results(scalar_rows.size());
+        QVariant *scalar_result = scalar_results.data();
+        std::atomic<bool> failed(false);
+        parallelFor(0, scalar_rows.size(), chunks, [&](int chunk, int begin, int end) {
+            Script *script = scripts.at(chunk);
+            for (int k = begin; k < end && !failed; k++) {
+                script->setInt(scalar_rows.at(k) + 1, "i");
+                scalar_result[k] = script->eval();
+                if (!scalar_result[k].isValid())
+                    failed = true;
+            }
+        });
+        qDeleteAll(scripts);
+        first_error.report(scriptEnv);
+        if (failed) {
+            QApplication::restoreOverrideCursor();
+            return false;
+        }
+
         switch (col_ptr->columnMode()) {
         case SciDAVis::ColumnMode::Numeric: {
-            QVector<qreal> results(end_row - start_row + 1);
-            for (int i = start_row; i <= end_row; i++) {
-                colscript->setInt(i + 1, "i");
-                ret = colscript->eval();
-                if (!ret.isValid()) {
-                    delete colscript;
-                    QApplication::restoreOverrideCursor();
-                    return false;
-                }
+            for (int k = 0; k < scalar_rows.size(); k++) {
+                const QVariant &ret = scalar_results.at(k);
                 if (ret.canConvert(QVariant::Double))
-                    results[i - start_row] = ret.toDouble();
+                    values[scalar_rows.at(k) - start_row] = ret.toDouble();
                 else
-                    results[i - start_row] = NAN;
+                    values[scalar_rows.at(k) - start_row] = NAN;
             }
-            col_ptr->replaceValues(start_row, results);
+            col_ptr->replaceValues(start_row, values);
             break;
         }
         default: {
             QStringList results;
-            for (int i = start_row; i <= end_row; i++) {
-                colscript->setInt(i + 1, "i");
-                ret = colscript->eval();
-                if (!ret.isValid()) {
-                    delete colscript;
-                    QApplication::restoreOverrideCursor();
-                    return false;
+            for (int i = start_row, k = 0; i <= end_row; i++) {
+                if (k == scalar_rows.size() || scalar_rows.at(k) != i) {
+                    results << QLocale().toString(values.at(i - start_row), 'g', 14);
+                    continue;
                 }
+                const QVariant &ret = scalar_results.at(k++);
                 if (ret.type() == QVariant::Double)
                     results << QLocale().toString(ret.toDouble(), 'g', 14);
                 else if (ret.canConvert(QVariant::String))
@@ -500,7 +556,6 @@ bool Table::recalculate(int col, bool only_selected_rows)
             break;
         }
         }
-        delete colscript;
     }
     QApplication::restoreOverrideCursor();
     return true;
@@ -545,48 +600,85 @@ QString Table::saveToString(const QString &geometry)
     return s;
 }
 
-void Table::saveToDevice(QIODevice *device, const QString &geometry)
+//! XML written by future::Table::save(), along with what it depends on
+struct Table::SerializedXml
 {
-    QTextStream stream(device);
-    stream.setCodec(QTextCodec::codecForName("UTF-8"));
-
-    // write start tag
-    stream << "<table>\n";
-    stream.flush();
+    SerializedXml(const future::Table *table, bool binary_data);
+    //! Take XML which has already been written, e.g. AbstractPart::pendingData()
+    explicit SerializedXml(const QString &xml) : tmp_string(xml), xml_chars(xml.length()) { }
+    //! Write the complete <table> element to \c device
+    void write(QIODevice *device, const QString &geometry);
+    //! Whether the XML is in a file and still describes \c table
+    bool isValidFor(const future::Table *table, bool binary_data) const;
 
     // On Windows, writing to a QString has been observed to crash for large tables
     // (apparently due to excessive memory usage).
     // => use temporary file if possible
     QTemporaryFile tmp_file;
     QString tmp_string;
-    if (d_future_table) {
+    //! Whether the XML went to tmp_file, which is closed between saves to spare file handles
+    bool in_file = false;
+    //! Number of characters of the XML; this is needed in case there are newlines in it
+    int xml_chars = 0;
+    bool binary_data = false;
+    quint64 revision = 0;
+    QList<int> column_widths;
+};
+
+Table::SerializedXml::SerializedXml(const future::Table *table, bool binary_data)
+    : binary_data(binary_data)
+{
+    if (table) {
+        revision = table->revision();
+        for (int i = 0; i < table->columnCount(); i++)
+            column_widths << table->columnWidth(i);
         QXmlStreamWriter xml(&tmp_string);
-        if (tmp_file.open())
+        in_file = tmp_file.open();
+        if (in_file)
             xml.setDevice(&tmp_file);
-        d_future_table->save(&xml);
+        table->save(&xml, binary_data);
     }
 
-    // write number of characters of QXmlStreamWriter's output
-    // this is needed in case there are newlines in the XML
-    int xml_chars = 0;
-    if (tmp_file.isOpen()) {
+    if (in_file) {
         tmp_file.seek(0);
         QTextStream count(&tmp_file);
         count.setCodec(QTextCodec::codecForName("UTF-8"));
         while (!count.atEnd())
-            xml_chars += count.read(1024).length();
+            xml_chars += count.read(65536).length();
+        tmp_file.close();
     } else
         xml_chars = tmp_string.length();
+}
+
+bool Table::SerializedXml::isValidFor(const future::Table *table, bool binary_data) const
+{
+    // temporary files may get cleaned up behind our back during long sessions
+    if (!table || !in_file || !tmp_file.exists() || binary_data != this->binary_data
+        || table->revision() != revision || table->columnCount() != column_widths.size())
+        return false;
+    for (int i = 0; i < column_widths.size(); i++)
+        if (table->columnWidth(i) != column_widths.at(i))
+            return false;
+    return true;
+}
+
+void Table::SerializedXml::write(QIODevice *device, const QString &geometry)
+{
+    QTextStream stream(device);
+    stream.setCodec(QTextCodec::codecForName("UTF-8"));
+
+    // write start tag and number of characters of QXmlStreamWriter's output
+    stream << "<table>\n";
     stream << xml_chars << "\n";
     stream.flush();
 
     // Copy QXmlStreamWriter's output to device
-    if (tmp_file.isOpen()) {
-        tmp_file.seek(0);
+    if (in_file && tmp_file.open()) {
         qint64 bytes_read;
-        char buffer[1024];
-        while ((bytes_read = tmp_file.read(buffer, 1024)) > 0)
+        char buffer[65536];
+        while ((bytes_read = tmp_file.read(buffer, sizeof(buffer))) > 0)
             device->write(buffer, bytes_read);
+        tmp_file.close();
     } else
         stream << tmp_string;
     stream << "\n";
@@ -596,6 +688,24 @@ void Table::saveToDevice(QIODevice *device, const QString &geometry)
     stream << "</table>\n";
 }
 
+void Table::saveToDevice(QIODevice *device, const QString &geometry, bool binary_data)
+{
+    // only tables changed since the last save need to be serialized again
+    if (!d_saved_xml || !d_saved_xml->isValidFor(d_future_table, binary_data))
+        d_saved_xml.reset(new SerializedXml(d_future_table, binary_data));
+    d_saved_xml->write(device, geometry);
+}
+
+void Table::saveToDevice(const future::Table *table, QIODevice *device, const QString &geometry,
+                         bool binary_data)
+{
+    // parsing postponed XML would create undo commands, which only the GUI thread may do
+    if (table->hasPendingData())
+        SerializedXml(QString::fromUtf8(table->pendingData())).write(device, geometry);
+    else
+        SerializedXml(table, binary_data).write(device, geometry);
+}
+
 QString Table::saveHeader()
 {
     // TODO: obsolete, remove for 0.3.0, only needed for template saving
@@ -864,21 +974,25 @@ void Table::removeCol(const QStringList &list)
 
 int Table::numRows()
 {
+    loadPendingData();
     return d_future_table ? d_future_table->rowCount() : 0;
 }
 
 int Table::numCols()
 {
+    loadPendingData();
     return d_future_table ? d_future_table->columnCount() : 0;
 }
 
 int Table::rowCount()
 {
+    loadPendingData();
     return d_future_table ? d_future_table->rowCount() : 0;
 }
 
 int Table::columnCount()
 {
+    loadPendingData();
     return d_future_table ? d_future_table->columnCount() : 0;
 }
 
@@ -1217,6 +1331,7 @@ void Table::clear()
 QStringList Table::colNames()
 {
     QStringList list;
+    loadPendingData();
     if (d_future_table)
         for (int i = 0; i < d_future_table->columnCount(); i++)
             list << column(i)->name();
@@ -1403,30 +1518,34 @@ void Table::importASCII(const QString &fname, const QString &sep, int ignoredLin
     filter.set_first_row_names_columns(renameCols);
     filter.set_trim_whitespace(stripSpaces);
     filter.set_simplify_whitespace(simplifySpaces);
+    filter.set_detect_column_types(true);
 
     QFile file(fname);
     if (file.open(QIODevice::ReadOnly)) {
         future::Table *temp = static_cast<future::Table *>(filter.importAspect(file));
         if (!temp)
             return;
+        d_future_table->beginMacro(tr("%1: import %2").arg(name()).arg(fname));
         int preexisting_cols = columnCount();
         int overwritten_cols = qMin(temp->columnCount(), preexisting_cols);
         for (int i = 0; i < overwritten_cols; i++) {
-            column(i)->asStringColumn()->copy(temp->column(i));
+            Column *src = temp->column(i);
+            if (column(i)->columnMode() == src->columnMode())
+                column(i)->copy(src);
+            else
+                column(i)->asStringColumn()->copy(src->asStringColumn());
             if (renameCols)
-                column(i)->setName(temp->column(i)->name());
+                column(i)->setName(src->name());
         }
         for (int i = overwritten_cols; i < preexisting_cols; i++)
             column(overwritten_cols)->remove();
-        String2DoubleFilter *filter = new String2DoubleFilter;
+        // the remaining columns already have the right type, so their data can be shared
         for (int i = overwritten_cols; i < temp->columnCount(); i++) {
-            filter->input(0, temp->column(i));
-            Column *new_col = new Column(temp->column(i)->name(), SciDAVis::ColumnMode::Numeric);
+            Column *new_col = temp->column(i)->snapshot();
             new_col->setPlotDesignation(SciDAVis::Y);
-            new_col->copy(filter->output(0));
             d_future_table->addChild(new_col);
         }
-        delete filter;
+        d_future_table->endMacro();
         delete temp;
         setWindowLabel(fname);
     }
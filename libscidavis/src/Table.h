@@ -37,6 +37,8 @@
 #include <QMap>
 #include <QPointer>
 
+#include <memory>
+
 #include "Graph.h"
 #include "MyWidget.h"
 #include "ScriptingEnv.h"
@@ -70,6 +72,7 @@ public:
           Qt::WindowFlags f = Qt::Widget);
     Table(ScriptingEnv *env, int r, int c, const QString &label, QWidget *parent = 0,
           const char *name = 0, Qt::WindowFlags f = Qt::Widget);
+    ~Table();
 
     //! Sets the number of significant digits
     void setNumericPrecision(int prec);
@@ -119,6 +122,11 @@ public:
     }
 
     void closeEvent(QCloseEvent *);
+    virtual void loadPendingData()
+    {
+        if (d_future_table)
+            d_future_table->loadPendingData();
+    }
 public slots:
     void copy(Table *m);
     int numRows();
@@ -137,7 +145,10 @@ public slots:
     //! Return column number 'index'
     Column *column(int index) const
     {
-        return d_future_table ? d_future_table->column(index) : nullptr;
+        if (!d_future_table)
+            return nullptr;
+        d_future_table->loadPendingData();
+        return d_future_table->column(index);
     }
     //! Return the column determined by the given name
     /**
@@ -147,7 +158,10 @@ public slots:
      */
     Column *column(const QString &name) const
     {
-        return d_future_table ? d_future_table->column(name) : nullptr;
+        if (!d_future_table)
+            return nullptr;
+        d_future_table->loadPendingData();
+        return d_future_table->column(name);
     }
 
     //! Return the value of the cell as a double
@@ -261,7 +275,19 @@ public slots:
     //! \name Saving and Restoring
     //@{
     virtual QString saveToString(const QString &geometry);
-    void saveToDevice(QIODevice *device, const QString &geometry);
+    //! Write the table to \c device
+    /**
+     * The XML written is kept in a temporary file, so saving the table again is a plain copy as
+     * long as future::Table::revision() and the column widths stay the same.
+     */
+    void saveToDevice(QIODevice *device, const QString &geometry, bool binary_data);
+    //! Write \c table to \c device in the same format as saveToDevice()
+    /**
+     * This only accesses \c table, so it may run in a background thread on a
+     * future::Table::snapshot().
+     */
+    static void saveToDevice(const future::Table *table, QIODevice *device,
+                             const QString &geometry, bool binary_data);
     QString saveHeader();
     QString saveComments();
     QString saveCommands();
@@ -304,6 +330,9 @@ protected slots:
 
 private:
     QHash<const AbstractAspect *, QString> d_stored_column_labels;
+    //! Serialized XML of d_future_table, kept across saves while the table doesn't change
+    struct SerializedXml;
+    std::unique_ptr<SerializedXml> d_saved_xml;
 };
 
 #endif
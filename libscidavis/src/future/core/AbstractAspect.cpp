@@ -201,13 +201,33 @@ void AbstractAspect::moveChild(int from, int to)
     exec(new AspectChildMoveCmd(d_aspect_private, from, to));
 }
 
+namespace {
+//! Incremented whenever commands are undone or redone; see AbstractAspect::revision()
+quint64 undo_generation = 0;
+//! Set while exec(), beginMacro() or endMacro() modify an undo stack
+bool modifying_undo_stack = false;
+
+//! Sets modifying_undo_stack for the lifetime of the object
+class UndoStackModification
+{
+public:
+    UndoStackModification() : d_previous(modifying_undo_stack) { modifying_undo_stack = true; }
+    ~UndoStackModification() { modifying_undo_stack = d_previous; }
+
+private:
+    bool d_previous;
+};
+} // namespace
+
 void AbstractAspect::exec(QUndoCommand *cmd)
 {
     Q_CHECK_PTR(cmd);
+    countModification();
     QUndoStack *stack = undoStack();
-    if (stack)
+    if (stack) {
+        UndoStackModification modification;
         stack->push(cmd);
-    else {
+    } else {
         cmd->redo();
         delete cmd;
     }
@@ -216,15 +236,37 @@ void AbstractAspect::exec(QUndoCommand *cmd)
 void AbstractAspect::beginMacro(const QString &text)
 {
     QUndoStack *stack = undoStack();
-    if (stack)
+    if (stack) {
+        UndoStackModification modification;
         stack->beginMacro(text);
+    }
 }
 
 void AbstractAspect::endMacro()
 {
     QUndoStack *stack = undoStack();
-    if (stack)
+    if (stack) {
+        UndoStackModification modification;
         stack->endMacro();
+    }
+}
+
+void AbstractAspect::countModification()
+{
+    for (AbstractAspect *aspect = this; aspect; aspect = aspect->parentAspect())
+        aspect->d_aspect_private->touch();
+}
+
+quint64 AbstractAspect::revision() const
+{
+    return d_aspect_private->revision() + undo_generation;
+}
+
+void AbstractAspect::handleUndoStackIndexChange(const QUndoStack *stack)
+{
+    // clearing the stack changes its index as well, but doesn't modify anything
+    if (!modifying_undo_stack && stack->count() > 0)
+        undo_generation++;
 }
 
 QString AbstractAspect::name() const
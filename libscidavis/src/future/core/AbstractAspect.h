@@ -196,6 +196,15 @@ public:
     void beginMacro(const QString &text);
     //! End the undo stack macro
     void endMacro();
+    //! Return a number which changes whenever this Aspect or one of its descendants is modified
+    /**
+     * Modifications are counted when commands are handed to exec(). Commands undone or redone
+     * by the undo stack can't be attributed to a particular Aspect, so they change the revision
+     * of all Aspects. This allows caching data derived from an Aspect, like its serialization.
+     */
+    quint64 revision() const;
+    //! To be connected to QUndoStack::indexChanged() by the owner of \c stack
+    static void handleUndoStackIndexChange(const QUndoStack *stack);
     //@}
 
     //! Retrieve a global setting.
@@ -300,6 +309,12 @@ protected:
      * is loaded from a file.
      */
     void setCreationTime(const QDateTime &time);
+    //! Change revision() of this Aspect and its ancestors
+    /**
+     * This is done by exec(); it only needs to be called for modifications which bypass the
+     * undo stack.
+     */
+    void countModification();
     //! Called after a new child has been inserted or added.
     /**
      * Unlike the aspectAdded() signals, this method does not get called inside undo/redo actions;
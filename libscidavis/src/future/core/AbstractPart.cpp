@@ -29,6 +29,9 @@
 
 #include "AbstractPart.h"
 #include "PartMdiView.h"
+#include "lib/XmlStreamReader.h"
+#include <QIODevice>
+#include <QBuffer>
 #include <QMenu>
 #include <QStyle>
 
@@ -61,3 +64,91 @@ QMenu *AbstractPart::createContextMenu() const
 
     return menu;
 }
+
+bool AbstractPart::setPendingData(std::shared_ptr<QIODevice> source, qint64 offset, qint64 size)
+{
+    // name, caption and comment come first, so a small piece of the XML is enough
+    if (!source || !source->seek(offset))
+        return false;
+    XmlStreamReader reader(source->read(qMin(size, qint64(65536))));
+    while (!reader.atEnd() && !reader.isStartElement())
+        reader.readNext();
+    if (!reader.isStartElement() || !readBasicAttributes(&reader))
+        return false;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            if (reader.name() == "comment")
+                readCommentElement(&reader);
+            break;
+        }
+    }
+    if (reader.hasError())
+        return false;
+
+    d_pending_source = source;
+    d_pending_offset = offset;
+    d_pending_size = size;
+    d_pending_name = name();
+    d_pending_caption_spec = captionSpec();
+    d_pending_comment = comment();
+    return true;
+}
+
+void AbstractPart::copyPendingData(AbstractPart *other) const
+{
+    if (!d_pending_source || !d_pending_source->seek(d_pending_offset))
+        return;
+    auto buffer = std::make_shared<QBuffer>();
+    buffer->setData(d_pending_source->read(d_pending_size));
+    buffer->open(QIODevice::ReadOnly);
+    other->d_pending_source = buffer;
+    other->d_pending_offset = 0;
+    other->d_pending_size = d_pending_size;
+    other->d_pending_name = d_pending_name;
+    other->d_pending_caption_spec = d_pending_caption_spec;
+    other->d_pending_comment = d_pending_comment;
+}
+
+QByteArray AbstractPart::pendingData() const
+{
+    if (!d_pending_source || !d_pending_source->seek(d_pending_offset))
+        return QByteArray();
+    return d_pending_source->read(d_pending_size);
+}
+
+bool AbstractPart::pendingDataIsCurrent() const
+{
+    return name() == d_pending_name && captionSpec() == d_pending_caption_spec
+            && comment() == d_pending_comment;
+}
+
+void AbstractPart::loadPendingData()
+{
+    if (!d_pending_source)
+        return;
+    // forget about the pending data first, so that this isn't entered again while loading
+    std::shared_ptr<QIODevice> source;
+    source.swap(d_pending_source);
+
+    QByteArray xml;
+    if (source->seek(d_pending_offset))
+        xml = source->read(d_pending_size);
+    XmlStreamReader reader(xml);
+    while (!reader.atEnd() && !reader.isStartElement())
+        reader.readNext();
+
+    QString name = this->name(), comment = this->comment(), caption_spec = captionSpec();
+    d_loading_pending_data = true;
+    bool ok = xml.size() == d_pending_size && load(&reader);
+    setName(name);
+    setComment(comment);
+    setCaptionSpec(caption_spec);
+    d_loading_pending_data = false;
+
+    if (!ok)
+        info(tr("Error reading %1 from the project file: %2").arg(name, reader.errorString()));
+    else if (reader.hasWarnings())
+        info(tr("Problems reading %1 from the project file: %2")
+                     .arg(name, reader.warningStrings().join("; ")));
+}
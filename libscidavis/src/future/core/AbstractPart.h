@@ -31,7 +31,10 @@
 
 #include "AbstractAspect.h"
 
+#include <memory>
+
 class PartMdiView;
+class QIODevice;
 class QMenu;
 class QToolBar;
 
@@ -46,7 +49,14 @@ class AbstractPart : public AbstractAspect
 
 public:
     //! Constructor.
-    AbstractPart(const QString &name) : AbstractAspect(name), d_mdi_window(0) { }
+    AbstractPart(const QString &name)
+        : AbstractAspect(name),
+          d_mdi_window(0),
+          d_pending_offset(0),
+          d_pending_size(0),
+          d_loading_pending_data(false)
+    {
+    }
     //! Construct a primary view on me.
     /**
      * The caller recieves ownership of the view.
@@ -82,6 +92,45 @@ public:
         return false;
     }
 
+    //! \name deferred loading
+    //@{
+    //! Postpone reading my content from the \c size bytes of XML at \c offset in \c source
+    /**
+     * Only the name, caption and comment are read right away; everything else is read by
+     * load() on the first call of loadPendingData(). This allows opening large projects without
+     * parsing the data of parts which are never looked at.
+     *
+     * Returns false (leaving the content to the caller) if not even the name could be read.
+     */
+    bool setPendingData(std::shared_ptr<QIODevice> source, qint64 offset, qint64 size);
+    //! Return whether some content is still waiting to be read by loadPendingData()
+    bool hasPendingData() const { return bool(d_pending_source); }
+    //! Read the content postponed by setPendingData(), if any
+    /**
+     * This is not an undoable change. Name, caption and comment keep their current values.
+     */
+    void loadPendingData();
+    //! Give \c other a copy of the content postponed by setPendingData(), if any
+    /**
+     * The copy is held in memory, so \c other may be handed to another thread without touching the
+     * project file.
+     */
+    void copyPendingData(AbstractPart *other) const;
+    //! Return the XML postponed by setPendingData(), as it was read from the project
+    QByteArray pendingData() const;
+    //! Whether pendingData() still has my current name, caption and comment
+    /**
+     * If so, pendingData() can be saved as is instead of loading and serializing it again.
+     */
+    bool pendingDataIsCurrent() const;
+    //@}
+
+    //! Return no undo stack while loading postponed content, otherwise the Project's
+    virtual QUndoStack *undoStack() const
+    {
+        return d_loading_pending_data ? 0 : AbstractAspect::undoStack();
+    }
+
 public slots:
     //! Copy current selection.
     virtual void copy() {};
@@ -93,6 +142,13 @@ public slots:
 private:
     //! The MDI sub-window that is wrapped around my primary view.
     PartMdiView *d_mdi_window;
+    //! Where to read postponed content from (see setPendingData())
+    std::shared_ptr<QIODevice> d_pending_source;
+    qint64 d_pending_offset;
+    qint64 d_pending_size;
+    //! Name, caption and comment found in the postponed content
+    QString d_pending_name, d_pending_caption_spec, d_pending_comment;
+    bool d_loading_pending_data;
 };
 
 #endif // ifndef ABSTRACT_PART_H
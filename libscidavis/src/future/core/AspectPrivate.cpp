@@ -39,7 +39,8 @@ AbstractAspect::Private::Private(AbstractAspect *owner, const QString &name)
     : d_name(name.isEmpty() ? "1" : name),
       d_caption_spec("%n%C{ - }%c"),
       d_owner(owner),
-      d_parent(0)
+      d_parent(0),
+      d_revision(0)
 {
     d_creation_time = QDateTime::currentDateTime();
 }
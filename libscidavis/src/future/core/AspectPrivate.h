@@ -66,6 +66,9 @@ public:
 
     QString uniqueNameFor(const QString &current_name) const;
 
+    quint64 revision() const { return d_revision; }
+    void touch() { d_revision++; }
+
     static QHash<QString, QVariant> g_defaults;
 
 private:
@@ -75,6 +78,7 @@ private:
     QDateTime d_creation_time;
     AbstractAspect *d_owner;
     AbstractAspect *d_parent;
+    quint64 d_revision;
 };
 
 #endif // ifndef ASPECT_PRIVATE_H
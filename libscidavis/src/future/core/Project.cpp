@@ -83,6 +83,9 @@ Project::Project() : future::Folder(tr("Unnamed")), d(new Private())
     QString engine_name = ScriptingEngineManager::instance()->engineNames()[0];
     d->scripting_engine = ScriptingEngineManager::instance()->engine(engine_name);
 #endif
+    QUndoStack *stack = &d->undo_stack;
+    connect(stack, &QUndoStack::indexChanged, this,
+            [stack]() { AbstractAspect::handleUndoStackIndexChange(stack); });
 }
 
 Project::~Project()
@@ -29,12 +29,17 @@
 
 #include "core/column/Column.h"
 #include "core/column/ColumnPrivate.h"
+#include "core/column/ColumnData.h"
 #include "core/column/columncommands.h"
+#include "lib/BinaryData.h"
 #include "lib/XmlStreamReader.h"
+#include "ApplicationWindow.h"
 #include <QIcon>
 #include <QXmlStreamWriter>
 #include <QtDebug>
 
+#include <algorithm>
+
 Column::Column(const QString &name, SciDAVis::ColumnMode mode) : AbstractColumn(name)
 {
     d_column_private = new Private(this, mode);
@@ -52,19 +57,31 @@ void Column::initPrivate(std::unique_ptr<QVector<qreal>> d, IntervalAttribute<bo
 }
 
 template<>
-void Column::initPrivate(std::unique_ptr<QStringList> d, IntervalAttribute<bool> v)
+void Column::initPrivate(std::unique_ptr<TextColumnData> d, IntervalAttribute<bool> v)
 {
     d_column_private =
             new Private(this, SciDAVis::TypeQString, SciDAVis::ColumnMode::Text, d.release(), v);
 }
 
 template<>
-void Column::initPrivate(std::unique_ptr<QList<QDateTime>> d, IntervalAttribute<bool> v)
+void Column::initPrivate(std::unique_ptr<QStringList> d, IntervalAttribute<bool> v)
+{
+    initPrivate(std::unique_ptr<TextColumnData>(new TextColumnData(*d)), v);
+}
+
+template<>
+void Column::initPrivate(std::unique_ptr<DateTimeColumnData> d, IntervalAttribute<bool> v)
 {
     d_column_private = new Private(this, SciDAVis::TypeQDateTime, SciDAVis::ColumnMode::DateTime,
                                    d.release(), v);
 }
 
+template<>
+void Column::initPrivate(std::unique_ptr<QList<QDateTime>> d, IntervalAttribute<bool> v)
+{
+    initPrivate(std::unique_ptr<DateTimeColumnData>(new DateTimeColumnData(*d)), v);
+}
+
 void Column::init()
 {
     d_string_io = new ColumnStringIO(this);
@@ -104,9 +121,11 @@ void Column::setColumnMode(SciDAVis::ColumnMode mode, AbstractFilter *conversion
     else if ((mode == SciDAVis::ColumnMode::DateTime) && (nullptr != conversion_filter)) {
         auto numeric_datetime_converter =
                 reinterpret_cast<NumericDateTimeBaseFilter *>(conversion_filter);
-        if (nullptr != numeric_datetime_converter)
+        if (nullptr != numeric_datetime_converter) {
             // the ownership of converter is taken
             d_column_private->setNumericDateTimeFilter(numeric_datetime_converter);
+            countModification();
+        }
     }
 }
 
@@ -128,6 +147,31 @@ bool Column::copy(const AbstractColumn *source, int source_start, int dest_start
     return true;
 }
 
+namespace {
+//! Transfer the settings of \c source to \c target, a filter of the same class
+void copyFilterSettings(const AbstractSimpleFilter *source, AbstractSimpleFilter *target)
+{
+    QString xml;
+    QXmlStreamWriter writer(&xml);
+    source->save(&writer);
+    XmlStreamReader reader(xml);
+    if (reader.skipToNextTag())
+        target->load(&reader);
+}
+} // namespace
+
+Column *Column::snapshot() const
+{
+    Column *result = new Column(name(), columnMode());
+    result->d_column_private->share(d_column_private);
+    copyFilterSettings(d_column_private->inputFilter(), result->d_column_private->inputFilter());
+    copyFilterSettings(outputFilter(), result->outputFilter());
+    result->setCreationTime(creationTime());
+    result->setCaptionSpec(captionSpec());
+    result->setComment(comment());
+    return result;
+}
+
 void Column::insertRows(int before, int count)
 {
     if (count > 0)
@@ -283,6 +327,12 @@ QIcon Column::icon() const
 }
 
 void Column::save(QXmlStreamWriter *writer) const
+{
+    auto &settings = ApplicationWindow::getSettings();
+    save(writer, settings.value("/General/BinaryProjectData", false).toBool());
+}
+
+void Column::save(QXmlStreamWriter *writer, bool binary_data) const
 {
     writer->writeStartElement("column");
     writeBasicAttributes(writer);
@@ -315,6 +365,24 @@ void Column::save(QXmlStreamWriter *writer) const
     int i;
     switch (dataType()) {
     case SciDAVis::TypeDouble:
+        if (binary_data) {
+            auto *values = static_cast<QVector<double> *>(d_column_private->dataPointer());
+            writer->writeStartElement("data");
+            writer->writeAttribute("rows", QString::number(rowCount()));
+            writer->writeAttribute("encoding", "base64");
+            writer->writeCharacters(QString::fromLatin1(encodeDoubles(values->constData(),
+                                                                      rowCount())));
+            writer->writeEndElement();
+            if (!invalidIntervals().isEmpty()) {
+                writer->writeStartElement("invalid_rows");
+                writer->writeAttribute("rows", QString::number(rowCount()));
+                writer->writeAttribute("encoding", "base64");
+                writer->writeCharacters(
+                        QString::fromLatin1(encodeBitmap(invalidBitmap(0, rowCount()))));
+                writer->writeEndElement();
+            }
+            break;
+        }
         for (i = 0; i < rowCount(); i++) {
             writer->writeStartElement("row");
             writer->writeAttribute("type",
@@ -424,6 +492,8 @@ bool Column::load(XmlStreamReader *reader)
         clearValidity();
         clearMasks();
         clearFormulas();
+        // the data itself is loaded bypassing the undo stack
+        Builder builder(this);
         // read child elements
         while (!reader->atEnd()) {
             reader->readNext();
@@ -446,7 +516,11 @@ bool Column::load(XmlStreamReader *reader)
                 else if (reader->name() == "formula")
                     ret_val = XmlReadFormula(reader);
                 else if (reader->name() == "row")
-                    ret_val = XmlReadRow(reader);
+                    ret_val = XmlReadRow(reader, builder);
+                else if (reader->name() == "data")
+                    ret_val = XmlReadData(reader, builder);
+                else if (reader->name() == "invalid_rows")
+                    ret_val = XmlReadInvalidRows(reader, builder);
                 else // unknown element
                 {
                     reader->raiseWarning(tr("unknown element '%1'").arg(reader->name().toString()));
@@ -457,6 +531,7 @@ bool Column::load(XmlStreamReader *reader)
                     return false;
             }
         }
+        builder.finish();
     } else // no column element
         reader->raiseError(tr("no column element found"));
 
@@ -538,7 +613,7 @@ bool Column::XmlReadFormula(XmlStreamReader *reader)
     return true;
 }
 
-bool Column::XmlReadRow(XmlStreamReader *reader)
+bool Column::XmlReadRow(XmlStreamReader *reader, Builder &builder)
 {
     Q_ASSERT(reader->isStartElement() && reader->name() == "row");
 
@@ -569,25 +644,193 @@ bool Column::XmlReadRow(XmlStreamReader *reader)
             reader->raiseError(tr("invalid row value"));
             return false;
         }
-        setValueAt(index, value);
+        builder.setValueAt(index, value);
         break;
     }
     case SciDAVis::TypeQString:
-        setTextAt(index, str);
+        builder.setTextAt(index, str);
         break;
 
     case SciDAVis::TypeQDateTime:
         QDateTime date_time = QDateTime::fromString(str, "yyyy-dd-MM hh:mm:ss:zzz");
-        setDateTimeAt(index, date_time);
+        builder.setDateTimeAt(index, date_time);
         break;
     }
 
     str = attribs.value(reader->namespaceUri().toString(), "invalid").toString();
     if (str == "yes")
-        setInvalid(index);
+        builder.setInvalid(index);
+
+    return true;
+}
+
+bool Column::XmlReadData(XmlStreamReader *reader, Builder &builder)
+{
+    Q_ASSERT(reader->isStartElement() && reader->name() == "data");
+
+    if (dataType() != SciDAVis::TypeDouble) {
+        reader->raiseError(tr("binary data in non-numeric column"));
+        return false;
+    }
+    QString encoding = reader->attributes()
+                               .value(reader->namespaceUri().toString(), "encoding")
+                               .toString();
+    bool ok;
+    int rows = reader->readAttributeInt("rows", &ok);
+    if (!ok || rows < 0 || encoding != "base64") {
+        reader->raiseError(tr("invalid or missing row count or encoding"));
+        return false;
+    }
+
+    QVector<double> values;
+    if (!decodeDoubles(reader->readElementText(), rows, values)) {
+        reader->raiseError(tr("invalid binary data"));
+        return false;
+    }
+    builder.setValues(0, values);
 
     return true;
 }
+
+bool Column::XmlReadInvalidRows(XmlStreamReader *reader, Builder &builder)
+{
+    Q_ASSERT(reader->isStartElement() && reader->name() == "invalid_rows");
+
+    QString encoding = reader->attributes()
+                               .value(reader->namespaceUri().toString(), "encoding")
+                               .toString();
+    bool ok;
+    int rows = reader->readAttributeInt("rows", &ok);
+    if (!ok || rows < 0 || encoding != "base64") {
+        reader->raiseError(tr("invalid or missing row count or encoding"));
+        return false;
+    }
+
+    QVector<bool> invalid;
+    if (!decodeBitmap(reader->readElementText(), rows, invalid)) {
+        reader->raiseError(tr("invalid bitmap of invalid rows"));
+        return false;
+    }
+    // set whole runs of rows at once
+    for (int start = 0, row = 1; start < rows; row++) {
+        if (row < rows && invalid.at(row) == invalid.at(start))
+            continue;
+        builder.setInvalid(Interval<int>(start, row - 1), invalid.at(start));
+        start = row;
+    }
+
+    return true;
+}
+
+Column::Builder::Builder(Column *column)
+    : d_column(column),
+      d_data_type(column->dataType()),
+      d_row_count(column->rowCount()),
+      d_finished(false)
+{
+    switch (d_data_type) {
+    case SciDAVis::TypeDouble:
+        d_values.resize(d_row_count);
+        break;
+    case SciDAVis::TypeQString:
+        d_texts.resize(d_row_count);
+        break;
+    case SciDAVis::TypeQDateTime:
+        d_date_times.resize(d_row_count);
+        break;
+    }
+    if (d_row_count > 0)
+        d_validity.setValue(Interval<int>(0, d_row_count - 1), true);
+}
+
+bool Column::Builder::prepareRow(int row)
+{
+    if (row < 0 || d_finished)
+        return false;
+    if (row < d_row_count)
+        return true;
+
+    if (row > d_row_count)
+        d_validity.setValue(Interval<int>(d_row_count, row - 1), true);
+    d_row_count = row + 1;
+    switch (d_data_type) {
+    case SciDAVis::TypeDouble:
+        d_values.resize(d_row_count);
+        break;
+    case SciDAVis::TypeQString:
+        d_texts.resize(d_row_count);
+        break;
+    case SciDAVis::TypeQDateTime:
+        d_date_times.resize(d_row_count);
+        break;
+    }
+    return true;
+}
+
+void Column::Builder::setValueAt(int row, double new_value)
+{
+    if (d_data_type != SciDAVis::TypeDouble || !prepareRow(row))
+        return;
+    d_values[row] = new_value;
+    d_validity.setValue(row, false);
+}
+
+void Column::Builder::setTextAt(int row, const QString &new_value)
+{
+    if (d_data_type != SciDAVis::TypeQString || !prepareRow(row))
+        return;
+    d_texts.replace(row, new_value);
+    d_validity.setValue(row, false);
+}
+
+void Column::Builder::setDateTimeAt(int row, const QDateTime &new_value)
+{
+    if (d_data_type != SciDAVis::TypeQDateTime || !prepareRow(row))
+        return;
+    d_date_times.replace(row, new_value);
+    d_validity.setValue(row, !new_value.isValid());
+}
+
+void Column::Builder::setInvalid(int row, bool invalid)
+{
+    if (!prepareRow(row))
+        return;
+    d_validity.setValue(row, invalid);
+}
+
+void Column::Builder::setValues(int first, const QVector<double> &values)
+{
+    if (d_data_type != SciDAVis::TypeDouble || first < 0 || values.isEmpty()
+        || !prepareRow(first + values.size() - 1))
+        return;
+    std::copy(values.constBegin(), values.constEnd(), d_values.begin() + first);
+    d_validity.setValue(Interval<int>(first, first + values.size() - 1), false);
+}
+
+void Column::Builder::setInvalid(Interval<int> rows, bool invalid)
+{
+    if (rows.start() < 0 || !rows.isValid() || !prepareRow(rows.end()))
+        return;
+    d_validity.setValue(rows, invalid);
+}
+
+void Column::Builder::finish()
+{
+    if (d_finished)
+        return;
+    d_finished = true;
+    switch (d_data_type) {
+    case SciDAVis::TypeDouble:
+        d_column->d_column_private->assignData(d_values, d_validity);
+        break;
+    case SciDAVis::TypeQString:
+        d_column->d_column_private->assignData(d_texts, d_validity);
+        break;
+    case SciDAVis::TypeQDateTime:
+        d_column->d_column_private->assignData(d_date_times, d_validity);
+        break;
+    }
+}
 SciDAVis::ColumnDataType Column::dataType() const
 {
     return d_column_private->dataType();
@@ -632,6 +875,11 @@ bool Column::isInvalid(Interval<int> i) const
     return d_column_private->isInvalid(i);
 }
 
+QVector<bool> Column::invalidBitmap(int first, int count) const
+{
+    return d_column_private->invalidBitmap(first, count);
+}
+
 QList<Interval<int>> Column::invalidIntervals() const
 {
     return d_column_private->invalidIntervals();
@@ -35,6 +35,7 @@
 #include "lib/IntervalAttribute.h"
 #include "lib/XmlStreamReader.h"
 #include "core/datatypes/NumericDateTimeBaseFilter.h"
+#include "core/column/ColumnData.h"
 #include <memory>
 
 class QString;
@@ -62,6 +63,7 @@ class Column : public AbstractColumn
 public:
     class Private;
     friend class Private;
+    class Builder;
     //! Ctor
     /**
      * \param name the column name (= aspect name)
@@ -138,6 +140,13 @@ public:
      */
     bool copy(const AbstractColumn *source, int source_start, int dest_start,
               int num_rows) override;
+    //! Return a new column with the same content, attributes and filter settings
+    /**
+     * The data is implicitly shared with this column until either of them is modified, so this
+     * is cheap even for very long columns. The snapshot has no parent aspect and no undo stack;
+     * it may be read (e.g. saved) from another thread as long as nobody modifies it.
+     */
+    Column *snapshot() const;
     //! Return the data vector size
     /**
      * This returns the number of rows that actually contain data.
@@ -182,6 +191,11 @@ public:
     bool isInvalid(int row) const override;
     //! Return whether a certain interval of rows contains only invalid values
     bool isInvalid(Interval<int> i) const override;
+    //! Return for each of the rows first .. first+count-1 whether it contains an invalid value
+    /**
+     * Use this instead of isInvalid(int) when looking at a whole block of rows.
+     */
+    QVector<bool> invalidBitmap(int first, int count) const;
     //! Return all intervals of invalid rows
     QList<Interval<int>> invalidIntervals() const override;
     //! Return whether a certain row is masked
@@ -307,6 +321,12 @@ public:
     //@{
     //! Save the column as XML
     void save(QXmlStreamWriter *writer) const override;
+    //! Save the column as XML, with numeric data base64-encoded if \c binary_data is true
+    /**
+     * Unlike save(QXmlStreamWriter*), this doesn't consult the settings and can thus be used
+     * from threads other than the GUI thread.
+     */
+    void save(QXmlStreamWriter *writer, bool binary_data) const;
     //! Load the column from XML
     bool load(XmlStreamReader *reader) override;
 
@@ -322,7 +342,11 @@ private:
     //! Read XML formula element
     bool XmlReadFormula(XmlStreamReader *reader);
     //! Read XML row element
-    bool XmlReadRow(XmlStreamReader *reader);
+    bool XmlReadRow(XmlStreamReader *reader, Builder &builder);
+    //! Read XML element with the binary data of a numeric column
+    bool XmlReadData(XmlStreamReader *reader, Builder &builder);
+    //! Read XML element with the bitmap of invalid rows
+    bool XmlReadInvalidRows(XmlStreamReader *reader, Builder &builder);
     //@}
 
 private slots:
@@ -340,6 +364,47 @@ private:
     friend class ColumnStringIO;
 };
 
+//! Fills a column with data without going through the undo stack
+/**
+ * This is meant for loading data into new or freshly cleared columns (from project files, imports
+ * and the like), where undo commands for each cell would only cost time and memory. The builder
+ * starts with as many invalid rows as the column has, collects all data and hands it over to the
+ * column in finish() (or when it is destroyed), emitting a single change notification.
+ *
+ * Rows not set explicitly are invalid, setters not matching the data type of the column are
+ * ignored; don't change the column in any other way until finish() has been called.
+ */
+class Column::Builder
+{
+public:
+    explicit Builder(Column *column);
+    ~Builder() { finish(); }
+
+    void setValueAt(int row, double new_value);
+    void setTextAt(int row, const QString &new_value);
+    void setDateTimeAt(int row, const QDateTime &new_value);
+    void setInvalid(int row, bool invalid = true);
+    //! Set the values of rows \c first to \c first + values.size() - 1 at once
+    void setValues(int first, const QVector<double> &values);
+    void setInvalid(Interval<int> rows, bool invalid = true);
+
+    //! Hand the data over to the column
+    void finish();
+
+private:
+    //! Make sure the data has \c row, marking rows added in between invalid
+    bool prepareRow(int row);
+
+    Column *d_column;
+    SciDAVis::ColumnDataType d_data_type;
+    int d_row_count;
+    QVector<double> d_values;
+    TextColumnData d_texts;
+    DateTimeColumnData d_date_times;
+    IntervalAttribute<bool> d_validity;
+    bool d_finished;
+};
+
 //! String-IO interface of Column.
 class ColumnStringIO : public AbstractColumn
 {
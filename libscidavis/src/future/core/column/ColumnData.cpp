@@ -0,0 +1,238 @@
+/***************************************************************************
+    File                 : ColumnData.cpp
+    Project              : SciDAVis
+    Description          : Compact data storage for text and date/time columns
+    --------------------------------------------------------------------
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "core/column/ColumnData.h"
+
+#include <algorithm>
+#include <limits>
+
+///////////////////////////////////////////////////////////////////////////
+// class TextColumnData
+///////////////////////////////////////////////////////////////////////////
+
+TextColumnData::TextColumnData()
+{
+    d_dictionary << QString();
+}
+
+TextColumnData::TextColumnData(const QStringList &texts) : TextColumnData()
+{
+    d_codes.reserve(texts.size());
+    for (const QString &text : texts)
+        d_codes << code(text);
+}
+
+QStringList TextColumnData::mid(int first, int count) const
+{
+    int end = count < 0 ? size() : std::min(first + count, size());
+    QStringList result;
+    for (int row = std::max(first, 0); row < end; row++)
+        result << at(row);
+    return result;
+}
+
+qint64 TextColumnData::memoryUsage() const
+{
+    qint64 result = qint64(d_codes.size()) * sizeof(int);
+    // the lookup table shares the strings, but adds a hash node per entry
+    for (const QString &text : d_dictionary)
+        result += text.size() * qint64(sizeof(QChar)) + 64;
+    return result;
+}
+
+int TextColumnData::code(const QString &text)
+{
+    if (text.isEmpty())
+        return 0;
+    auto it = d_lookup.constFind(text);
+    if (it != d_lookup.constEnd())
+        return it.value();
+
+    // don't let strings which were replaced in the meantime pile up
+    if (d_dictionary.size() > 1024 && d_dictionary.size() > 2 * d_codes.size())
+        compact();
+    d_lookup.insert(text, d_dictionary.size());
+    d_dictionary << text;
+    return d_dictionary.size() - 1;
+}
+
+void TextColumnData::compact()
+{
+    QVector<int> new_codes(d_dictionary.size(), -1);
+    QVector<QString> dictionary;
+    dictionary << QString();
+    new_codes[0] = 0;
+    d_lookup.clear();
+    for (int &c : d_codes) {
+        if (new_codes.at(c) < 0) {
+            new_codes[c] = dictionary.size();
+            d_lookup.insert(d_dictionary.at(c), dictionary.size());
+            dictionary << d_dictionary.at(c);
+        }
+        c = new_codes.at(c);
+    }
+    d_dictionary = dictionary;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// class DateTimeColumnData
+///////////////////////////////////////////////////////////////////////////
+
+namespace {
+const qint64 msecs_per_day = 86400000;
+//! Julian day of 1970-01-01
+const qint64 epoch_julian_day = 2440588;
+//! Largest number of days from the epoch that can be represented
+const qint64 max_days = std::numeric_limits<qint64>::max() / msecs_per_day - 1;
+} // namespace
+
+const qint64 DateTimeColumnData::invalid = std::numeric_limits<qint64>::min();
+// needed for passing them by reference before C++17
+constexpr qint32 DateTimeColumnData::local_time;
+constexpr qint32 DateTimeColumnData::utc;
+constexpr qint32 DateTimeColumnData::local_wall_clock;
+
+DateTimeColumnData::DateTimeColumnData(const QList<QDateTime> &dateTimes)
+{
+    d_values.resize(dateTimes.size());
+    for (int row = 0; row < dateTimes.size(); row++)
+        replace(row, dateTimes.at(row));
+}
+
+void DateTimeColumnData::replace(int row, const QDateTime &dateTime)
+{
+    qint32 spec;
+    encode(dateTime, d_values[row], spec);
+    if (spec != local_time && d_specs.isEmpty())
+        d_specs.fill(local_time, d_values.size());
+    if (!d_specs.isEmpty())
+        d_specs[row] = spec;
+}
+
+void DateTimeColumnData::resize(int size)
+{
+    int old_size = d_values.size();
+    d_values.resize(size);
+    if (size > old_size)
+        std::fill(d_values.begin() + old_size, d_values.end(), invalid);
+    if (!d_specs.isEmpty())
+        d_specs.resize(size);
+}
+
+void DateTimeColumnData::insert(int row, int count)
+{
+    d_values.insert(row, count, invalid);
+    if (!d_specs.isEmpty())
+        d_specs.insert(row, count, local_time);
+}
+
+void DateTimeColumnData::remove(int first, int count)
+{
+    d_values.remove(first, count);
+    if (!d_specs.isEmpty())
+        d_specs.remove(first, count);
+}
+
+QList<QDateTime> DateTimeColumnData::mid(int first, int count) const
+{
+    int end = count < 0 ? size() : std::min(first + count, size());
+    QList<QDateTime> result;
+    for (int row = std::max(first, 0); row < end; row++)
+        result << at(row);
+    return result;
+}
+
+namespace {
+//! Milliseconds between 1970-01-01 00:00 and \c date / \c time, as read from any clock
+qint64 wallClockMSecs(const QDate &date, const QTime &time)
+{
+    return (date.toJulianDay() - epoch_julian_day) * msecs_per_day
+            + (time.isValid() ? time.msecsSinceStartOfDay() : 0);
+}
+} // namespace
+
+void DateTimeColumnData::encode(const QDateTime &dateTime, qint64 &value, qint32 &spec)
+{
+    spec = local_time;
+    QDate date = dateTime.date();
+    QTime time = dateTime.time();
+    if (!date.isValid()) {
+        value = time.isValid() ? invalid + 1 + time.msecsSinceStartOfDay() : invalid;
+        return;
+    }
+    qint64 days = date.toJulianDay() - epoch_julian_day;
+    if (days > max_days || days < -max_days) {
+        value = invalid;
+        return;
+    }
+
+    if (!dateTime.isValid()) {
+        spec = local_wall_clock;
+        value = wallClockMSecs(date, time);
+        return;
+    }
+    switch (dateTime.timeSpec()) {
+    case Qt::LocalTime:
+        break;
+    case Qt::UTC:
+        spec = utc;
+        break;
+    default:
+        spec = dateTime.offsetFromUtc();
+        if (spec == 0)
+            spec = utc;
+        break;
+    }
+    value = dateTime.toMSecsSinceEpoch();
+    if (value <= invalid + msecs_per_day)
+        value = invalid;
+}
+
+QDateTime DateTimeColumnData::decode(qint64 value, qint32 spec)
+{
+    if (value == invalid)
+        return QDateTime();
+    if (value <= invalid + msecs_per_day)
+        return QDateTime(QDate(), QTime::fromMSecsSinceStartOfDay(int(value - invalid - 1)));
+
+    switch (spec) {
+    case local_time:
+        return QDateTime::fromMSecsSinceEpoch(value, Qt::LocalTime);
+    case utc:
+        return QDateTime::fromMSecsSinceEpoch(value, Qt::UTC);
+    case local_wall_clock:
+        break;
+    default:
+        return QDateTime::fromMSecsSinceEpoch(value, Qt::OffsetFromUTC, spec);
+    }
+    qint64 days = value / msecs_per_day;
+    if (value % msecs_per_day < 0)
+        days--;
+    int msecs = int(value - days * msecs_per_day);
+    return QDateTime(QDate::fromJulianDay(days + epoch_julian_day),
+                     QTime::fromMSecsSinceStartOfDay(msecs));
+}
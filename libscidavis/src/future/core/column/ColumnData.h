@@ -0,0 +1,155 @@
+/***************************************************************************
+    File                 : ColumnData.h
+    Project              : SciDAVis
+    Description          : Compact data storage for text and date/time columns
+    --------------------------------------------------------------------
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef COLUMNDATA_H
+#define COLUMNDATA_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <limits>
+
+//! Data of a text column
+/**
+ * Texts are dictionary-encoded: each distinct string is stored only once, while the rows only hold
+ * an index into the dictionary. Columns with many repeated values (like categories or log levels)
+ * thus need little more than four bytes per row, and resizing the column only touches the index
+ * vector.
+ *
+ * Strings no longer used by any row are dropped from the dictionary once it grows
+ * considerably larger than the column.
+ */
+class TextColumnData
+{
+public:
+    TextColumnData();
+    TextColumnData(const QStringList &texts);
+
+    int size() const { return d_codes.size(); }
+    QString at(int row) const { return d_dictionary.at(d_codes.at(row)); }
+    //! Like at(), but returns an empty string for rows out of range
+    QString value(int row) const
+    {
+        return row >= 0 && row < d_codes.size() ? at(row) : QString();
+    }
+    void replace(int row, const QString &text) { d_codes[row] = code(text); }
+
+    //! Resize to \c size rows, filling new rows with empty strings
+    void resize(int size) { d_codes.resize(size); }
+    //! Insert \c count empty strings before \c row
+    void insert(int row, int count) { d_codes.insert(row, count, 0); }
+    void remove(int first, int count) { d_codes.remove(first, count); }
+
+    QStringList mid(int first, int count) const;
+
+    //! Return a rough estimate of the number of bytes used
+    qint64 memoryUsage() const;
+
+private:
+    //! Return the dictionary index of \c text, adding it if necessary
+    int code(const QString &text);
+    //! Remove strings no longer referenced from the dictionary
+    void compact();
+
+    //! Dictionary index for each row
+    QVector<int> d_codes;
+    //! Distinct strings; index 0 is always the empty string
+    QVector<QString> d_dictionary;
+    //! Reverse lookup for d_dictionary
+    QHash<QString, int> d_lookup;
+};
+
+//! Data of a date/time column
+/**
+ * Instead of QDateTime objects, this stores one 64 bit integer per row: the milliseconds since
+ * 1970-01-01 00:00 UTC. The QDateTime is only constructed when a row is accessed.
+ *
+ * Date/times are assumed to be in local time. Only once a row with another time spec is stored,
+ * a second vector is allocated, holding UTC or the offset from UTC for every row. Date/times
+ * with a Qt::TimeZone spec keep their offset, but not the time zone. Local times which don't
+ * exist (e.g. in the gap of a daylight saving time transition) are kept as read from the clock.
+ *
+ * Invalid date/times and those with only a valid time (which may appear while editing date and
+ * time separately) are kept as special values outside the range of regular ones.
+ */
+class DateTimeColumnData
+{
+public:
+    DateTimeColumnData() { }
+    DateTimeColumnData(const QList<QDateTime> &dateTimes);
+
+    int size() const { return d_values.size(); }
+    QDateTime at(int row) const
+    {
+        return decode(d_values.at(row), d_specs.isEmpty() ? local_time : d_specs.at(row));
+    }
+    //! Like at(), but returns an invalid date/time for rows out of range
+    QDateTime value(int row) const
+    {
+        return row >= 0 && row < d_values.size() ? at(row) : QDateTime();
+    }
+    void replace(int row, const QDateTime &dateTime);
+
+    //! Resize to \c size rows, filling new rows with invalid date/times
+    void resize(int size);
+    //! Insert \c count invalid date/times before \c row
+    void insert(int row, int count);
+    void remove(int first, int count);
+
+    QList<QDateTime> mid(int first, int count) const;
+
+    //! Return the number of bytes used for the data
+    qint64 memoryUsage() const
+    {
+        return qint64(d_values.size()) * sizeof(qint64) + qint64(d_specs.size()) * sizeof(qint32);
+    }
+
+private:
+    //! Store \c dateTime in \c value and its time spec in \c spec
+    static void encode(const QDateTime &dateTime, qint64 &value, qint32 &spec);
+    static QDateTime decode(qint64 value, qint32 spec);
+
+    //! Encoding of QDateTime(); time-only values follow directly after it
+    static const qint64 invalid;
+    //! \name Time specs besides offsets from UTC in seconds, which are never 0
+    //@{
+    static constexpr qint32 local_time = 0;
+    static constexpr qint32 utc = std::numeric_limits<qint32>::min();
+    //! A local time which doesn't exist; the value is its wall clock time counted like UTC
+    static constexpr qint32 local_wall_clock = utc + 1;
+    //@}
+
+    QVector<qint64> d_values;
+    //! Time spec of each row; empty as long as all rows are in local time
+    QVector<qint32> d_specs;
+};
+
+#endif // ifndef COLUMNDATA_H
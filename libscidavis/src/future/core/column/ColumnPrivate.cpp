@@ -29,6 +29,7 @@
 
 #include "core/column/ColumnPrivate.h"
 #include "core/column/Column.h"
+#include "core/column/ColumnData.h"
 #include "core/AbstractSimpleFilter.h"
 #include "core/datatypes/SimpleCopyThroughFilter.h"
 #include "core/datatypes/String2DoubleFilter.h"
@@ -81,7 +82,7 @@ Column::Private::Private(Column *owner, SciDAVis::ColumnMode mode) : d_owner(own
         d_input_filter = new SimpleCopyThroughFilter();
         d_output_filter = new SimpleCopyThroughFilter();
         d_data_type = SciDAVis::TypeQString;
-        d_data = new QStringList();
+        d_data = new TextColumnData();
         break;
     }
     case SciDAVis::ColumnMode::DateTime: {
@@ -91,7 +92,7 @@ Column::Private::Private(Column *owner, SciDAVis::ColumnMode mode) : d_owner(own
         connect(static_cast<DateTime2StringFilter *>(d_output_filter), SIGNAL(formatChanged()),
                 d_owner, SLOT(notifyDisplayChange()));
         d_data_type = SciDAVis::TypeQDateTime;
-        d_data = new QList<QDateTime>();
+        d_data = new DateTimeColumnData();
         break;
     }
     case SciDAVis::ColumnMode::Month: {
@@ -101,7 +102,7 @@ Column::Private::Private(Column *owner, SciDAVis::ColumnMode mode) : d_owner(own
         connect(static_cast<DateTime2StringFilter *>(d_output_filter), SIGNAL(formatChanged()),
                 d_owner, SLOT(notifyDisplayChange()));
         d_data_type = SciDAVis::TypeQDateTime;
-        d_data = new QList<QDateTime>();
+        d_data = new DateTimeColumnData();
         break;
     }
     case SciDAVis::ColumnMode::Day: {
@@ -111,7 +112,7 @@ Column::Private::Private(Column *owner, SciDAVis::ColumnMode mode) : d_owner(own
         connect(static_cast<DateTime2StringFilter *>(d_output_filter), SIGNAL(formatChanged()),
                 d_owner, SLOT(notifyDisplayChange()));
         d_data_type = SciDAVis::TypeQDateTime;
-        d_data = new QList<QDateTime>();
+        d_data = new DateTimeColumnData();
         break;
     }
     } // switch(mode)
@@ -194,11 +195,11 @@ Column::Private::~Private()
         break;
 
     case SciDAVis::TypeQString:
-        delete static_cast<QStringList *>(d_data);
+        delete static_cast<TextColumnData *>(d_data);
         break;
 
     case SciDAVis::TypeQDateTime:
-        delete static_cast<QList<QDateTime> *>(d_data);
+        delete static_cast<DateTimeColumnData *>(d_data);
         break;
     } // switch(d_data_type)
 }
@@ -261,7 +262,7 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode new_mode, AbstractFilte
         break;
     }
     case SciDAVis::ColumnMode::Text: {
-        d_data = new QStringList();
+        d_data = new TextColumnData();
         d_data_type = SciDAVis::TypeQString;
         new_in_filter = new SimpleCopyThroughFilter();
         new_out_filter = new SimpleCopyThroughFilter();
@@ -277,7 +278,7 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode new_mode, AbstractFilte
         d_numeric_datetime_filter.reset(new NumericDateTimeBaseFilter());
         if ((SciDAVis::ColumnMode::DateTime != old_mode) && (SciDAVis::ColumnMode::Month != old_mode)
             && (SciDAVis::ColumnMode::Day != old_mode)) {
-            d_data = new QList<QDateTime>();
+            d_data = new DateTimeColumnData();
             d_data_type = SciDAVis::TypeQDateTime;
         }
         connect(static_cast<DateTime2StringFilter *>(new_out_filter), SIGNAL(formatChanged()),
@@ -315,7 +316,7 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode new_mode, AbstractFilte
         new_out_filter = new DateTime2StringFilter();
         if ((SciDAVis::ColumnMode::DateTime != old_mode) && (SciDAVis::ColumnMode::Month != old_mode)
             && (SciDAVis::ColumnMode::Day != old_mode)) {
-            d_data = new QList<QDateTime>();
+            d_data = new DateTimeColumnData();
             d_data_type = SciDAVis::TypeQDateTime;
         }
         static_cast<DateTime2StringFilter *>(new_out_filter)->setFormat("MMMM");
@@ -344,7 +345,7 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode new_mode, AbstractFilte
         new_out_filter = new DateTime2StringFilter();
         if ((SciDAVis::ColumnMode::DateTime != old_mode) && (SciDAVis::ColumnMode::Month != old_mode)
             && (SciDAVis::ColumnMode::Day != old_mode)) {
-            d_data = new QList<QDateTime>();
+            d_data = new DateTimeColumnData();
             d_data_type = SciDAVis::TypeQDateTime;
         }
         static_cast<DateTime2StringFilter *>(new_out_filter)->setFormat("dddd");
@@ -388,7 +389,8 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode new_mode, AbstractFilte
         break;
     }
     case SciDAVis::ColumnMode::Text: {
-        temp_col.reset(new Column("temp_col", *(static_cast<QStringList *>(old_data)), d_validity));
+        temp_col.reset(
+                new Column("temp_col", *(static_cast<TextColumnData *>(old_data)), d_validity));
         break;
     }
     case SciDAVis::ColumnMode::DateTime: // fallthrough intended
@@ -398,7 +400,7 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode new_mode, AbstractFilte
                    d_owner, SLOT(notifyDisplayChange()));
         if ((SciDAVis::ColumnMode::DateTime != new_mode) && (SciDAVis::ColumnMode::Month != new_mode)
             && (SciDAVis::ColumnMode::Day != new_mode))
-            temp_col.reset(new Column("temp_col", *(static_cast<QList<QDateTime> *>(old_data)),
+            temp_col.reset(new Column("temp_col", *(static_cast<DateTimeColumnData *>(old_data)),
                                       d_validity));
         break;
     }
@@ -485,6 +487,37 @@ void Column::Private::replaceData(void *data, IntervalAttribute<bool> validity)
     emit d_owner->dataChanged(d_owner);
 }
 
+void Column::Private::assignData(const QVector<double> &values, IntervalAttribute<bool> validity)
+{
+    if (d_data_type != SciDAVis::TypeDouble)
+        return;
+    emit d_owner->dataAboutToChange(d_owner);
+    *static_cast<QVector<double> *>(d_data) = values;
+    d_validity = validity;
+    emit d_owner->dataChanged(d_owner);
+}
+
+void Column::Private::assignData(const TextColumnData &texts, IntervalAttribute<bool> validity)
+{
+    if (d_data_type != SciDAVis::TypeQString)
+        return;
+    emit d_owner->dataAboutToChange(d_owner);
+    *static_cast<TextColumnData *>(d_data) = texts;
+    d_validity = validity;
+    emit d_owner->dataChanged(d_owner);
+}
+
+void Column::Private::assignData(const DateTimeColumnData &date_times,
+                                 IntervalAttribute<bool> validity)
+{
+    if (d_data_type != SciDAVis::TypeQDateTime)
+        return;
+    emit d_owner->dataAboutToChange(d_owner);
+    *static_cast<DateTimeColumnData *>(d_data) = date_times;
+    d_validity = validity;
+    emit d_owner->dataChanged(d_owner);
+}
+
 bool Column::Private::copy(const AbstractColumn *other)
 {
     if (other->dataType() != dataType())
@@ -504,12 +537,12 @@ bool Column::Private::copy(const AbstractColumn *other)
     }
     case SciDAVis::TypeQString: {
         for (int i = 0; i < num_rows; i++)
-            static_cast<QStringList *>(d_data)->replace(i, other->textAt(i));
+            static_cast<TextColumnData *>(d_data)->replace(i, other->textAt(i));
         break;
     }
     case SciDAVis::TypeQDateTime: {
         for (int i = 0; i < num_rows; i++)
-            static_cast<QList<QDateTime> *>(d_data)->replace(i, other->dateTimeAt(i));
+            static_cast<DateTimeColumnData *>(d_data)->replace(i, other->dateTimeAt(i));
         break;
     }
     }
@@ -545,12 +578,12 @@ bool Column::Private::copy(const AbstractColumn *source, int source_start, int d
     }
     case SciDAVis::TypeQString:
         for (int i = 0; i < num_rows; i++)
-            static_cast<QStringList *>(d_data)->replace(dest_start + i,
+            static_cast<TextColumnData *>(d_data)->replace(dest_start + i,
                                                         source->textAt(source_start + i));
         break;
     case SciDAVis::TypeQDateTime:
         for (int i = 0; i < num_rows; i++)
-            static_cast<QList<QDateTime> *>(d_data)->replace(dest_start + i,
+            static_cast<DateTimeColumnData *>(d_data)->replace(dest_start + i,
                                                              source->dateTimeAt(source_start + i));
         break;
     }
@@ -582,12 +615,12 @@ bool Column::Private::copy(const Private *other)
     }
     case SciDAVis::TypeQString: {
         for (int i = 0; i < num_rows; i++)
-            static_cast<QStringList *>(d_data)->replace(i, other->textAt(i));
+            static_cast<TextColumnData *>(d_data)->replace(i, other->textAt(i));
         break;
     }
     case SciDAVis::TypeQDateTime: {
         for (int i = 0; i < num_rows; i++)
-            static_cast<QList<QDateTime> *>(d_data)->replace(i, other->dateTimeAt(i));
+            static_cast<DateTimeColumnData *>(d_data)->replace(i, other->dateTimeAt(i));
         break;
     }
     }
@@ -622,12 +655,12 @@ bool Column::Private::copy(const Private *source, int source_start, int dest_sta
     }
     case SciDAVis::TypeQString:
         for (int i = 0; i < num_rows; i++)
-            static_cast<QStringList *>(d_data)->replace(dest_start + i,
+            static_cast<TextColumnData *>(d_data)->replace(dest_start + i,
                                                         source->textAt(source_start + i));
         break;
     case SciDAVis::TypeQDateTime:
         for (int i = 0; i < num_rows; i++)
-            static_cast<QList<QDateTime> *>(d_data)->replace(dest_start + i,
+            static_cast<DateTimeColumnData *>(d_data)->replace(dest_start + i,
                                                              source->dateTimeAt(source_start + i));
         break;
     }
@@ -640,15 +673,39 @@ bool Column::Private::copy(const Private *source, int source_start, int dest_sta
     return true;
 }
 
+void Column::Private::share(const Private *other)
+{
+    Q_ASSERT(other->columnMode() == columnMode());
+    switch (d_data_type) {
+    case SciDAVis::TypeDouble:
+        *static_cast<QVector<double> *>(d_data) = *static_cast<QVector<double> *>(other->d_data);
+        break;
+    case SciDAVis::TypeQString:
+        *static_cast<TextColumnData *>(d_data) = *static_cast<TextColumnData *>(other->d_data);
+        break;
+    case SciDAVis::TypeQDateTime:
+        *static_cast<DateTimeColumnData *>(d_data) =
+                *static_cast<DateTimeColumnData *>(other->d_data);
+        break;
+    }
+    d_validity = other->d_validity;
+    d_masking = other->d_masking;
+    d_formulas = other->d_formulas;
+    d_plot_designation = other->d_plot_designation;
+    if (other->d_numeric_datetime_filter)
+        d_numeric_datetime_filter.reset(
+                new NumericDateTimeBaseFilter(*other->d_numeric_datetime_filter));
+}
+
 int Column::Private::rowCount() const
 {
     switch (d_data_type) {
     case SciDAVis::TypeDouble:
         return static_cast<QVector<double> *>(d_data)->size();
     case SciDAVis::TypeQDateTime:
-        return static_cast<QList<QDateTime> *>(d_data)->size();
+        return static_cast<DateTimeColumnData *>(d_data)->size();
     case SciDAVis::TypeQString:
-        return static_cast<QStringList *>(d_data)->size();
+        return static_cast<TextColumnData *>(d_data)->size();
     }
 
     return 0;
@@ -664,29 +721,13 @@ void Column::Private::resizeTo(int new_size)
     case SciDAVis::TypeDouble:
         static_cast<QVector<double> *>(d_data)->resize(new_size);
         break;
-    case SciDAVis::TypeQDateTime: {
-        int new_rows = new_size - old_size;
-        if (new_rows > 0) {
-            for (int i = 0; i < new_rows; i++)
-                static_cast<QList<QDateTime> *>(d_data)->append(QDateTime());
-        } else {
-            for (int i = 0; i < -new_rows; i++)
-                static_cast<QList<QDateTime> *>(d_data)->removeLast();
-        }
+    case SciDAVis::TypeQDateTime:
+        static_cast<DateTimeColumnData *>(d_data)->resize(new_size);
         break;
-    }
-    case SciDAVis::TypeQString: {
-        int new_rows = new_size - old_size;
-        if (new_rows > 0) {
-            for (int i = 0; i < new_rows; i++)
-                static_cast<QStringList *>(d_data)->append(QString());
-        } else {
-            for (int i = 0; i < -new_rows; i++)
-                static_cast<QStringList *>(d_data)->removeLast();
-        }
+    case SciDAVis::TypeQString:
+        static_cast<TextColumnData *>(d_data)->resize(new_size);
         break;
     }
-    }
 }
 
 void Column::Private::insertRows(int before, int count)
@@ -706,12 +747,10 @@ void Column::Private::insertRows(int before, int count)
             static_cast<QVector<double> *>(d_data)->insert(before, count, 0.0);
             break;
         case SciDAVis::TypeQDateTime:
-            for (int i = 0; i < count; i++)
-                static_cast<QList<QDateTime> *>(d_data)->insert(before, QDateTime());
+            static_cast<DateTimeColumnData *>(d_data)->insert(before, count);
             break;
         case SciDAVis::TypeQString:
-            for (int i = 0; i < count; i++)
-                static_cast<QStringList *>(d_data)->insert(before, QString());
+            static_cast<TextColumnData *>(d_data)->insert(before, count);
             break;
         }
     }
@@ -738,12 +777,10 @@ void Column::Private::removeRows(int first, int count)
             static_cast<QVector<double> *>(d_data)->remove(first, corrected_count);
             break;
         case SciDAVis::TypeQDateTime:
-            for (int i = 0; i < corrected_count; i++)
-                static_cast<QList<QDateTime> *>(d_data)->removeAt(first);
+            static_cast<DateTimeColumnData *>(d_data)->remove(first, corrected_count);
             break;
         case SciDAVis::TypeQString:
-            for (int i = 0; i < corrected_count; i++)
-                static_cast<QStringList *>(d_data)->removeAt(first);
+            static_cast<TextColumnData *>(d_data)->remove(first, corrected_count);
             break;
         }
     }
@@ -819,7 +856,7 @@ QString Column::Private::textAt(int row) const
 {
     if (d_data_type != SciDAVis::TypeQString)
         return QString();
-    return static_cast<QStringList *>(d_data)->value(row);
+    return static_cast<TextColumnData *>(d_data)->value(row);
 }
 
 QDate Column::Private::dateAt(int row) const
@@ -836,7 +873,7 @@ QDateTime Column::Private::dateTimeAt(int row) const
 {
     if (d_data_type != SciDAVis::TypeQDateTime)
         return QDateTime();
-    return static_cast<QList<QDateTime> *>(d_data)->value(row);
+    return static_cast<DateTimeColumnData *>(d_data)->value(row);
 }
 
 double Column::Private::valueAt(int row) const
@@ -858,7 +895,7 @@ void Column::Private::setTextAt(int row, const QString &new_value)
         resizeTo(row + 1);
     }
 
-    static_cast<QStringList *>(d_data)->replace(row, new_value);
+    static_cast<TextColumnData *>(d_data)->replace(row, new_value);
     d_validity.setValue(Interval<int>(row, row), false);
     emit d_owner->dataChanged(d_owner);
 }
@@ -876,7 +913,7 @@ void Column::Private::replaceTexts(int first, const QStringList &new_values)
         resizeTo(first + num_rows);
 
     for (int i = 0; i < num_rows; i++)
-        static_cast<QStringList *>(d_data)->replace(first + i, new_values.at(i));
+        static_cast<TextColumnData *>(d_data)->replace(first + i, new_values.at(i));
     d_validity.setValue(Interval<int>(first, first + num_rows - 1), false);
     emit d_owner->dataChanged(d_owner);
 }
@@ -909,7 +946,7 @@ void Column::Private::setDateTimeAt(int row, const QDateTime &new_value)
         resizeTo(row + 1);
     }
 
-    static_cast<QList<QDateTime> *>(d_data)->replace(row, new_value);
+    static_cast<DateTimeColumnData *>(d_data)->replace(row, new_value);
     d_validity.setValue(Interval<int>(row, row), !new_value.isValid());
     emit d_owner->dataChanged(d_owner);
 }
@@ -927,8 +964,8 @@ void Column::Private::replaceDateTimes(int first, const QList<QDateTime> &new_va
         resizeTo(first + num_rows);
 
     for (int i = 0; i < num_rows; i++) {
-        static_cast<QList<QDateTime> *>(d_data)->replace(first + i, new_values.at(i));
-        d_validity.setValue(i, !new_values.at(i).isValid());
+        static_cast<DateTimeColumnData *>(d_data)->replace(first + i, new_values.at(i));
+        d_validity.setValue(first + i, !new_values.at(i).isValid());
     }
     emit d_owner->dataChanged(d_owner);
 }
@@ -111,6 +111,12 @@ public:
      * \param num_rows the number of rows to copy
      */
     bool copy(const Private *source, int source_start, int dest_start, int num_rows);
+    //! Share data, validity, masking, formulas and plot designation of a column of the same mode
+    /**
+     * In contrast to copy(), this takes constant time, since the data is only copied once either
+     * of the two columns is modified. No signals are emitted; use only on fresh columns.
+     */
+    void share(const Private *other);
     //! Return the data vector size
     /**
      * This returns the number of rows that actually contain data.
@@ -157,6 +163,12 @@ public:
                          IntervalAttribute<bool> validity);
     //! Replace data pointer and validity
     void replaceData(void *data, IntervalAttribute<bool> validity);
+    //! \name Replace the data and validity in place (to be used by Column::Builder only)
+    //@{
+    void assignData(const QVector<double> &values, IntervalAttribute<bool> validity);
+    void assignData(const TextColumnData &texts, IntervalAttribute<bool> validity);
+    void assignData(const DateTimeColumnData &date_times, IntervalAttribute<bool> validity);
+    //@}
     //! Return the validity interval attribute
     IntervalAttribute<bool> validityAttribute() { return d_validity; }
     //! Return the masking interval attribute
@@ -174,6 +186,11 @@ public:
     bool isInvalid(int row) const { return d_validity.isSet(row); }
     //! Return whether a certain interval of rows contains only invalid values
     bool isInvalid(Interval<int> i) const { return d_validity.isSet(i); }
+    //! Return for each of the rows first .. first+count-1 whether it contains an invalid value
+    QVector<bool> invalidBitmap(int first, int count) const
+    {
+        return d_validity.bitmap(first, count);
+    }
     //! Return all intervals of invalid rows
     QList<Interval<int>> invalidIntervals() const { return d_validity.intervals(); }
     //! Return whether a certain row is masked
@@ -315,8 +332,8 @@ private:
     SciDAVis::ColumnMode d_column_mode;
     //! Pointer to the data vector
     /**
-     * This will point to a QVector<double>, QStringList or
-     * QList<QDateTime> depending on the stored data type.
+     * This will point to a QVector<double>, TextColumnData or
+     * DateTimeColumnData depending on the stored data type.
      */
     void *d_data;
     //! The input filter (for string -> data type conversion)
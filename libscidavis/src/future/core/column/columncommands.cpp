@@ -28,8 +28,100 @@
  ***************************************************************************/
 
 #include "ColumnPrivate.h"
+#include "ColumnData.h"
 #include "columncommands.h"
 
+#include <QDataStream>
+
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////
+// class ColumnDataBackup
+///////////////////////////////////////////////////////////////////////////
+void ColumnDataBackup::hold(SciDAVis::ColumnDataType type, void *data)
+{
+    release();
+    d_type = type;
+    d_data = data;
+    switch (d_type) {
+    case SciDAVis::TypeDouble:
+        setMemoryUsage(qint64(static_cast<QVector<double> *>(d_data)->size()) * sizeof(double));
+        break;
+    case SciDAVis::TypeQString:
+        setMemoryUsage(static_cast<TextColumnData *>(d_data)->memoryUsage());
+        break;
+    case SciDAVis::TypeQDateTime:
+        setMemoryUsage(static_cast<DateTimeColumnData *>(d_data)->memoryUsage());
+        break;
+    }
+}
+
+void ColumnDataBackup::release()
+{
+    if (d_data && isOnDisk()) {
+        QByteArray bytes = qUncompress(readFromDisk());
+        QDataStream stream(bytes);
+        switch (d_type) {
+        case SciDAVis::TypeDouble:
+            stream >> *static_cast<QVector<double> *>(d_data);
+            break;
+        case SciDAVis::TypeQString: {
+            QStringList texts;
+            stream >> texts;
+            *static_cast<TextColumnData *>(d_data) = TextColumnData(texts);
+            break;
+        }
+        case SciDAVis::TypeQDateTime: {
+            QList<QDateTime> date_times;
+            stream >> date_times;
+            *static_cast<DateTimeColumnData *>(d_data) = DateTimeColumnData(date_times);
+            break;
+        }
+        }
+        discardDisk();
+    }
+    d_data = 0;
+    setMemoryUsage(0);
+}
+
+void ColumnDataBackup::spill()
+{
+    if (!d_data)
+        return;
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    switch (d_type) {
+    case SciDAVis::TypeDouble:
+        stream << *static_cast<QVector<double> *>(d_data);
+        break;
+    case SciDAVis::TypeQString:
+        stream << static_cast<TextColumnData *>(d_data)->mid(0, -1);
+        break;
+    case SciDAVis::TypeQDateTime:
+        stream << static_cast<DateTimeColumnData *>(d_data)->mid(0, -1);
+        break;
+    }
+    writeToDisk(qCompress(bytes, 1));
+    if (!isOnDisk())
+        return;
+    // empty the data in place, so that pointers to it stay valid
+    switch (d_type) {
+    case SciDAVis::TypeDouble:
+        *static_cast<QVector<double> *>(d_data) = QVector<double>();
+        break;
+    case SciDAVis::TypeQString:
+        *static_cast<TextColumnData *>(d_data) = TextColumnData();
+        break;
+    case SciDAVis::TypeQDateTime:
+        *static_cast<DateTimeColumnData *>(d_data) = DateTimeColumnData();
+        break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// end of class ColumnDataBackup
+///////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnSetModeCmd
 ///////////////////////////////////////////////////////////////////////////
@@ -49,18 +141,18 @@ ColumnSetModeCmd::~ColumnSetModeCmd()
             if (d_new_type == SciDAVis::TypeDouble)
                 delete static_cast<QVector<double> *>(d_new_data);
             else if (d_new_type == SciDAVis::TypeQString)
-                delete static_cast<QStringList *>(d_new_data);
+                delete static_cast<TextColumnData *>(d_new_data);
             else if (d_new_type == SciDAVis::TypeQDateTime)
-                delete static_cast<QList<QDateTime> *>(d_new_data);
+                delete static_cast<DateTimeColumnData *>(d_new_data);
         }
     } else {
         if (d_new_data != d_old_data) {
             if (d_old_type == SciDAVis::TypeDouble)
                 delete static_cast<QVector<double> *>(d_old_data);
             else if (d_old_type == SciDAVis::TypeQString)
-                delete static_cast<QStringList *>(d_old_data);
+                delete static_cast<TextColumnData *>(d_old_data);
             else if (d_old_type == SciDAVis::TypeQDateTime)
-                delete static_cast<QList<QDateTime> *>(d_old_data);
+                delete static_cast<DateTimeColumnData *>(d_old_data);
         }
     }
     if (d_conversion_filter)
@@ -90,17 +182,23 @@ void ColumnSetModeCmd::redo()
         d_executed = true;
     } else {
         // set to saved new values
+        d_new_backup.release();
         d_col->replaceModeData(d_mode, d_new_type, d_new_data, d_new_in_filter, d_new_out_filter,
                                d_new_validity);
     }
+    if (d_new_data != d_old_data)
+        d_old_backup.hold(d_old_type, d_old_data);
     d_undone = false;
 }
 
 void ColumnSetModeCmd::undo()
 {
     // reset to old values
+    d_old_backup.release();
     d_col->replaceModeData(d_old_mode, d_old_type, d_old_data, d_old_in_filter, d_old_out_filter,
                            d_old_validity);
+    if (d_new_data != d_old_data)
+        d_new_backup.hold(d_new_type, d_new_data);
 
     d_undone = true;
 }
@@ -329,16 +427,16 @@ ColumnClearCmd::~ColumnClearCmd()
         if (d_type == SciDAVis::TypeDouble)
             delete static_cast<QVector<double> *>(d_empty_data);
         else if (d_type == SciDAVis::TypeQString)
-            delete static_cast<QStringList *>(d_empty_data);
+            delete static_cast<TextColumnData *>(d_empty_data);
         else if (d_type == SciDAVis::TypeQDateTime)
-            delete static_cast<QList<QDateTime> *>(d_empty_data);
+            delete static_cast<DateTimeColumnData *>(d_empty_data);
     } else {
         if (d_type == SciDAVis::TypeDouble)
             delete static_cast<QVector<double> *>(d_data);
         else if (d_type == SciDAVis::TypeQString)
-            delete static_cast<QStringList *>(d_data);
+            delete static_cast<TextColumnData *>(d_data);
         else if (d_type == SciDAVis::TypeQDateTime)
-            delete static_cast<QList<QDateTime> *>(d_data);
+            delete static_cast<DateTimeColumnData *>(d_data);
     }
 }
 
@@ -351,21 +449,23 @@ void ColumnClearCmd::redo()
             d_empty_data = new QVector<double>();
             break;
         case SciDAVis::TypeQDateTime:
-            d_empty_data = new QList<QDateTime>();
+            d_empty_data = new DateTimeColumnData();
             break;
         case SciDAVis::TypeQString:
-            d_empty_data = new QStringList();
+            d_empty_data = new TextColumnData();
             break;
         }
         d_data = d_col->dataPointer();
         d_validity = d_col->validityAttribute();
     }
     d_col->replaceData(d_empty_data, IntervalAttribute<bool>());
+    d_backup.hold(d_type, d_data);
     d_undone = false;
 }
 
 void ColumnClearCmd::undo()
 {
+    d_backup.release();
     d_col->replaceData(d_data, d_validity);
     d_undone = true;
 }
@@ -675,7 +775,7 @@ ColumnReplaceTextsCmd::~ColumnReplaceTextsCmd() { }
 void ColumnReplaceTextsCmd::redo()
 {
     if (!d_copied) {
-        d_old_values = static_cast<QStringList *>(d_col->dataPointer())
+        d_old_values = static_cast<TextColumnData *>(d_col->dataPointer())
                                ->mid(d_first, d_new_values.count());
         d_row_count = d_col->rowCount();
         d_validity = d_col->validityAttribute();
@@ -698,15 +798,46 @@ void ColumnReplaceTextsCmd::undo()
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnReplaceValuesCmd
 ///////////////////////////////////////////////////////////////////////////
+namespace {
+//! Return the bit patterns of \c values
+QByteArray valuesToBytes(const QVector<qreal> &values)
+{
+    return QByteArray(reinterpret_cast<const char *>(values.constData()),
+                      values.size() * int(sizeof(qreal)));
+}
+
+//! Return the values with the bit patterns in \c bytes
+QVector<qreal> bytesToValues(const QByteArray &bytes)
+{
+    QVector<qreal> values(bytes.size() / int(sizeof(qreal)));
+    std::memcpy(values.data(), bytes.constData(), values.size() * sizeof(qreal));
+    return values;
+}
+
+//! XOR the leading bytes of \c bytes with \c other (which may be longer) in place
+/**
+ * This is its own inverse, and turns the values which are the same in both into zeros, which
+ * compress very well.
+ */
+void xorBytes(QByteArray &bytes, const QByteArray &other)
+{
+    char *dest = bytes.data();
+    const char *src = other.constData();
+    for (int i = 0, n = qMin(bytes.size(), other.size()); i < n; i++)
+        dest[i] ^= src[i];
+}
+} // namespace
+
 ColumnReplaceValuesCmd::ColumnReplaceValuesCmd(Column::Private *col, int first,
                                                const QVector<qreal> &new_values,
                                                QUndoCommand *parent)
-    : QUndoCommand(parent), d_col(col), d_first(first), d_new_values(new_values)
+    : QUndoCommand(parent), d_col(col), d_first(first)
 {
     setText(QObject::tr("%1: replace the values for rows %2 to %3")
                     .arg(col->name())
                     .arg(first)
                     .arg(first + new_values.count() - 1));
+    d_new_values.set(valuesToBytes(new_values));
     d_copied = false;
 }
 
@@ -714,19 +845,25 @@ ColumnReplaceValuesCmd::~ColumnReplaceValuesCmd() { }
 
 void ColumnReplaceValuesCmd::redo()
 {
+    QByteArray new_values = d_new_values.get();
     if (!d_copied) {
-        d_old_values = static_cast<QVector<qreal> *>(d_col->dataPointer())
-                               ->mid(d_first, d_new_values.count());
+        QByteArray old_values = valuesToBytes(
+                static_cast<QVector<qreal> *>(d_col->dataPointer())
+                        ->mid(d_first, new_values.size() / int(sizeof(qreal))));
+        xorBytes(old_values, new_values);
+        d_old_values.set(old_values);
         d_row_count = d_col->rowCount();
         d_validity = d_col->validityAttribute();
         d_copied = true;
     }
-    d_col->replaceValues(d_first, d_new_values);
+    d_col->replaceValues(d_first, bytesToValues(new_values));
 }
 
 void ColumnReplaceValuesCmd::undo()
 {
-    d_col->replaceValues(d_first, d_old_values);
+    QByteArray old_values = d_old_values.get();
+    xorBytes(old_values, d_new_values.get());
+    d_col->replaceValues(d_first, bytesToValues(old_values));
     d_col->resizeTo(d_row_count);
     d_col->replaceData(d_col->dataPointer(), d_validity);
 }
@@ -755,7 +892,7 @@ ColumnReplaceDateTimesCmd::~ColumnReplaceDateTimesCmd() { }
 void ColumnReplaceDateTimesCmd::redo()
 {
     if (!d_copied) {
-        d_old_values = static_cast<QList<QDateTime> *>(d_col->dataPointer())
+        d_old_values = static_cast<DateTimeColumnData *>(d_col->dataPointer())
                                ->mid(d_first, d_new_values.count());
         d_row_count = d_col->rowCount();
         d_validity = d_col->validityAttribute();
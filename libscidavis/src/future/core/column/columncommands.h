@@ -35,6 +35,37 @@
 #include "core/column/Column.h"
 #include "core/AbstractSimpleFilter.h"
 #include "lib/IntervalAttribute.h"
+#include "lib/UndoMemory.h"
+
+///////////////////////////////////////////////////////////////////////////
+// class ColumnDataBackup
+///////////////////////////////////////////////////////////////////////////
+//! Column data kept by an undo command while it is not part of the column
+/**
+ * The data object itself stays alive at the same address (commands further down the undo stack
+ * may refer to it), but once the undo history exceeds its memory budget, its content is moved to
+ * disk until release() is called.
+ */
+class ColumnDataBackup : public UndoMemory::Client
+{
+public:
+    ColumnDataBackup() : d_type(SciDAVis::TypeDouble), d_data(0) { }
+
+    //! Start keeping track of \c data, which has just been removed from a column
+    void hold(SciDAVis::ColumnDataType type, void *data);
+    //! Make sure the content is back in memory before handing the data to a column again
+    void release();
+
+protected:
+    void spill() override;
+
+private:
+    SciDAVis::ColumnDataType d_type;
+    void *d_data;
+};
+///////////////////////////////////////////////////////////////////////////
+// end of class ColumnDataBackup
+///////////////////////////////////////////////////////////////////////////
 
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnSetModeCmd
@@ -87,6 +118,10 @@ private:
     bool d_executed;
     //! Filter to use for converting existing data
     AbstractFilter *d_conversion_filter;
+    //! Keeps the old data while the command is executed
+    ColumnDataBackup d_old_backup;
+    //! Keeps the new data while the command is undone
+    ColumnDataBackup d_new_backup;
 };
 ///////////////////////////////////////////////////////////////////////////
 // end of class ColumnSetModeCmd
@@ -319,6 +354,8 @@ private:
     IntervalAttribute<bool> d_validity;
     //! Status flag
     bool d_undone;
+    //! Keeps the old data while the column is cleared
+    ColumnDataBackup d_backup;
 };
 ///////////////////////////////////////////////////////////////////////////
 // end of class ColumnClearCmd
@@ -662,6 +699,10 @@ private:
 // class ColumnReplaceValuesCmd
 ///////////////////////////////////////////////////////////////////////////
 //! Replace a range of doubles in a double column
+/**
+ * Both the new values and the old ones are kept compressed. The old values are stored as the
+ * bitwise difference to the new ones, so rows which didn't actually change take next to no space.
+ */
 class ColumnReplaceValuesCmd : public QUndoCommand
 {
 public:
@@ -682,9 +723,9 @@ private:
     //! The first row to replace
     int d_first;
     //! The new values
-    QVector<qreal> d_new_values;
-    //! The old values
-    QVector<qreal> d_old_values;
+    UndoMemory::Payload d_new_values;
+    //! The old values, XOR the new ones
+    UndoMemory::Payload d_old_values;
     //! Status flag
     bool d_copied;
     //! The old number of rows
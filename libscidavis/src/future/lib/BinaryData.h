@@ -0,0 +1,104 @@
+/***************************************************************************
+    File                 : BinaryData.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Compact encoding of numeric data in project files
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BINARYDATA_H
+#define BINARYDATA_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
+
+//! \name Binary data in project files
+/**
+ * Instead of one XML element per value, numeric columns and matrices can be stored as a single
+ * base64 string holding the raw IEEE 754 doubles in little-endian byte order, which is both
+ * smaller and much faster to write and parse than decimal text. Validity information goes into a
+ * separate bitmap with one bit per row, least significant bit first.
+ */
+//@{
+
+//! Return the base64 encoding of \c count little-endian doubles starting at \c values
+inline QByteArray encodeDoubles(const double *values, int count)
+{
+    QByteArray bytes(count * int(sizeof(double)), Qt::Uninitialized);
+    uchar *dest = reinterpret_cast<uchar *>(bytes.data());
+    for (int i = 0; i < count; i++) {
+        quint64 bits;
+        std::memcpy(&bits, values + i, sizeof(double));
+        qToLittleEndian(bits, dest + i * sizeof(double));
+    }
+    return bytes.toBase64();
+}
+
+//! Decode the output of encodeDoubles() into \c values
+/**
+ * \return false if \c text doesn't hold exactly \c count doubles
+ */
+inline bool decodeDoubles(const QString &text, int count, QVector<double> &values)
+{
+    QByteArray bytes = QByteArray::fromBase64(text.toLatin1());
+    if (count < 0 || bytes.size() != count * int(sizeof(double)))
+        return false;
+    values.resize(count);
+    const uchar *src = reinterpret_cast<const uchar *>(bytes.constData());
+    for (int i = 0; i < count; i++) {
+        quint64 bits = qFromLittleEndian<quint64>(src + i * sizeof(double));
+        std::memcpy(values.data() + i, &bits, sizeof(double));
+    }
+    return true;
+}
+
+//! Return the base64 encoding of \c bits, packed eight to a byte
+inline QByteArray encodeBitmap(const QVector<bool> &bits)
+{
+    QByteArray bytes((bits.size() + 7) / 8, '\0');
+    for (int i = 0; i < bits.size(); i++)
+        if (bits.at(i))
+            bytes[i / 8] = char(uchar(bytes.at(i / 8)) | (1 << (i % 8)));
+    return bytes.toBase64();
+}
+
+//! Decode the output of encodeBitmap() into \c bits
+/**
+ * \return false if \c text doesn't have room for exactly \c count bits
+ */
+inline bool decodeBitmap(const QString &text, int count, QVector<bool> &bits)
+{
+    QByteArray bytes = QByteArray::fromBase64(text.toLatin1());
+    if (count < 0 || bytes.size() != (count + 7) / 8)
+        return false;
+    bits.resize(count);
+    for (int i = 0; i < count; i++)
+        bits[i] = uchar(bytes.at(i / 8)) & (1 << (i % 8));
+    return true;
+}
+//@}
+
+#endif // ifndef BINARYDATA_H
@@ -0,0 +1,231 @@
+/***************************************************************************
+    File                 : GzipDevice.cpp
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Read and write gzip-compressed data on the fly
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/GzipDevice.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+const int buffer_size = 1 << 16;
+//! windowBits for deflateInit2() to write a gzip header and trailer
+const int gzip_window_bits = 15 + 16;
+//! windowBits for inflateInit2() to accept both gzip and zlib headers
+const int auto_window_bits = 15 + 32;
+} // namespace
+
+struct GzipDevice::Stream
+{
+    z_stream zs;
+    //! Compressed data read from or to be written to the underlying device
+    QByteArray compressed;
+    //! Decompressed data not read yet, starting at output_pos
+    QByteArray output;
+    int output_pos = 0;
+    //! Position (in uncompressed data) of output[output_pos]
+    qint64 position = 0;
+    bool end_of_stream = false;
+    bool failed = false;
+};
+
+GzipDevice::GzipDevice(QIODevice *device, int level, QObject *parent)
+    : QIODevice(parent), d_device(device), d_level(level)
+{
+}
+
+GzipDevice::~GzipDevice()
+{
+    close();
+}
+
+bool GzipDevice::open(OpenMode mode)
+{
+    if (isOpen() || (mode & ReadWrite) == ReadWrite || !(mode & ReadWrite)
+        || (mode & (Append | Truncate))) {
+        setErrorString(
+                QObject::tr("A gzip stream can be opened either for reading or for writing."));
+        return false;
+    }
+
+    d_stream.reset(new Stream);
+    std::memset(&d_stream->zs, 0, sizeof(d_stream->zs));
+    int status;
+    if (mode & ReadOnly) {
+        status = inflateInit2(&d_stream->zs, auto_window_bits);
+    } else {
+        status = deflateInit2(&d_stream->zs, std::max(1, std::min(d_level, 9)), Z_DEFLATED,
+                              gzip_window_bits, 8, Z_DEFAULT_STRATEGY);
+        d_stream->compressed.resize(buffer_size);
+    }
+    if (status != Z_OK) {
+        setErrorString(QString::fromLatin1(d_stream->zs.msg ? d_stream->zs.msg : "zlib error"));
+        d_stream.reset();
+        return false;
+    }
+    // there's no point in buffering already buffered data once more
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void GzipDevice::close()
+{
+    if (!isOpen())
+        return;
+    if (openMode() & WriteOnly) {
+        deflateInput(Z_FINISH);
+        deflateEnd(&d_stream->zs);
+    } else
+        inflateEnd(&d_stream->zs);
+    d_stream.reset();
+    QIODevice::close();
+}
+
+bool GzipDevice::seek(qint64 pos)
+{
+    if (!(openMode() & ReadOnly) || pos < 0 || !QIODevice::seek(pos))
+        return false;
+
+    Stream &s = *d_stream;
+    if (pos < s.position) {
+        // start over
+        if (!d_device->seek(0) || inflateReset(&s.zs) != Z_OK)
+            return false;
+        s.zs.avail_in = 0;
+        s.output.clear();
+        s.output_pos = 0;
+        s.position = 0;
+        s.end_of_stream = false;
+        s.failed = false;
+    }
+    // skip ahead
+    while (s.position + s.output.size() - s.output_pos < pos) {
+        s.position += s.output.size() - s.output_pos;
+        s.output.clear();
+        s.output_pos = 0;
+        if (!fillOutput())
+            return false;
+    }
+    s.output_pos += int(pos - s.position);
+    s.position = pos;
+    return true;
+}
+
+bool GzipDevice::atEnd() const
+{
+    return !isOpen() || !(openMode() & ReadOnly) || !fillOutput();
+}
+
+qint64 GzipDevice::readData(char *data, qint64 maxSize)
+{
+    Stream &s = *d_stream;
+    qint64 done = 0;
+    while (done < maxSize && fillOutput()) {
+        int count = int(std::min(maxSize - done, qint64(s.output.size() - s.output_pos)));
+        std::memcpy(data + done, s.output.constData() + s.output_pos, count);
+        s.output_pos += count;
+        s.position += count;
+        done += count;
+    }
+    if (done == 0 && s.failed)
+        return -1;
+    return done;
+}
+
+bool GzipDevice::fillOutput() const
+{
+    Stream &s = *d_stream;
+    if (s.output_pos < s.output.size())
+        return true;
+    s.output.resize(buffer_size);
+    s.output_pos = 0;
+    int produced = 0;
+    while (produced == 0 && !s.end_of_stream && !s.failed) {
+        if (s.zs.avail_in == 0) {
+            s.compressed.resize(buffer_size);
+            qint64 count = d_device->read(s.compressed.data(), buffer_size);
+            if (count <= 0) {
+                // the file ends in the middle of the compressed stream
+                s.failed = true;
+                break;
+            }
+            s.zs.next_in = reinterpret_cast<Bytef *>(s.compressed.data());
+            s.zs.avail_in = uInt(count);
+        }
+        s.zs.next_out = reinterpret_cast<Bytef *>(s.output.data());
+        s.zs.avail_out = uInt(buffer_size);
+        int status = inflate(&s.zs, Z_NO_FLUSH);
+        produced = buffer_size - int(s.zs.avail_out);
+        if (status == Z_STREAM_END) {
+            // gzip files may consist of several concatenated members
+            if (s.zs.avail_in > 0 || !d_device->atEnd())
+                inflateReset(&s.zs);
+            else
+                s.end_of_stream = true;
+        } else if (status != Z_OK && !(status == Z_BUF_ERROR && s.zs.avail_in == 0)) {
+            const_cast<GzipDevice *>(this)->setErrorString(
+                    QString::fromLatin1(s.zs.msg ? s.zs.msg : "zlib error"));
+            s.failed = true;
+        }
+    }
+    s.output.resize(produced);
+    return produced > 0;
+}
+
+qint64 GzipDevice::writeData(const char *data, qint64 maxSize)
+{
+    qint64 done = 0;
+    while (done < maxSize) {
+        uInt count = uInt(std::min(maxSize - done, qint64(UINT_MAX)));
+        d_stream->zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data + done));
+        d_stream->zs.avail_in = count;
+        if (!deflateInput(Z_NO_FLUSH))
+            return -1;
+        done += count;
+    }
+    return done;
+}
+
+bool GzipDevice::deflateInput(int flush)
+{
+    Stream &s = *d_stream;
+    int status;
+    do {
+        s.zs.next_out = reinterpret_cast<Bytef *>(s.compressed.data());
+        s.zs.avail_out = uInt(buffer_size);
+        status = deflate(&s.zs, flush);
+        if (status == Z_STREAM_ERROR)
+            return false;
+        qint64 produced = buffer_size - qint64(s.zs.avail_out);
+        if (produced > 0 && d_device->write(s.compressed.constData(), produced) != produced) {
+            setErrorString(d_device->errorString());
+            return false;
+        }
+    } while (s.zs.avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+    return true;
+}
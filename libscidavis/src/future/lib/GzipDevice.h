@@ -0,0 +1,92 @@
+/***************************************************************************
+    File                 : GzipDevice.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Read and write gzip-compressed data on the fly
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef GZIPDEVICE_H
+#define GZIPDEVICE_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <memory>
+
+//! Compresses data written to, and decompresses data read from, another device
+/**
+ * Data is passed through zlib in small blocks, so neither the compressed nor the uncompressed
+ * content ever has to be held in memory or in a temporary file as a whole.
+ *
+ * The device is either read-only or write-only. When reading, seek() is supported, but
+ * seeking backwards means decompressing again from the start of the file; this is meant for
+ * readers which make a second pass over the data. When writing, the gzip trailer is written
+ * by close(); the underlying device isn't closed and can thus be synced to disk afterwards.
+ *
+ * \code
+ * QFile file(fileName);
+ * file.open(QIODevice::WriteOnly);
+ * GzipDevice gzip(&file, 6);
+ * gzip.open(QIODevice::WriteOnly);
+ * QTextStream(&gzip) << text;
+ * gzip.close();
+ * \endcode
+ */
+class GzipDevice : public QIODevice
+{
+public:
+    //! Default compression level, used by minigzip for project files
+    static const int default_level = 9;
+
+    //! Wrap \c device, which must be opened in the same mode as this device
+    /**
+     * \param level zlib compression level from 1 (fastest) to 9 (smallest); ignored when reading
+     */
+    GzipDevice(QIODevice *device, int level = default_level, QObject *parent = nullptr);
+    ~GzipDevice();
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool seek(qint64 pos) override;
+    bool atEnd() const override;
+    //! The uncompressed size is not known in advance
+    qint64 size() const override { return pos(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    //! Deflate the pending input with the given flush mode and write the result
+    bool deflateInput(int flush);
+    //! Make sure decompressed data is available, unless the end of the stream is reached
+    bool fillOutput() const;
+
+    struct Stream;
+
+    QIODevice *d_device;
+    int d_level;
+    std::unique_ptr<Stream> d_stream;
+};
+
+#endif // ifndef GZIPDEVICE_H
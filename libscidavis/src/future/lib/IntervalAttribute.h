@@ -32,6 +32,9 @@
 
 #include "Interval.h"
 #include <QList>
+#include <QVector>
+
+#include <algorithm>
 
 //! A class representing an interval-based attribute
 template<class T>
@@ -181,12 +184,31 @@ private:
 };
 
 //! A class representing an interval-based attribute (bool version)
+/**
+ * The set rows are kept as a list of intervals sorted by their start, which neither intersect nor
+ * touch each other. This allows for answering isSet() by binary search, which matters for
+ * columns with many scattered invalid or masked cells.
+ */
 template<>
 class IntervalAttribute<bool>
 {
 public:
     IntervalAttribute<bool>() { }
-    IntervalAttribute<bool>(QList<Interval<int>> intervals) : d_intervals(intervals) { }
+    IntervalAttribute<bool>(QList<Interval<int>> intervals)
+    {
+        std::sort(intervals.begin(), intervals.end(),
+                  [](const Interval<int> &a, const Interval<int> &b) {
+                      return a.start() < b.start();
+                  });
+        foreach (Interval<int> iv, intervals) {
+            if (!iv.isValid())
+                continue;
+            if (!d_intervals.isEmpty() && d_intervals.last().end() >= iv.start() - 1)
+                d_intervals.last().setEnd(qMax(d_intervals.last().end(), iv.end()));
+            else
+                d_intervals.append(iv);
+        }
+    }
     IntervalAttribute<bool>(const IntervalAttribute<bool> &other)
     {
         d_intervals.clear();
@@ -203,14 +225,31 @@ public:
 
     void setValue(Interval<int> i, bool value = true)
     {
+        if (!i.isValid())
+            return;
         if (value) {
-            foreach (Interval<int> iv, d_intervals)
-                if (iv.contains(i))
-                    return;
-
-            Interval<int>::mergeIntervalIntoList(&d_intervals, i);
+            // replace all intervals intersecting or touching i by their union with i
+            int first = firstEndingAtOrAfter(i.start() - 1);
+            int last = firstStartingAfter(i.end() + 1);
+            if (first < last) {
+                i.setStart(qMin(i.start(), d_intervals.at(first).start()));
+                i.setEnd(qMax(i.end(), d_intervals.at(last - 1).end()));
+                d_intervals.erase(d_intervals.begin() + first, d_intervals.begin() + last);
+            }
+            d_intervals.insert(first, i);
         } else { // unset
-            Interval<int>::subtractIntervalFromList(&d_intervals, i);
+            // replace all intervals intersecting i by what is left of them
+            int first = firstEndingAtOrAfter(i.start());
+            int last = firstStartingAfter(i.end());
+            if (first >= last)
+                return;
+            Interval<int> left(d_intervals.at(first).start(), i.start() - 1);
+            Interval<int> right(i.end() + 1, d_intervals.at(last - 1).end());
+            d_intervals.erase(d_intervals.begin() + first, d_intervals.begin() + last);
+            if (right.isValid())
+                d_intervals.insert(first, right);
+            if (left.isValid())
+                d_intervals.insert(first, left);
         }
     }
 
@@ -218,66 +257,86 @@ public:
 
     bool isSet(int row) const
     {
-        foreach (Interval<int> iv, d_intervals)
-            if (iv.contains(row))
-                return true;
-        return false;
+        int c = firstStartingAfter(row) - 1;
+        return c >= 0 && d_intervals.at(c).contains(row);
     }
 
     bool isSet(Interval<int> i) const
     {
-        foreach (Interval<int> iv, d_intervals)
-            if (iv.contains(i))
-                return true;
-        return false;
+        int c = firstStartingAfter(i.start()) - 1;
+        return c >= 0 && d_intervals.at(c).contains(i);
+    }
+
+    //! Return for each of the rows first .. first+count-1 whether it is set
+    /**
+     * This is considerably faster than calling isSet() for each row, so use it when looking
+     * at a whole block of rows anyway.
+     */
+    QVector<bool> bitmap(int first, int count) const
+    {
+        QVector<bool> result(qMax(count, 0), false);
+        for (int c = qMax(firstStartingAfter(first) - 1, 0);
+             c < d_intervals.size() && d_intervals.at(c).start() < first + count; c++) {
+            int from = qMax(d_intervals.at(c).start(), first);
+            int to = qMin(d_intervals.at(c).end(), first + count - 1);
+            for (int row = from; row <= to; row++)
+                result[row - first] = true;
+        }
+        return result;
     }
 
     void insertRows(int before, int count)
     {
-        QList<Interval<int>> temp_list;
-        int c;
-        // first: split all intervals that contain 'before'
-        for (c = 0; c < d_intervals.size(); c++) {
-            if (d_intervals.at(c).contains(before)) {
-                temp_list = Interval<int>::split(d_intervals.at(c), before);
-                d_intervals.replace(c, temp_list.at(0));
-                if (temp_list.size() > 1)
-                    d_intervals.insert(c++, temp_list.at(1));
-            }
+        int c = firstStartingAfter(before - 1);
+        // first: split the interval that contains 'before'
+        if (c > 0 && d_intervals.at(c - 1).end() >= before) {
+            d_intervals.insert(c, Interval<int>(before, d_intervals.at(c - 1).end()));
+            d_intervals[c - 1].setEnd(before - 1);
         }
         // second: translate all intervals that start at 'before' or later
-        for (c = 0; c < d_intervals.size(); c++) {
-            if (d_intervals.at(c).start() >= before)
-                d_intervals[c].translate(count);
-        }
+        for (; c < d_intervals.size(); c++)
+            d_intervals[c].translate(count);
     }
 
     void removeRows(int first, int count)
     {
-        int c;
+        if (count <= 0)
+            return;
         // first: remove the relevant rows from all intervals
-        Interval<int>::subtractIntervalFromList(&d_intervals,
-                                                Interval<int>(first, first + count - 1));
+        setValue(Interval<int>(first, first + count - 1), false);
         // second: translate all intervals that start at 'first+count' or later
-        for (c = 0; c < d_intervals.size(); c++) {
-            if (d_intervals.at(c).start() >= first + count)
-                d_intervals[c].translate(-count);
-        }
-        // third: merge as many intervals as possible
-        for (c = d_intervals.size() - 1; c >= 0; c--) {
-            Interval<int> iv = d_intervals.takeAt(c);
-            int size_before = d_intervals.size();
-            Interval<int>::mergeIntervalIntoList(&d_intervals, iv);
-            if (size_before == d_intervals.size()) // merge successful
-                c--;
+        int c = firstStartingAfter(first - 1);
+        for (int cc = c; cc < d_intervals.size(); cc++)
+            d_intervals[cc].translate(-count);
+        // third: merge the intervals which touch now
+        if (c > 0 && c < d_intervals.size()
+            && d_intervals.at(c - 1).end() + 1 == d_intervals.at(c).start()) {
+            d_intervals[c - 1].setEnd(d_intervals.at(c).end());
+            d_intervals.removeAt(c);
         }
     }
 
+    //! Return the set intervals, sorted by their start
     QList<Interval<int>> intervals() const { return d_intervals; }
 
     void clear() { d_intervals.clear(); }
 
 private:
+    //! Index of the first interval starting after row (or the number of intervals)
+    int firstStartingAfter(int row) const
+    {
+        return std::upper_bound(d_intervals.begin(), d_intervals.end(), row,
+                                [](int r, const Interval<int> &iv) { return r < iv.start(); })
+                - d_intervals.begin();
+    }
+    //! Index of the first interval ending at or after row (or the number of intervals)
+    int firstEndingAtOrAfter(int row) const
+    {
+        return std::lower_bound(d_intervals.begin(), d_intervals.end(), row,
+                                [](const Interval<int> &iv, int r) { return iv.end() < r; })
+                - d_intervals.begin();
+    }
+
     QList<Interval<int>> d_intervals;
 };
 
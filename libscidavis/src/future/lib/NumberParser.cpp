@@ -0,0 +1,117 @@
+/***************************************************************************
+    File                 : NumberParser.cpp
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Fast locale-aware conversion of text to numbers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/NumberParser.h"
+
+#include <QByteArray>
+
+#include <charconv>
+#include <string>
+
+namespace {
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+//! Parse a number in C locale format, which must fill all of [begin, end)
+bool parseC(const char *begin, const char *end, double &value)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    bool ok;
+    value = QByteArray::fromRawData(begin, int(end - begin)).toDouble(&ok);
+    return ok;
+#endif
+}
+} // namespace
+
+NumberParser::NumberParser(const QLocale &locale)
+{
+    QString decimal_point = locale.decimalPoint();
+    QString group_separator = locale.groupSeparator();
+    d_decimal_point = decimal_point.size() == 1 ? decimal_point.at(0).toLatin1() : '.';
+    if (!d_decimal_point)
+        d_decimal_point = '.';
+    d_group_separator = group_separator.size() == 1 ? group_separator.at(0).toLatin1() : 0;
+    if ((locale.numberOptions() & QLocale::RejectGroupSeparator)
+        || d_group_separator == d_decimal_point)
+        d_group_separator = 0;
+}
+
+bool NumberParser::parse(const char *begin, const char *end, double &value) const
+{
+    while (begin < end && isSpace(*begin))
+        begin++;
+    while (end > begin && isSpace(end[-1]))
+        end--;
+    if (begin < end && *begin == '+') {
+        begin++;
+        if (begin < end && *begin == '-')
+            return false;
+    }
+    if (begin == end)
+        return false;
+    if (d_decimal_point == '.' && !d_group_separator)
+        return parseC(begin, end, value);
+
+    // translate to C locale format; numbers normally fit into the buffer on the stack
+    char short_buffer[64];
+    std::string long_buffer;
+    char *out = short_buffer;
+    if (end - begin > int(sizeof(short_buffer))) {
+        long_buffer.resize(end - begin);
+        out = &long_buffer[0];
+    }
+    const char *translated = out;
+    bool after_point = false;
+    for (const char *p = begin; p < end; p++) {
+        if (*p == d_group_separator) {
+            // group separators are only allowed between groups of three digits
+            if (after_point || p == begin || !isDigit(p[-1]) || end - p < 4 || !isDigit(p[1])
+                || !isDigit(p[2]) || !isDigit(p[3]) || (end - p > 4 && isDigit(p[4])))
+                return false;
+        } else if (*p == d_decimal_point) {
+            *out++ = '.';
+            after_point = true;
+        } else if (*p == '.') {
+            return false;
+        } else {
+            if (*p == 'e' || *p == 'E')
+                after_point = true;
+            *out++ = *p;
+        }
+    }
+    return parseC(translated, out, value);
+}
@@ -0,0 +1,55 @@
+/***************************************************************************
+    File                 : NumberParser.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Fast locale-aware conversion of text to numbers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NUMBERPARSER_H
+#define NUMBERPARSER_H
+
+#include <QLocale>
+
+//! Converts numbers in the format of a QLocale from 8 bit text to double
+/**
+ * This accepts what QLocale::toDouble() accepts for the usual locales (digits, the locale's
+ * decimal point and group separator, an exponent, "inf" and "nan", surrounding white space), but
+ * works on raw bytes without creating a QString for each number, and can be used from several
+ * threads at once. Only locales whose decimal point and group separator are single Latin-1
+ * characters are supported properly; for others, the C locale format is used.
+ */
+class NumberParser
+{
+public:
+    explicit NumberParser(const QLocale &locale = QLocale::c());
+
+    //! Parse the text between \c begin and \c end; return false if it isn't a number
+    bool parse(const char *begin, const char *end, double &value) const;
+
+private:
+    char d_decimal_point;
+    //! Group separator, or 0 if group separators are rejected
+    char d_group_separator;
+};
+
+#endif // ifndef NUMBERPARSER_H
@@ -0,0 +1,162 @@
+/***************************************************************************
+    File                 : ParallelFor.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Split loops over an index range among threads
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ParallelForDetail {
+//! Tells whether the current thread is running a chunk of a parallelFor() loop.
+inline bool &insideChunk()
+{
+    static thread_local bool inside = false;
+    return inside;
+}
+
+//! State of one parallelFor() call, shared with the pool tasks helping with it.
+/**
+ * Pool tasks may start only after the loop is over (when the calling thread has done all the
+ * work itself); they then find no chunk left and never touch \c run, which refers to the caller's
+ * stack.
+ */
+struct Loop
+{
+    std::function<void(int)> run;
+    int chunks = 0;
+    std::atomic<int> next{ 0 };
+    std::mutex mutex;
+    std::condition_variable finished;
+    int done = 0;
+
+    //! Runs chunks until none are left to claim.
+    void work()
+    {
+        bool &inside = insideChunk();
+        bool outer = inside;
+        inside = true;
+        for (int chunk = next++; chunk < chunks; chunk = next++) {
+            run(chunk);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++done == chunks)
+                finished.notify_all();
+        }
+        inside = outer;
+    }
+};
+
+class Task : public QRunnable
+{
+public:
+    explicit Task(const std::shared_ptr<Loop> &loop) : d_loop(loop) { }
+    void run() override { d_loop->work(); }
+
+private:
+    std::shared_ptr<Loop> d_loop;
+};
+} // namespace ParallelForDetail
+
+//! Return the number of threads worth using for CPU-bound work.
+inline int idealThreadCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+//! Return how many chunks to split a loop of \c count iterations into.
+/**
+ * This is one chunk per core, but no chunk gets less than \c minChunk iterations, so that small
+ * loops don't pay for handing work to other threads. Within a chunk of another parallelFor()
+ * loop, all cores are busy already, so this is 1.
+ */
+inline int parallelChunks(int count, int minChunk)
+{
+    if (ParallelForDetail::insideChunk())
+        return 1;
+    return std::max(1, std::min(idealThreadCount(), count / std::max(1, minChunk)));
+}
+
+//! Call \c body(chunk, chunkBegin, chunkEnd) for \c chunks contiguous parts of [begin, end).
+/**
+ * The chunks are shared out between the calling thread and QThreadPool::globalInstance(), whose
+ * threads are reused from one call to the next; the function returns when all chunks are done.
+ * Loops nested in a chunk are run serially in the thread of the chunk, so they don't multiply the
+ * number of threads. Since the chunk index is passed along, callers can give each chunk its own
+ * state (e.g. a Script instance). If \c body throws, the first exception (in chunk order) is
+ * rethrown in the calling thread after all chunks are finished.
+ *
+ * Beware that QObjects must not be created in \c body with a parent living in another thread and
+ * that GUI classes can't be used there at all.
+ */
+template<class Body>
+void parallelFor(int begin, int end, int chunks, Body body)
+{
+    int count = end - begin;
+    if (count <= 0)
+        return;
+    chunks = std::max(1, std::min(chunks, count));
+    auto chunkStart = [=](int chunk) {
+        return begin + static_cast<int>(static_cast<long long>(count) * chunk / chunks);
+    };
+    if (chunks == 1 || ParallelForDetail::insideChunk()) {
+        body(0, begin, end);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(chunks);
+    auto loop = std::make_shared<ParallelForDetail::Loop>();
+    loop->chunks = chunks;
+    loop->run = [&](int chunk) {
+        try {
+            body(chunk, chunkStart(chunk), chunkStart(chunk + 1));
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    for (int chunk = 1; chunk < chunks; chunk++)
+        QThreadPool::globalInstance()->start(new ParallelForDetail::Task(loop));
+    loop->work();
+    {
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->finished.wait(lock, [&]() { return loop->done == loop->chunks; });
+    }
+    for (auto &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+#endif // ifndef PARALLELFOR_H
@@ -0,0 +1,174 @@
+/***************************************************************************
+    File                 : UndoMemory.cpp
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Memory budget for data held by undo commands
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/UndoMemory.h"
+
+#include <QTemporaryFile>
+#include <QtDebug>
+
+#include <memory>
+
+namespace {
+qint64 g_budget = Q_INT64_C(512) * 1024 * 1024;
+qint64 g_usage = 0;
+qint64 g_disk_usage = 0;
+//! All clients, least recently used first
+std::list<UndoMemory::Client *> g_clients;
+std::unique_ptr<QTemporaryFile> g_file;
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////
+// class UndoMemory::Client
+///////////////////////////////////////////////////////////////////////////
+
+UndoMemory::Client::Client() : d_memory_usage(0), d_disk_offset(0), d_disk_size(0)
+{
+    d_position = g_clients.insert(g_clients.end(), this);
+}
+
+UndoMemory::Client::~Client()
+{
+    g_usage -= d_memory_usage;
+    discardDisk();
+    g_clients.erase(d_position);
+}
+
+void UndoMemory::Client::setMemoryUsage(qint64 bytes)
+{
+    g_usage += bytes - d_memory_usage;
+    d_memory_usage = bytes;
+    g_clients.splice(g_clients.end(), g_clients, d_position);
+    if (g_usage > g_budget)
+        UndoMemory::enforceBudget(this);
+}
+
+void UndoMemory::Client::writeToDisk(const QByteArray &data)
+{
+    discardDisk();
+    if (data.isEmpty())
+        return;
+    if (!g_file) {
+        g_file.reset(new QTemporaryFile());
+        if (!g_file->open()) {
+            qWarning() << "cannot create temporary file for undo data:" << g_file->errorString();
+            g_file.reset();
+            return;
+        }
+    }
+    // the file only ever grows while there is data on disk, so just append
+    qint64 offset = g_file->size();
+    if (!g_file->seek(offset) || g_file->write(data) != data.size()) {
+        qWarning() << "cannot write undo data to disk:" << g_file->errorString();
+        return;
+    }
+    d_disk_offset = offset;
+    d_disk_size = data.size();
+    g_disk_usage += d_disk_size;
+}
+
+QByteArray UndoMemory::Client::readFromDisk() const
+{
+    if (!isOnDisk() || !g_file || !g_file->seek(d_disk_offset))
+        return QByteArray();
+    return g_file->read(d_disk_size);
+}
+
+void UndoMemory::Client::discardDisk()
+{
+    if (!isOnDisk())
+        return;
+    g_disk_usage -= d_disk_size;
+    d_disk_size = 0;
+    // reclaim the space once nothing is left on disk
+    if (g_disk_usage == 0 && g_file)
+        g_file->resize(0);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// class UndoMemory::Payload
+///////////////////////////////////////////////////////////////////////////
+
+void UndoMemory::Payload::set(const QByteArray &data)
+{
+    discardDisk();
+    d_data = data.isEmpty() ? QByteArray() : qCompress(data, 1);
+    setMemoryUsage(d_data.size());
+}
+
+QByteArray UndoMemory::Payload::get() const
+{
+    if (isOnDisk())
+        return qUncompress(readFromDisk());
+    return d_data.isEmpty() ? QByteArray() : qUncompress(d_data);
+}
+
+void UndoMemory::Payload::spill()
+{
+    writeToDisk(d_data);
+    if (isOnDisk())
+        d_data = QByteArray();
+}
+
+///////////////////////////////////////////////////////////////////////////
+// class UndoMemory
+///////////////////////////////////////////////////////////////////////////
+
+void UndoMemory::setBudget(qint64 bytes)
+{
+    g_budget = qMax(Q_INT64_C(0), bytes);
+    if (g_usage > g_budget)
+        enforceBudget(nullptr);
+}
+
+qint64 UndoMemory::budget()
+{
+    return g_budget;
+}
+
+qint64 UndoMemory::usage()
+{
+    return g_usage;
+}
+
+qint64 UndoMemory::diskUsage()
+{
+    return g_disk_usage;
+}
+
+void UndoMemory::enforceBudget(Client *keep)
+{
+    for (auto it = g_clients.begin(); it != g_clients.end() && g_usage > g_budget;) {
+        Client *client = *it++;
+        if (client == keep || client->d_memory_usage == 0)
+            continue;
+        client->spill();
+        if (client->isOnDisk()) {
+            g_usage -= client->d_memory_usage;
+            client->d_memory_usage = 0;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+    File                 : UndoMemory.h
+    Project              : SciDAVis
+    --------------------------------------------------------------------
+    Description          : Memory budget for data held by undo commands
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef UNDOMEMORY_H
+#define UNDOMEMORY_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+#include <list>
+
+//! Keeps the memory used by the undo history within a budget
+/**
+ * Undo commands which have to keep large amounts of data around (like the previous content of a
+ * column) hold it in a Client. All clients together may use up to budget() bytes of memory; when
+ * a client grows beyond that, the data of the clients which were least recently used is moved to
+ * a temporary file on disk and read back from there when it is needed again.
+ *
+ * Like the undo stack itself, this must only be used from the GUI thread.
+ */
+class UndoMemory
+{
+public:
+    //! Data held by an undo command that can be moved to disk
+    class Client
+    {
+    public:
+        Client();
+        Client(const Client &) = delete;
+        Client &operator=(const Client &) = delete;
+        virtual ~Client();
+
+        //! Return the number of bytes kept in memory
+        qint64 memoryUsage() const { return d_memory_usage; }
+        //! Return whether the data has been moved to disk
+        bool isOnDisk() const { return d_disk_size > 0; }
+
+    protected:
+        //! Report a change of memoryUsage(), possibly moving older clients to disk
+        void setMemoryUsage(qint64 bytes);
+        //! Move the data to disk using writeToDisk() and free the memory
+        /**
+         * Called by UndoMemory, which takes care of setting memoryUsage() to zero if the data was
+         * written; don't call setMemoryUsage() from here.
+         */
+        virtual void spill() = 0;
+
+        //! Store \c data in the temporary file, replacing anything stored before by this client
+        void writeToDisk(const QByteArray &data);
+        //! Read back what was last stored by writeToDisk()
+        QByteArray readFromDisk() const;
+        //! Forget about data on disk
+        void discardDisk();
+
+    private:
+        qint64 d_memory_usage;
+        qint64 d_disk_offset;
+        qint64 d_disk_size;
+        //! Position in the list of clients, ordered by last use
+        std::list<Client *>::iterator d_position;
+
+        friend class UndoMemory;
+    };
+
+    //! A block of bytes, compressed and kept either in memory or on disk
+    class Payload : public Client
+    {
+    public:
+        void set(const QByteArray &data);
+        QByteArray get() const;
+        void clear() { set(QByteArray()); }
+
+    protected:
+        void spill() override;
+
+    private:
+        QByteArray d_data;
+    };
+
+    //! Set the number of bytes clients may keep in memory
+    static void setBudget(qint64 bytes);
+    static qint64 budget();
+    //! Return the number of bytes all clients keep in memory
+    static qint64 usage();
+    //! Return the number of bytes all clients have moved to disk
+    static qint64 diskUsage();
+
+private:
+    //! Spill clients (except \c keep) until usage() fits into budget()
+    static void enforceBudget(Client *keep);
+};
+
+#endif // ifndef UNDOMEMORY_H
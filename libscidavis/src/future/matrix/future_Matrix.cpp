@@ -33,7 +33,9 @@
 #include "core/future_Folder.h"
 #include "matrixcommands.h"
 #include "lib/ActionManager.h"
+#include "lib/BinaryData.h"
 #include "lib/XmlStreamReader.h"
+#include "ApplicationWindow.h"
 
 #include <QtCore>
 #include <QtGui>
@@ -897,6 +899,24 @@ void Matrix::goToCell()
     d_view->goToCell(row - 1, col - 1);
 }
 
+Matrix *Matrix::snapshot() const
+{
+    // postponed XML is saved as is, unless it has been renamed or commented on since
+    if (hasPendingData() && !pendingDataIsCurrent())
+        const_cast<Matrix *>(this)->loadPendingData();
+    Matrix *result = new Matrix(0, 0, 0, name());
+    result->setCreationTime(creationTime());
+    result->setCaptionSpec(captionSpec());
+    result->setComment(comment());
+    if (hasPendingData())
+        copyPendingData(result);
+    else {
+        delete result->d_matrix_private;
+        result->d_matrix_private = new Private(*d_matrix_private, result);
+    }
+    return result;
+}
+
 void Matrix::copy(Matrix *other)
 {
     WAIT_CURSOR;
@@ -962,6 +982,7 @@ void Matrix::setCell(int row, int col, double value)
 void Matrix::setCells(const QVector<qreal> &data)
 {
     d_matrix_private->setCells(data);
+    countModification();
 }
 
 void Matrix::dimensionsDialog()
@@ -1163,6 +1184,14 @@ int Matrix::displayedDigits() const
 
 void Matrix::save(QXmlStreamWriter *writer) const
 {
+    auto &settings = ApplicationWindow::getSettings();
+    save(writer, settings.value("/General/BinaryProjectData", false).toBool());
+}
+
+void Matrix::save(QXmlStreamWriter *writer, bool binary_data) const
+{
+    // saving needs the whole content, even if it hasn't been looked at yet
+    const_cast<Matrix *>(this)->loadPendingData();
     int cols = columnCount();
     int rows = rowCount();
     writer->writeStartElement("matrix");
@@ -1184,14 +1213,25 @@ void Matrix::save(QXmlStreamWriter *writer) const
     writer->writeAttribute("y_end", QString::number(yEnd()));
     writer->writeEndElement();
 
-    for (int col = 0; col < cols; col++)
-        for (int row = 0; row < rows; row++) {
-            writer->writeStartElement("cell");
-            writer->writeAttribute("row", QString::number(row));
+    if (binary_data) {
+        for (int col = 0; col < cols && rows > 0; col++) {
+            QVector<double> values = d_matrix_private->columnCells(col, 0, rows - 1);
+            writer->writeStartElement("column_data");
             writer->writeAttribute("column", QString::number(col));
-            writer->writeCharacters(QString::number(cell(row, col), 'e', 16));
+            writer->writeAttribute("encoding", "base64");
+            writer->writeCharacters(
+                    QString::fromLatin1(encodeDoubles(values.constData(), values.size())));
             writer->writeEndElement();
         }
+    } else
+        for (int col = 0; col < cols; col++)
+            for (int row = 0; row < rows; row++) {
+                writer->writeStartElement("cell");
+                writer->writeAttribute("row", QString::number(row));
+                writer->writeAttribute("column", QString::number(col));
+                writer->writeCharacters(QString::number(cell(row, col), 'e', 16));
+                writer->writeEndElement();
+            }
     for (int col = 0; col < cols; col++) {
         writer->writeStartElement("column_width");
         writer->writeAttribute("column", QString::number(col));
@@ -1251,6 +1291,8 @@ bool Matrix::load(XmlStreamReader *reader)
                     ret_val = readCoordinatesElement(reader);
                 else if (reader->name() == "cell")
                     ret_val = readCellElement(reader);
+                else if (reader->name() == "column_data")
+                    ret_val = readColumnDataElement(reader);
                 else if (reader->name() == "row_height")
                     ret_val = readRowHeightElement(reader);
                 else if (reader->name() == "column_width")
@@ -1266,6 +1308,8 @@ bool Matrix::load(XmlStreamReader *reader)
             }
         }
         d_matrix_private->blockChangeSignals(false);
+        if (rowCount() > 0 && columnCount() > 0)
+            emit dataChanged(0, 0, rowCount() - 1, columnCount() - 1);
     } else // no matrix element
         reader->raiseError(tr("no matrix element found"));
 
@@ -1414,7 +1458,38 @@ bool Matrix::readCellElement(XmlStreamReader *reader)
         reader->raiseError(tr("invalid cell value"));
         return false;
     }
-    setCell(row, col, value);
+    // like setCell(), but without creating an undo command for each cell
+    if (row >= 0 && row < rowCount() && col >= 0 && col < columnCount())
+        d_matrix_private->setCell(row, col, value);
+
+    return true;
+}
+
+bool Matrix::readColumnDataElement(XmlStreamReader *reader)
+{
+    Q_ASSERT(reader->isStartElement() && reader->name() == "column_data");
+
+    bool ok;
+    int col = reader->readAttributeInt("column", &ok);
+    if (!ok || col < 0 || col >= columnCount()) {
+        reader->raiseError(tr("invalid or missing column index"));
+        return false;
+    }
+    QString encoding = reader->attributes()
+                               .value(reader->namespaceUri().toString(), "encoding")
+                               .toString();
+    if (encoding != "base64") {
+        reader->raiseError(tr("invalid or missing encoding"));
+        return false;
+    }
+
+    QVector<double> values;
+    if (!decodeDoubles(reader->readElementText(), rowCount(), values)) {
+        reader->raiseError(tr("invalid binary data"));
+        return false;
+    }
+    if (rowCount() > 0)
+        d_matrix_private->setColumnCells(col, 0, rowCount() - 1, values);
 
     return true;
 }
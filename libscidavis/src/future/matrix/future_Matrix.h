@@ -179,10 +179,21 @@ public:
     void setNumericFormat(char format);
     void setDisplayedDigits(int digits);
 
+    //! Return a new matrix with the same content
+    /**
+     * The cells are implicitly shared and only copied once they are modified, so the snapshot can
+     * be saved from another thread while the user goes on working with this matrix. Pending data
+     * (see AbstractPart::setPendingData()) is copied without being loaded, and
+     * Matrix::saveToDevice() writes it without parsing it.
+     */
+    Matrix *snapshot() const;
+
     //! \name serialize/deserialize
     //@{
     //! Save as XML
     virtual void save(QXmlStreamWriter *) const;
+    //! Save as XML, with the cells either base64 encoded or as text
+    void save(QXmlStreamWriter *writer, bool binary_data) const;
     //! Load from XML
     virtual bool load(XmlStreamReader *);
     //@}
@@ -310,6 +321,8 @@ private:
     bool readFormulaElement(XmlStreamReader *reader);
     //! Read XML cell element
     bool readCellElement(XmlStreamReader *reader);
+    //! Read XML element with the binary data of a whole column
+    bool readColumnDataElement(XmlStreamReader *reader);
     bool readRowHeightElement(XmlStreamReader *reader);
     bool readColumnWidthElement(XmlStreamReader *reader);
 
@@ -377,6 +390,8 @@ class Matrix::Private
 {
 public:
     Private(Matrix *owner);
+    //! Copy the content of \c other for a different owner, see Matrix::snapshot()
+    Private(const Private &other, Matrix *owner) : Private(other) { d_owner = owner; }
     //! Insert columns before column number 'before'
     /**
      * If 'first' is equal to the current number of columns,
@@ -30,16 +30,22 @@
 #include "table/AsciiTableImportFilter.h"
 #include "table/future_Table.h"
 #include "lib/IntervalAttribute.h"
+#include "lib/NumberParser.h"
+#include "lib/ParallelFor.h"
 #include "core/column/Column.h"
-#include "core/datatypes/String2DoubleFilter.h"
+#include "core/datatypes/DateTime2StringFilter.h"
 
-#include <QTextStream>
+#include <QDateTime>
+#include <QFile>
 #include <QStringList>
 #include <QLocale>
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <string>
 #include <vector>
-#include <iostream>
-using namespace std;
 
 QStringList AsciiTableImportFilter::fileExtensions() const
 {
@@ -49,137 +55,423 @@ QStringList AsciiTableImportFilter::fileExtensions() const
 }
 
 namespace {
-// redirect to QIODevice's readLine so that we can override it to handle '\r' line terminators
-struct SciDaVisTextStream
-{
-    QIODevice &input;
-    bool good;
-    operator bool() const { return good; }
-    enum { none, simplify, trim } whiteSpaceTreatment;
-    QString separator;
-    SciDaVisTextStream(QIODevice &inp, const QString &sep)
-        : input(inp), good(true), whiteSpaceTreatment(none), separator(sep)
+//! A part of the input, delimited by pointers into it
+struct Field
+{
+    const char *begin;
+    const char *end;
+};
+
+//! Like QChar::isSpace(), for Latin-1 characters
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r') || uchar(c) == 0x85 || uchar(c) == 0xa0;
+}
+
+//! Return the position of the terminator of the line starting at \c pos (or \c end)
+inline const char *lineEnd(const char *pos, const char *end)
+{
+    while (pos < end && *pos != '\n' && *pos != '\r')
+        pos++;
+    return pos;
+}
+
+//! Return the start of the line following the terminator at \c pos
+/**
+ * Lines may be terminated by "\n", "\r" or "\r\n".
+ */
+inline const char *nextLine(const char *pos, const char *end)
+{
+    if (pos < end && *pos++ == '\r' && pos < end && *pos == '\n')
+        pos++;
+    return pos;
+}
+
+//! Splits lines into fields
+class RowSplitter
+{
+public:
+    enum WhiteSpaceTreatment { none, simplify, trim };
+
+    RowSplitter(const QString &separator, WhiteSpaceTreatment whiteSpaceTreatment)
+        : d_separator(separator.toLatin1()), d_white_space_treatment(whiteSpaceTreatment)
     {
     }
 
-    QStringList readRow()
+    //! Split the line between \c begin and \c end, like QString::split() would
+    const std::vector<Field> &split(const char *begin, const char *end)
     {
-        char c;
-        QString r;
-
-        while ((good = input.getChar(&c)))
-            switch (c) {
-            case '\r':
-                if (input.getChar(&c) && c != '\n') // eat \n following \r
-                    input.ungetChar(c);
-                goto breakLoop;
-            case '\n':
-                goto breakLoop;
-            default:
-                r += c;
-            };
-    breakLoop:
-        switch (whiteSpaceTreatment) {
-        case none:
-            return r.split(separator);
-        case simplify:
-            return r.simplified().split(separator);
-        case trim:
-            return r.trimmed().split(separator);
-        default:
-            return QStringList();
+        if (d_white_space_treatment != none) {
+            while (begin < end && isSpace(*begin))
+                begin++;
+            while (end > begin && isSpace(end[-1]))
+                end--;
+        }
+        if (d_white_space_treatment == simplify) {
+            d_simplified.clear();
+            for (const char *p = begin; p < end; p++)
+                if (!isSpace(*p))
+                    d_simplified += *p;
+                else if (!isSpace(p[-1])) // p > begin, since begin isn't a space
+                    d_simplified += ' ';
+            begin = d_simplified.data();
+            end = begin + d_simplified.size();
         }
+
+        d_fields.clear();
+        const char *start = begin;
+        int length = d_separator.size();
+        if (length == 1) {
+            const char *p;
+            while ((p = static_cast<const char *>(
+                            std::memchr(start, d_separator.at(0), end - start)))) {
+                d_fields.push_back(Field{ start, p });
+                start = p + 1;
+            }
+        } else if (length > 1) {
+            for (const char *p = start; end - p >= length;)
+                if (std::memcmp(p, d_separator.constData(), length) == 0) {
+                    d_fields.push_back(Field{ start, p });
+                    start = p += length;
+                } else
+                    p++;
+        }
+        d_fields.push_back(Field{ start, end });
+        return d_fields;
     }
+
+private:
+    QByteArray d_separator;
+    WhiteSpaceTreatment d_white_space_treatment;
+    std::string d_simplified;
+    std::vector<Field> d_fields;
 };
 
-template<class C>
-C conv(const QString &x);
-template<>
-QString conv<QString>(const QString &x)
+//! How to read a column
+struct ColumnType
 {
-    return x;
-}
-template<>
-qreal conv<qreal>(const QString &x)
+    SciDAVis::ColumnMode mode;
+    //! Date/time format for DateTime columns
+    QString format;
+};
+
+//! Data of one column read from a chunk of the input
+struct ColumnBuffer
 {
-    return (qreal)(QLocale().toDouble(x));
-}
+    QVector<qreal> values;
+    QStringList texts;
+    QList<QDateTime> date_times;
+    //! Rows (relative to the chunk) which could not be read
+    std::vector<int> invalid;
 
-template<class T>
-struct AP : public std::unique_ptr<T>
+    //! Append the content of \c field, returning false if it can't be read as \c type
+    bool append(const Field &field, const ColumnType &type, const NumberParser &parser)
+    {
+        switch (type.mode) {
+        case SciDAVis::ColumnMode::Numeric: {
+            double value;
+            bool ok = parser.parse(field.begin, field.end, value);
+            values << (ok ? value : 0.0);
+            return ok;
+        }
+        case SciDAVis::ColumnMode::DateTime:
+            date_times << QDateTime::fromString(
+                    QString::fromLatin1(field.begin, int(field.end - field.begin)).trimmed(),
+                    type.format);
+            return date_times.last().isValid();
+        default:
+            texts << QString::fromLatin1(field.begin, int(field.end - field.begin));
+            return true;
+        }
+    }
+
+    void appendEmpty(const ColumnType &type)
+    {
+        switch (type.mode) {
+        case SciDAVis::ColumnMode::Numeric:
+            values << 0.0;
+            break;
+        case SciDAVis::ColumnMode::DateTime:
+            date_times << QDateTime();
+            break;
+        default:
+            texts << QString();
+            break;
+        }
+    }
+};
+
+//! Data read from one chunk of the input
+struct Chunk
 {
-    AP() : std::unique_ptr<T>(new T) { }
-    AP(const AP &x) : std::unique_ptr<T>(new T(*x)) { }
+    int rows = 0;
+    std::vector<ColumnBuffer> columns;
 };
 
+//! Read the lines between \c begin and \c end, which are part of an input ending at \c inputEnd
+void readChunk(Chunk &chunk, const char *begin, const char *end, const char *inputEnd,
+               RowSplitter &splitter, const NumberParser &parser,
+               const QVector<ColumnType> &types)
+{
+    int columns = types.size();
+    chunk.columns.resize(columns);
+    for (const char *line = begin; line < end;) {
+        const char *line_end = lineEnd(line, inputEnd);
+        const std::vector<Field> &fields = splitter.split(line, line_end);
+        // an empty last line without terminator doesn't count
+        bool skip = line_end == inputEnd && fields.size() == 1
+                && fields[0].begin == fields[0].end;
+        line = nextLine(line_end, inputEnd);
+        if (skip)
+            continue;
+
+        int i;
+        // rows with too many columns are cut off, those with too few filled with invalid cells
+        for (i = 0; i < int(fields.size()) && i < columns; i++)
+            if (!chunk.columns[i].append(fields[i], types.at(i), parser))
+                chunk.columns[i].invalid.push_back(chunk.rows);
+        for (; i < columns; i++) {
+            chunk.columns[i].appendEmpty(types.at(i));
+            chunk.columns[i].invalid.push_back(chunk.rows);
+        }
+        chunk.rows++;
+    }
+}
+
+//! Concatenate the data of column \c i from all chunks
 template<class C>
-void readCols(QList<Column *> &cols, SciDaVisTextStream &stream, bool readColNames)
+std::unique_ptr<C> collect(std::vector<Chunk> &chunks, int i, C ColumnBuffer::*member, int rows)
 {
-    QStringList row, column_names;
-    int i;
+    std::unique_ptr<C> data(new C());
+    data->reserve(rows);
+    for (Chunk &chunk : chunks) {
+        *data += chunk.columns[i].*member;
+        chunk.columns[i].*member = C();
+    }
+    return data;
+}
 
-    // read first row
-    row = stream.readRow();
+//! Read the lines from \c begin to \c end on as many threads as it is worth
+std::vector<Chunk> readChunks(const char *begin, const char *end,
+                              const QVector<ColumnType> &types, const RowSplitter &splitter,
+                              const NumberParser &parser)
+{
+    // split the input into chunks of at least 1 MB, starting at line boundaries
+    qint64 size = end - begin;
+    int chunk_count = parallelChunks(int(std::min<qint64>(size >> 16, INT_MAX)), 16);
+    std::vector<const char *> bounds(chunk_count + 1, end);
+    bounds[0] = begin;
+    for (int k = 1; k < chunk_count; k++) {
+        const char *bound = begin + size * k / chunk_count;
+        bounds[k] = std::max(bounds[k - 1], nextLine(lineEnd(bound, end), end));
+    }
 
-    int dataSize = row.size();
-    vector<AP<C>> data(dataSize);
-    vector<IntervalAttribute<bool>> invalid_cells(row.size());
+    std::vector<Chunk> chunks(chunk_count);
+    parallelFor(0, chunk_count, chunk_count, [&](int, int first, int last) {
+        RowSplitter chunk_splitter(splitter);
+        for (int k = first; k < last; k++)
+            readChunk(chunks[k], bounds[k], bounds[k + 1], end, chunk_splitter, parser, types);
+    });
+    return chunks;
+}
 
-    if (readColNames)
-        column_names = row;
-    else
-        for (i = 0; i < row.size(); ++i) {
-            column_names << QString::number(i + 1);
-            *data[i] << conv<typename C::value_type>(row[i]);
+//! Number of rows looked at for guessing column types
+const int type_detection_rows = 100;
+
+//! Guess column types and the decimal separator from the first rows of the input
+/**
+ * A column becomes numeric if all its non-empty fields are numbers, date/time if they all match
+ * one of a few common date/time formats, and text otherwise. Besides the decimal separator of
+ * \c parser, the other one of point and comma is tried; whichever reads more fields as numbers
+ * replaces \c parser.
+ */
+QVector<ColumnType> detectTypes(const char *begin, const char *end, RowSplitter splitter,
+                                int columns, NumberParser &parser)
+{
+    static const QStringList date_time_formats = {
+        "yyyy-MM-ddThh:mm:ss.zzz", "yyyy-MM-ddThh:mm:ss", "yyyy-MM-dd hh:mm:ss.zzz",
+        "yyyy-MM-dd hh:mm:ss",     "yyyy-MM-dd hh:mm",    "yyyy-MM-dd",
+        "dd.MM.yyyy hh:mm:ss",     "dd.MM.yyyy hh:mm",    "dd.MM.yyyy",
+        "hh:mm:ss.zzz",            "hh:mm:ss",
+    };
+
+    // copy the fields, since splitting the next line may invalidate them
+    std::vector<std::vector<std::string>> sample(columns);
+    const char *line = begin;
+    for (int row = 0; row < type_detection_rows && line < end; row++) {
+        const char *line_end = lineEnd(line, end);
+        const std::vector<Field> &fields = splitter.split(line, line_end);
+        for (int i = 0; i < columns && i < int(fields.size()); i++) {
+            const char *field_begin = fields[i].begin, *field_end = fields[i].end;
+            while (field_begin < field_end && isSpace(*field_begin))
+                field_begin++;
+            if (field_begin < field_end)
+                sample[i].emplace_back(field_begin, field_end);
         }
+        line = nextLine(line_end, end);
+    }
 
-    // read rest of data
-    while (stream) {
-        row = stream.readRow();
-        if (stream || (row != QStringList(""))) {
-            for (i = 0; i < row.size() && i < dataSize; ++i)
-                *data[i] << conv<typename C::value_type>(row[i]);
-            // some rows might have too few columns (re-use value of i from above loop)
-            for (; i < dataSize; ++i) {
-                invalid_cells[i].setValue(data[i]->size(), true);
-                *data[i] << conv<typename C::value_type>("");
+    auto countNumbers = [&sample](const NumberParser &candidate, int column) {
+        int result = 0;
+        double value;
+        for (const std::string &field : sample[column])
+            if (candidate.parse(field.data(), field.data() + field.size(), value))
+                result++;
+        return result;
+    };
+    double value;
+    NumberParser alternative(parser.parse("1,5", "1,5" + 3, value) ? QLocale::c()
+                                                                   : QLocale(QLocale::German));
+    int numbers = 0, alternative_numbers = 0;
+    for (int i = 0; i < columns; i++) {
+        numbers += countNumbers(parser, i);
+        alternative_numbers += countNumbers(alternative, i);
+    }
+    if (alternative_numbers > numbers)
+        parser = alternative;
+
+    QVector<ColumnType> types(columns, ColumnType{ SciDAVis::ColumnMode::Text, QString() });
+    for (int i = 0; i < columns; i++) {
+        if (sample[i].empty())
+            continue;
+        if (countNumbers(parser, i) == int(sample[i].size())) {
+            types[i].mode = SciDAVis::ColumnMode::Numeric;
+            continue;
+        }
+        for (const QString &format : date_time_formats) {
+            bool all_valid = true;
+            for (const std::string &field : sample[i])
+                if (!QDateTime::fromString(QString::fromLatin1(field.data(), int(field.size()))
+                                                   .trimmed(),
+                                           format)
+                             .isValid()) {
+                    all_valid = false;
+                    break;
+                }
+            if (all_valid) {
+                types[i] = ColumnType{ SciDAVis::ColumnMode::DateTime, format };
+                break;
             }
         }
     }
+    return types;
+}
+
+}
+
+struct AsciiTableImportFilter::Data
+{
+    QStringList column_names;
+    QVector<ColumnType> types;
+    std::vector<Chunk> chunks;
+};
+
+QList<Column *> AsciiTableImportFilter::createColumns(Data &data)
+{
+    std::vector<Chunk> &chunks = data.chunks;
+    int rows = 0;
+    for (const Chunk &chunk : chunks)
+        rows += chunk.rows;
 
-    for (i = 0; i < dataSize; ++i) {
-        cols << new Column(std::move(column_names[i]), unique_ptr<C>(std::move(data[i])),
-                           std::move(invalid_cells[i]));
+    QList<Column *> cols;
+    for (int i = 0; i < data.types.size(); i++) {
+        IntervalAttribute<bool> invalid_cells;
+        int offset = 0;
+        for (const Chunk &chunk : chunks) {
+            for (int row : chunk.columns[i].invalid)
+                invalid_cells.setValue(offset + row, true);
+            offset += chunk.rows;
+        }
+
+        const QString &name = data.column_names.at(i);
+        switch (data.types.at(i).mode) {
+        case SciDAVis::ColumnMode::Numeric:
+            cols << new Column(name, collect(chunks, i, &ColumnBuffer::values, rows),
+                               invalid_cells);
+            break;
+        case SciDAVis::ColumnMode::DateTime:
+            cols << new Column(name, collect(chunks, i, &ColumnBuffer::date_times, rows),
+                               invalid_cells);
+            static_cast<DateTime2StringFilter *>(cols.back()->outputFilter())
+                    ->setFormat(data.types.at(i).format);
+            break;
+        default:
+            cols << new Column(name, collect(chunks, i, &ColumnBuffer::texts, rows),
+                               invalid_cells);
+            break;
+        }
         if (i == 0)
             cols.back()->setPlotDesignation(SciDAVis::X);
         else
             cols.back()->setPlotDesignation(SciDAVis::Y);
     }
+    return cols;
 }
 
+AbstractAspect *AsciiTableImportFilter::importAspect(QIODevice &input)
+{
+    std::shared_ptr<Data> data = read(input);
+    // renaming will be done by the kernel
+    future::Table *result = new future::Table(0, 0, tr("Table"));
+    result->appendColumns(createColumns(*data));
+    return result;
 }
 
-AbstractAspect *AsciiTableImportFilter::importAspect(QIODevice &input)
+std::shared_ptr<AsciiTableImportFilter::Data> AsciiTableImportFilter::read(QIODevice &input) const
 {
-    SciDaVisTextStream stream(input, d_separator);
-    if (d_simplify_whitespace)
-        stream.whiteSpaceTreatment = SciDaVisTextStream::simplify;
-    else if (d_trim_whitespace)
-        stream.whiteSpaceTreatment = SciDaVisTextStream::trim;
+    std::shared_ptr<Data> data(new Data());
+
+    // look at the whole input at once, mapping it into memory if possible
+    QByteArray buffer;
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    QFile *file = qobject_cast<QFile *>(&input);
+    qint64 mapped_size = file ? file->size() - file->pos() : 0;
+    uchar *mapped = mapped_size > 0 ? file->map(file->pos(), mapped_size) : nullptr;
+    if (mapped) {
+        begin = reinterpret_cast<const char *>(mapped);
+        end = begin + mapped_size;
+    } else {
+        buffer = input.readAll();
+        begin = buffer.constData();
+        end = begin + buffer.size();
+    }
+
+    RowSplitter splitter(d_separator,
+                         d_simplify_whitespace ? RowSplitter::simplify
+                                 : d_trim_whitespace ? RowSplitter::trim
+                                                     : RowSplitter::none);
+    NumberParser parser(d_numeric_locale);
 
     // skip ignored lines
+    const char *pos = begin;
     for (int i = 0; i < d_ignored_lines; i++)
-        stream.readRow();
+        pos = nextLine(lineEnd(pos, end), end);
 
-    // build a Table from the gathered data
-    QList<Column *> cols;
-    if (d_convert_to_numeric)
-        readCols<QVector<qreal>>(cols, stream, d_first_row_names_columns);
+    // the first row determines the number of columns
+    QStringList &column_names = data->column_names;
+    const char *first_row_end = lineEnd(pos, end);
+    const std::vector<Field> &first_row = splitter.split(pos, first_row_end);
+    for (int i = 0; i < int(first_row.size()); i++)
+        if (d_first_row_names_columns)
+            column_names << QString::fromLatin1(first_row[i].begin,
+                                                int(first_row[i].end - first_row[i].begin));
+        else
+            column_names << QString::number(i + 1);
+    if (d_first_row_names_columns)
+        pos = nextLine(first_row_end, end);
+
+    QVector<ColumnType> &types = data->types;
+    if (d_detect_column_types)
+        types = detectTypes(pos, end, splitter, column_names.size(), parser);
     else
-        readCols<QStringList>(cols, stream, d_first_row_names_columns);
+        types.fill(ColumnType{ d_convert_to_numeric ? SciDAVis::ColumnMode::Numeric
+                                                    : SciDAVis::ColumnMode::Text,
+                               QString() },
+                   column_names.size());
 
-    // renaming will be done by the kernel
-    future::Table *result = new future::Table(0, 0, tr("Table"));
-    result->appendColumns(cols);
-    return result;
+    data->chunks = readChunks(pos, end, types, splitter, parser);
+    if (mapped)
+        file->unmap(mapped);
+    return data;
 }
@@ -33,6 +33,10 @@
 #include "core/AbstractImportFilter.h"
 #include <QLocale>
 
+#include <memory>
+
+class Column;
+
 //! Import an ASCII file as Table.
 /**
  * This is a complete rewrite of equivalent functionality previously found in Table.
@@ -46,6 +50,13 @@
  * disabling this and (optionally) converting texts to other formats using Table's
  * type control tab.
  *
+ * The input is read in one go (memory-mapped where possible), split into chunks at line
+ * boundaries and parsed on several threads straight into the column data.
+ *
+ * With detect_column_types, the first rows are sampled to decide for each column whether it holds
+ * numbers, date/times or text, and whether numbers use a decimal point or a comma. Fields which
+ * later turn out not to match the type of their column are marked invalid.
+ *
  * TODO: port options GUI from ImportTableDialog
  */
 class AsciiTableImportFilter : public AbstractImportFilter
@@ -60,10 +71,19 @@ public:
           d_trim_whitespace(false),
           d_simplify_whitespace(false),
           d_convert_to_numeric(false),
+          d_detect_column_types(false),
           d_numeric_locale(QLocale::c())
     {
     }
     virtual AbstractAspect *importAspect(QIODevice &input);
+
+    //! Data read by read(), waiting to be turned into columns
+    struct Data;
+    //! Parse \c input without creating any QObjects, so that it can be done in a worker thread
+    std::shared_ptr<Data> read(QIODevice &input) const;
+    //! Create the columns for data returned by read(); must be done in the GUI thread
+    static QList<Column *> createColumns(Data &data);
+
     virtual QStringList fileExtensions() const;
     virtual QString name() const { return QObject::tr("ASCII table"); }
 
@@ -95,6 +115,10 @@ public:
     ACCESSOR(bool, convert_to_numeric);
     Q_PROPERTY(bool convert_to_numeric READ convert_to_numeric WRITE set_convert_to_numeric)
 
+    //! Guess column types from the data; overrides convert_to_numeric
+    ACCESSOR(bool, detect_column_types);
+    Q_PROPERTY(bool detect_column_types READ detect_column_types WRITE set_detect_column_types)
+
     ACCESSOR(QLocale, numeric_locale);
     Q_PROPERTY(QLocale numeric_locale READ numeric_locale WRITE set_numeric_locale)
 
@@ -105,6 +129,7 @@ private:
     bool d_trim_whitespace;
     bool d_simplify_whitespace;
     bool d_convert_to_numeric;
+    bool d_detect_column_types;
     QLocale d_numeric_locale;
 };
 
@@ -1908,6 +1908,29 @@ void Table::moveColumn(int from, int to)
     endMacro();
 }
 
+Table *Table::snapshot() const
+{
+    // postponed XML is saved as is, unless it has been renamed or commented on since
+    if (hasPendingData() && !pendingDataIsCurrent())
+        const_cast<Table *>(this)->loadPendingData();
+    Table *result = new Table(0, 0, name());
+    result->setCreationTime(creationTime());
+    result->setCaptionSpec(captionSpec());
+    result->setComment(comment());
+    if (hasPendingData()) {
+        copyPendingData(result);
+        return result;
+    }
+    QList<Column *> columns;
+    for (int i = 0; i < columnCount(); i++)
+        columns << column(i)->snapshot();
+    result->appendColumns(columns);
+    result->setRowCount(rowCount());
+    for (int i = 0; i < columnCount(); i++)
+        result->setColumnWidth(i, columnWidth(i));
+    return result;
+}
+
 void Table::copy(Table *other)
 {
     WAIT_CURSOR;
@@ -2359,6 +2382,14 @@ void Table::prepareAspectRemoval(AbstractAspect *aspect)
 
 void Table::save(QXmlStreamWriter *writer) const
 {
+    auto &settings = ApplicationWindow::getSettings();
+    save(writer, settings.value("/General/BinaryProjectData", false).toBool());
+}
+
+void Table::save(QXmlStreamWriter *writer, bool binary_data) const
+{
+    // saving needs the whole content, even if it hasn't been looked at yet
+    const_cast<Table *>(this)->loadPendingData();
     int cols = columnCount();
     int rows = rowCount();
     writer->writeStartElement("table");
@@ -2368,7 +2399,7 @@ void Table::save(QXmlStreamWriter *writer) const
     writeCommentElement(writer);
 
     for (int col = 0; col < cols; col++)
-        column(col)->save(writer);
+        column(col)->save(writer, binary_data);
     for (int col = 0; col < cols; col++) {
         writer->writeStartElement("column_width");
         writer->writeAttribute("column", QString::number(col));
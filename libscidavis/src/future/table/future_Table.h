@@ -222,11 +222,21 @@ public:
     void setSelectionAs(SciDAVis::PlotDesignation pd);
     using AbstractPart::copy;
     void copy(Table *other);
+    //! Return a new table with the same content, sharing the data of all columns
+    /**
+     * See Column::snapshot(). Row data is only copied once it is modified, either in this table or
+     * in the snapshot, so the snapshot can be saved from another thread while the user goes on
+     * working with this table. Pending data (see AbstractPart::setPendingData()) is not loaded, but
+     * copied to the snapshot, which Table::saveToDevice() writes without parsing it.
+     */
+    Table *snapshot() const;
 
     //! \name serialize/deserialize
     //@{
     //! Save as XML
     virtual void save(QXmlStreamWriter *) const;
+    //! Save as XML, see Column::save(QXmlStreamWriter*, bool)
+    void save(QXmlStreamWriter *writer, bool binary_data) const;
     //! Load from XML
     virtual bool load(XmlStreamReader *);
     bool readColumnWidthElement(XmlStreamReader *reader);
@@ -277,27 +277,29 @@ bool ImportOPJ::importSpreadsheet(const OriginFile &opj, const Origin::SpreadShe
             */
             {
                 double datavalue;
-                bool setAsText = false;
-                table->column(j)->setColumnMode(SciDAVis::ColumnMode::Numeric);
-                for (int i = 0; i < std::min((int)column.data.size(), maxrows); ++i) {
+                int rows = std::min((int)column.data.size(), maxrows);
+                bool setAsText =
+                        rows > 0 && column.data[0].type() != Origin::variant::V_DOUBLE;
+                table->column(j)->setColumnMode(setAsText ? SciDAVis::ColumnMode::Text
+                                                          : SciDAVis::ColumnMode::Numeric);
+                // strings in numeric columns are dropped by the builder
+                Column::Builder builder(scidavis_column);
+                for (int i = 0; i < rows; ++i) {
                     Origin::variant value(column.data[i]);
                     if (value.type() == Origin::variant::V_DOUBLE) {
                         datavalue = value.as_double();
                         if (datavalue == _ONAN)
                             continue; // mark for empty cell
                         if (!setAsText) {
-                            scidavis_column->setValueAt(i, datavalue);
+                            builder.setValueAt(i, datavalue);
                         } else { // convert double to string for Text columns
-                            scidavis_column->setTextAt(i, locale.toString(datavalue, 'g', 16));
+                            builder.setTextAt(i, locale.toString(datavalue, 'g', 16));
                         }
                     } else { // string
-                        if (!setAsText && i == 0) {
-                            table->column(j)->setColumnMode(SciDAVis::ColumnMode::Text);
-                            setAsText = true;
-                        }
-                        scidavis_column->setTextAt(i, column.data[i].as_string());
+                        builder.setTextAt(i, column.data[i].as_string());
                     }
                 }
+                builder.finish();
                 int f = 0;
                 if (column.numericDisplayType == 0) {
                     f = 0;
@@ -323,8 +325,10 @@ bool ImportOPJ::importSpreadsheet(const OriginFile &opj, const Origin::SpreadShe
             }
         case Origin::Text:
             table->column(j)->setColumnMode(SciDAVis::ColumnMode::Text);
-            for (int i = 0; i < min((int)column.data.size(), maxrows); ++i) {
-                scidavis_column->setTextAt(i, column.data[i].as_string());
+            {
+                Column::Builder builder(scidavis_column);
+                for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
+                    builder.setTextAt(i, column.data[i].as_string());
             }
             break;
         case Origin::Date: {
@@ -379,8 +383,11 @@ bool ImportOPJ::importSpreadsheet(const OriginFile &opj, const Origin::SpreadShe
             default:
                 format = "dd.MM.yyyy";
             }
-            for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
-                scidavis_column->setValueAt(i, column.data[i].as_double());
+            {
+                Column::Builder builder(scidavis_column);
+                for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
+                    builder.setValueAt(i, column.data[i].as_double());
+            }
             table->column(j)->setColumnMode(SciDAVis::ColumnMode::DateTime);
             DateTime2StringFilter *filter =
                     static_cast<DateTime2StringFilter *>(scidavis_column->outputFilter());
@@ -423,8 +430,11 @@ bool ImportOPJ::importSpreadsheet(const OriginFile &opj, const Origin::SpreadShe
                 format = "hh:mm:ss.zzz";
                 break;
             }
-            for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
-                scidavis_column->setValueAt(i, column.data[i].as_double());
+            {
+                Column::Builder builder(scidavis_column);
+                for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
+                    builder.setValueAt(i, column.data[i].as_double());
+            }
             table->column(j)->setColumnMode(SciDAVis::ColumnMode::DateTime);
             DateTime2StringFilter *filter =
                     static_cast<DateTime2StringFilter *>(table->column(j)->outputFilter());
@@ -443,8 +453,11 @@ bool ImportOPJ::importSpreadsheet(const OriginFile &opj, const Origin::SpreadShe
                 format = "M";
                 break;
             }
-            for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
-                scidavis_column->setValueAt(i, column.data[i].as_double());
+            {
+                Column::Builder builder(scidavis_column);
+                for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
+                    builder.setValueAt(i, column.data[i].as_double());
+            }
             table->column(j)->setColumnMode(SciDAVis::ColumnMode::Month);
             DateTime2StringFilter *filter =
                     static_cast<DateTime2StringFilter *>(table->column(j)->outputFilter());
@@ -463,8 +476,11 @@ bool ImportOPJ::importSpreadsheet(const OriginFile &opj, const Origin::SpreadShe
                 format = "d";
                 break;
             }
-            for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
-                scidavis_column->setValueAt(i, column.data[i].as_double());
+            {
+                Column::Builder builder(scidavis_column);
+                for (int i = 0; i < min((int)column.data.size(), maxrows); ++i)
+                    builder.setValueAt(i, column.data[i].as_double());
+            }
             table->column(j)->setColumnMode(SciDAVis::ColumnMode::Day);
             DateTime2StringFilter *filter =
                     static_cast<DateTime2StringFilter *>(table->column(j)->outputFilter());
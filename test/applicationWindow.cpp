@@ -1,7 +1,11 @@
 #include "ApplicationWindowTest.h"
 #include "RenameWindowDialog.h"
 #include "Folder.h"
+#include "Table.h"
+#include "core/column/Column.h"
 #include <QToolBar>
+#include <QTemporaryFile>
+#include <QTextStream>
 #include <iostream>
 
 #include "utils.h"
@@ -117,3 +121,41 @@ TEST_F(ApplicationWindowTest, showWindowPopupMenu)
             EXPECT_TRUE(m1->contentsRect() == m2->contentsRect());
         }
 }
+
+// formulas are evaluated on several threads, unless they carry variables from row to row
+TEST_F(ApplicationWindowTest, tableFormulas)
+{
+    const int rows = 20000;
+    auto table = newTable("formulas", rows, 2);
+    auto column = table->column(1);
+    column->setFormula(Interval<int>(0, rows - 1), "s = (i == 1 ? 0 : s) + i");
+    ASSERT_TRUE(table->recalculate(1, false));
+    for (int r = 0; r < rows; r++)
+        EXPECT_DOUBLE_EQ(0.5 * (r + 1) * (r + 2), column->valueAt(r));
+
+    column->setFormula(Interval<int>(0, rows - 1), "2 * i + (i > 10 ? 1 : 0)");
+    ASSERT_TRUE(table->recalculate(1, false));
+    for (int r = 0; r < rows; r++)
+        EXPECT_DOUBLE_EQ(2 * (r + 1) + (r >= 10 ? 1 : 0), column->valueAt(r));
+}
+
+// columns added by an import are part of the same undo step as the ones it overwrites
+TEST_F(ApplicationWindowTest, importASCIIUndo)
+{
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    QTextStream(&file) << "1 2.5 a\n3 4.5 b\n";
+    file.close();
+
+    for (int columns : { 0, 1 }) {
+        auto table = newTable("import", 2, 2);
+        table->d_future_table->removeColumns(columns, 2 - columns);
+        ASSERT_EQ(columns, table->numCols());
+        table->importASCII(file.fileName(), " ", 0, false, false, false, false);
+        ASSERT_EQ(3, table->numCols());
+        EXPECT_EQ(4.5, table->column(1)->valueAt(1));
+        EXPECT_EQ("b", table->text(1, 2));
+        undo();
+        EXPECT_EQ(columns, table->numCols());
+    }
+}
@@ -0,0 +1,36 @@
+#include "AutoDiffFormula.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+TEST(AutoDiffFormula, gradient)
+{
+    AutoDiffFormula f;
+    ASSERT_TRUE(f.compile("a*exp(-b*x)+c*sin(x)^2-x/b", { "a", "b", "c" }));
+    double p[] = { 2, 0.5, 3 }, gradient[3];
+    double x = 1.5;
+    double value = f.evaluate(x, p, gradient);
+    EXPECT_NEAR(value, 2 * exp(-0.5 * x) + 3 * pow(sin(x), 2) - x / 0.5, 1e-12);
+    EXPECT_NEAR(gradient[0], exp(-0.5 * x), 1e-12);
+    EXPECT_NEAR(gradient[1], -2 * x * exp(-0.5 * x) + x / 0.25, 1e-12);
+    EXPECT_NEAR(gradient[2], pow(sin(x), 2), 1e-12);
+}
+
+TEST(AutoDiffFormula, precedence)
+{
+    AutoDiffFormula f;
+    double gradient[1], p[] = { 3 };
+    ASSERT_TRUE(f.compile("-a^2", { "a" }));
+    EXPECT_DOUBLE_EQ(f.evaluate(0, p, gradient), -9);
+    EXPECT_DOUBLE_EQ(gradient[0], -6);
+    ASSERT_TRUE(f.compile("2^-a*x", { "a" }));
+    EXPECT_DOUBLE_EQ(f.evaluate(2, p, gradient), 0.25);
+}
+
+TEST(AutoDiffFormula, unsupported)
+{
+    AutoDiffFormula f;
+    EXPECT_FALSE(f.compile("x<a ? a : x", { "a" }));
+    EXPECT_FALSE(f.compile("a*foo(x)", { "a" }));
+    EXPECT_FALSE(f.compile("a*y", { "a" }));
+    EXPECT_FALSE(f.isCompiled());
+}
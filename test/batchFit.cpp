@@ -0,0 +1,75 @@
+#include "ApplicationWindowTest.h"
+#include "BatchFit.h"
+#include "NonLinearFit.h"
+#include "PolynomialFit.h"
+#include "Table.h"
+
+namespace {
+Table *dataTable(ApplicationWindow *app, double intercept, double slope)
+{
+    Table *table = app->newTable("data", 10, 2);
+    table->setColName(0, "x");
+    table->setColName(1, "y");
+    for (int r = 0; r < table->numRows(); ++r) {
+        table->column(0)->setValueAt(r, r + 1);
+        table->column(1)->setValueAt(r, intercept + slope * (r + 1));
+    }
+    return table;
+}
+} // namespace
+
+// y = (a^3 - 3a) x has a local chi^2 minimum at a = 1 for data y = -3x; starting from a = 0.5,
+// only random starts below a = -1 reach the exact solution
+TEST_F(ApplicationWindowTest, batchFitMultiStart)
+{
+    Table *table = dataTable(this, 0, -3);
+    auto factory = [this]() -> Fit * {
+        auto fit = new NonLinearFit(this, nullptr);
+        fit->setParametersList(QStringList() << "a");
+        fit->setFormula("(a^3-3*a)*x");
+        double guess = 0.5;
+        fit->setInitialGuesses(&guess);
+        return fit;
+    };
+
+    // columns: table, x, y, a, aErr, ChiSquare
+    BatchFit single(this, factory);
+    single.addDataSet(table, "x", "y");
+    Table *result = single.run();
+    ASSERT_TRUE(result);
+    EXPECT_GT(result->column(5)->valueAt(0), 300);
+
+    BatchFit multi(this, factory);
+    multi.addDataSet(table, "x", "y");
+    multi.setRandomStarts(30, 8);
+    result = multi.run();
+    ASSERT_TRUE(result);
+    EXPECT_NEAR(-2.1038034, result->column(3)->valueAt(0), 1e-4);
+    EXPECT_LT(result->column(5)->valueAt(0), 1e-6);
+}
+
+// linear fits don't depend on the initial guesses, so further starts are skipped
+TEST_F(ApplicationWindowTest, batchFitLinearStartsOnce)
+{
+    Table *table1 = dataTable(this, 2, 3);
+    Table *table2 = dataTable(this, -1, 0.5);
+    int fits = 0;
+    BatchFit batch(this, [&]() -> Fit * {
+        fits++;
+        return new LinearFit(this, nullptr);
+    });
+    batch.addDataSet(table1, "x", "y");
+    batch.addDataSet(table2, "x", "y");
+    batch.setRandomStarts(5);
+    Table *result = batch.run();
+    ASSERT_TRUE(result);
+    // one for the model, one per data set
+    EXPECT_EQ(3, fits);
+
+    // columns: table, x, y, intercept, its error, slope, its error
+    ASSERT_EQ(2, result->numRows());
+    EXPECT_NEAR(2, result->column(3)->valueAt(0), 1e-10);
+    EXPECT_NEAR(3, result->column(5)->valueAt(0), 1e-10);
+    EXPECT_NEAR(-1, result->column(3)->valueAt(1), 1e-10);
+    EXPECT_NEAR(0.5, result->column(5)->valueAt(1), 1e-10);
+}
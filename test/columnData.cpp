@@ -0,0 +1,76 @@
+#include "core/column/ColumnData.h"
+#include <gtest/gtest.h>
+
+TEST(TextColumnData, roundTrip)
+{
+    TextColumnData data(QStringList() << "a" << QString() << "b" << "a");
+    ASSERT_EQ(4, data.size());
+    EXPECT_EQ(QStringList() << "a" << QString() << "b" << "a", data.mid(0, -1));
+    data.insert(1, 2);
+    data.replace(2, "c");
+    data.remove(0, 1);
+    data.resize(6);
+    EXPECT_EQ(QStringList() << QString() << "c" << QString() << "b" << "a" << QString(),
+              data.mid(0, -1));
+    EXPECT_EQ(QString(), data.value(-1));
+    EXPECT_EQ(QString(), data.value(6));
+}
+
+// strings replaced in the meantime must not pile up in the dictionary
+TEST(TextColumnData, compactOnReplace)
+{
+    const int rows = 10;
+    QStringList texts;
+    for (int row = 0; row < rows; row++)
+        texts << QString("row %1").arg(row % 3);
+    TextColumnData data(texts);
+    for (int i = 0; i < 5000; i++) {
+        data.replace(i % rows, QString("replacement %1").arg(i));
+        texts[i % rows] = QString("replacement %1").arg(i);
+    }
+    EXPECT_EQ(texts, data.mid(0, -1));
+    // without compaction, the dictionary would hold all 5000 strings
+    EXPECT_LT(data.memoryUsage(), 2000 * 64);
+}
+
+namespace {
+//! QDateTime::operator==() only compares points in time, not how they are expressed
+void expectSame(const QDateTime &expected, const QDateTime &actual)
+{
+    EXPECT_EQ(expected.isValid(), actual.isValid());
+    EXPECT_EQ(expected.date(), actual.date());
+    EXPECT_EQ(expected.time(), actual.time());
+    EXPECT_EQ(expected.timeSpec(), actual.timeSpec());
+    EXPECT_EQ(expected.offsetFromUtc(), actual.offsetFromUtc());
+}
+} // namespace
+
+TEST(DateTimeColumnData, roundTrip)
+{
+    QDate date(2021, 7, 14);
+    QTime time(13, 45, 12, 345);
+    QList<QDateTime> values;
+    values << QDateTime(date, time) << QDateTime() << QDateTime(QDate(), time)
+           << QDateTime(QDate(1969, 12, 31), QTime(23, 59, 59, 999)) << QDateTime(date, time, Qt::UTC)
+           << QDateTime(date, time, Qt::OffsetFromUTC, -5 * 3600 - 1800);
+
+    // local times only, then with UTC and offsets mixed in
+    for (int count : { 4, values.size() }) {
+        DateTimeColumnData data(values.mid(0, count));
+        ASSERT_EQ(count, data.size());
+        for (int row = 0; row < count; row++)
+            expectSame(values.at(row), data.at(row));
+
+        data.insert(1, 2);
+        data.remove(0, 1);
+        data.replace(0, values.last());
+        data.resize(count + 2);
+        QList<QDateTime> expected = QList<QDateTime>() << values.last() << QDateTime();
+        expected << values.mid(1, count - 1) << QDateTime();
+        QList<QDateTime> actual = data.mid(0, -1);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (int row = 0; row < expected.size(); row++)
+            expectSame(expected.at(row), actual.at(row));
+        expectSame(QDateTime(), data.value(count + 2));
+    }
+}
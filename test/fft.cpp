@@ -1,8 +1,15 @@
 #include "ApplicationWindowTest.h"
+#include "Convolution.h"
 #include "FFT.h"
+#include "FourierTransform.h"
+#include "Matrix.h"
 #include "MultiLayer.h"
+#include "SmoothFilter.h"
 #include <QMdiArea>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "utils.h"
 
@@ -59,3 +66,239 @@ TEST_F(ApplicationWindowTest, fft)
             EXPECT_EQ(col1.valueAt(r), col2.valueAt(r));
     }
 }
+
+TEST(FourierTransform, realMatchesComplex)
+{
+    // powers of two, mixed radix lengths and a prime
+    for (size_t n : { 1, 2, 12, 16, 30, 31 }) {
+        std::vector<double> real(n), complex(2 * n), unpacked(2 * n);
+        for (size_t i = 0; i < n; i++)
+            real[i] = complex[2 * i] = sin(1.3 * i) + 0.1 * i;
+
+        ASSERT_TRUE(FourierTransform::realForward(real.data(), n));
+        ASSERT_TRUE(FourierTransform::complex(complex.data(), n, FourierTransform::Forward));
+        FourierTransform::unpackHalfcomplex(real.data(), unpacked.data(), n);
+        for (size_t i = 0; i < 2 * n; i++)
+            EXPECT_NEAR(complex[i], unpacked[i], 1e-9);
+
+        ASSERT_TRUE(FourierTransform::halfcomplexInverse(real.data(), n));
+        ASSERT_TRUE(FourierTransform::complex(complex.data(), n, FourierTransform::Inverse));
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_NEAR(sin(1.3 * i) + 0.1 * i, real[i], 1e-9);
+            EXPECT_NEAR(real[i], complex[2 * i], 1e-9);
+            EXPECT_NEAR(0, complex[2 * i + 1], 1e-9);
+        }
+    }
+}
+
+// short responses are convolved directly, long ones through FFTs of a non-power-of-two length
+TEST_F(ApplicationWindowTest, convolution)
+{
+    const int rows = 100;
+    for (int m : { 3, 31 }) {
+        auto table = newTable("convolution", rows, 2);
+        table->setColName(0, "signal");
+        table->setColName(1, "response");
+        for (int r = 0; r < rows; ++r)
+            table->column(0)->setValueAt(r, sin(0.3 * r) + 1);
+        for (int r = 0; r < m; ++r)
+            table->column(1)->setValueAt(r, 1.0 + 0.5 * r);
+
+        Convolution convolution(this, table, "signal", "response");
+        ASSERT_TRUE(convolution.run());
+        ASSERT_EQ(4, table->numCols());
+        for (int i = 0; i < rows; i++) {
+            double expected = 0;
+            for (int j = 0; j < m; j++) {
+                int k = i + m / 2 - j;
+                if (k >= 0 && k < rows)
+                    expected += (1.0 + 0.5 * j) * (sin(0.3 * k) + 1);
+            }
+            EXPECT_NEAR(expected, table->cell(i, 3), 1e-9);
+        }
+    }
+}
+
+TEST_F(ApplicationWindowTest, spectrogram)
+{
+    const int rows = 64;
+    auto table = newTable("signal", rows, 2);
+    table->setColName(1, "y");
+    // two periods per window of 16 points; amplitudes are normalized by default
+    for (int r = 0; r < rows; ++r)
+        table->column(1)->setValueAt(r, cos(M_PI * r / 4));
+
+    FFT fft(this, table, "y");
+    fft.setShortTime(16, 8, FFT::Rectangular);
+    fft.run();
+    Matrix *matrix = nullptr;
+    for (auto i : windowsList())
+        if ((matrix = dynamic_cast<Matrix *>(i)))
+            break;
+    ASSERT_TRUE(matrix);
+    EXPECT_EQ(9, matrix->numRows());
+    EXPECT_EQ(7, matrix->numCols());
+    for (int c = 0; c < matrix->numCols(); ++c)
+        for (int r = 0; r < matrix->numRows(); ++r)
+            EXPECT_NEAR(r == 2 ? 1 : 0, matrix->cell(r, c), 1e-9);
+}
+
+namespace {
+//! Savitzky-Golay smoothing the way SmoothFilter used to compute it
+/**
+ * The coefficients are the row of H = V(V^TV)^(-1)V^T belonging to the smoothed point, with V the
+ * Vandermonde matrix of the plain point indices; both edges are zero padded.
+ */
+std::vector<double> legacySavitzkyGolay(const std::vector<double> &y, int left, int right,
+                                        int order)
+{
+    int points = left + right + 1, m = order + 1;
+    auto v = [](int i, int j) { return std::pow(double(i), j); };
+    // solve V^TV c = V^T e_left by Gaussian elimination, then h = Vc
+    std::vector<std::vector<double>> a(m, std::vector<double>(m + 1, 0.0));
+    for (int r = 0; r < m; r++) {
+        for (int c = 0; c < m; c++)
+            for (int i = 0; i < points; i++)
+                a[r][c] += v(i, r) * v(i, c);
+        a[r][m] = v(left, r);
+    }
+    for (int c = 0; c < m; c++) {
+        int pivot = c;
+        for (int r = c + 1; r < m; r++)
+            if (std::fabs(a[r][c]) > std::fabs(a[pivot][c]))
+                pivot = r;
+        std::swap(a[c], a[pivot]);
+        for (int r = 0; r < m; r++)
+            if (r != c) {
+                double factor = a[r][c] / a[c][c];
+                for (int k = c; k <= m; k++)
+                    a[r][k] -= factor * a[c][k];
+            }
+    }
+    std::vector<double> h(points, 0.0);
+    for (int i = 0; i < points; i++)
+        for (int j = 0; j < m; j++)
+            h[i] += v(i, j) * a[j][m] / a[j][j];
+
+    int n = y.size();
+    std::vector<double> result(n, 0.0);
+    for (int i = 0; i < n; i++)
+        for (int k = 0; k < points; k++)
+            if (i - left + k >= 0 && i - left + k < n)
+                result[i] += h[k] * y[i - left + k];
+    return result;
+}
+} // namespace
+
+// short windows are convolved directly, long ones through FFTs; both must agree with the
+// original implementation
+TEST_F(ApplicationWindowTest, savitzkyGolay)
+{
+    const int rows = 200;
+    auto table = newTable("noisy", rows, 2);
+    table->setColName(0, "x");
+    table->setColName(1, "y");
+    std::vector<double> y(rows);
+    for (int r = 0; r < rows; ++r) {
+        y[r] = sin(0.05 * r) + 0.002 * r + 0.2 * sin(7.3 * r);
+        table->column(0)->setValueAt(r, r);
+        table->column(1)->setValueAt(r, y[r]);
+    }
+    auto graph = new Graph(this);
+    graph->insertCurve(table, "x", "y", Graph::Line);
+
+    struct Window
+    {
+        int right, left, order;
+    };
+    // the first two are below the FFT threshold of 3 log2(rows + window length)
+    for (auto window : { Window{ 5, 5, 3 }, Window{ 2, 4, 2 }, Window{ 20, 17, 2 },
+                         Window{ 30, 30, 1 } }) {
+        QList<MyWidget *> old_windows = windowsList();
+        SmoothFilter filter(this, graph, "y", SmoothFilter::SavitzkyGolay);
+        filter.setSmoothPoints(window.right, window.left);
+        filter.setPolynomOrder(window.order);
+        ASSERT_TRUE(filter.run());
+
+        // the result goes to a new hidden table
+        Table *result = nullptr;
+        for (auto i : windowsList())
+            if (!old_windows.contains(i) && (result = dynamic_cast<Table *>(i)))
+                break;
+        ASSERT_TRUE(result);
+        ASSERT_EQ(rows, result->numRows());
+        auto expected = legacySavitzkyGolay(y, window.left, window.right, window.order);
+        for (int r = 0; r < rows; ++r)
+            EXPECT_NEAR(expected[r], result->column(1)->valueAt(r), 1e-8)
+                    << "window " << window.left << "+" << window.right << ", row " << r;
+    }
+}
+
+namespace {
+//! Smooths \a y (against x = 0, 1, ...) with \a method over \a points points
+std::vector<double> smooth(ApplicationWindow *app, const std::vector<double> &y, int method,
+                           int points)
+{
+    int rows = y.size();
+    auto table = app->newTable("smoothed", rows, 2);
+    table->setColName(0, "x");
+    table->setColName(1, "y");
+    for (int r = 0; r < rows; ++r) {
+        table->column(0)->setValueAt(r, r);
+        table->column(1)->setValueAt(r, y[r]);
+    }
+    auto graph = new Graph(app);
+    graph->insertCurve(table, "x", "y", Graph::Line);
+
+    QList<MyWidget *> old_windows = app->windowsList();
+    SmoothFilter filter(app, graph, "y", method);
+    filter.setSmoothPoints(points);
+    std::vector<double> result;
+    if (!filter.run())
+        return result;
+    for (auto i : app->windowsList())
+        if (!old_windows.contains(i))
+            if (auto t = dynamic_cast<Table *>(i))
+                for (int r = 0; r < t->numRows(); ++r)
+                    result.push_back(t->column(1)->valueAt(r));
+    return result;
+}
+} // namespace
+
+// the window shrinks near the edges so that it stays centered on the smoothed point
+TEST_F(ApplicationWindowTest, smoothAverage)
+{
+    const int rows = 50;
+    std::vector<double> y(rows);
+    for (int r = 0; r < rows; ++r)
+        y[r] = sin(0.2 * r) + 0.3 * sin(5.1 * r);
+
+    // an even number of points is rounded up to the next odd one
+    for (int points : { 1, 5, 8, 49 }) {
+        auto result = smooth(this, y, SmoothFilter::Average, points);
+        ASSERT_EQ(rows, int(result.size())) << points << " points";
+        for (int i = 0; i < rows; ++i) {
+            int r = std::min(std::min(i, rows - 1 - i), points / 2);
+            double sum = 0;
+            for (int j = i - r; j <= i + r; ++j)
+                sum += y[j];
+            EXPECT_NEAR(sum / (2 * r + 1), result[i], 1e-12) << points << " points, row " << i;
+        }
+    }
+}
+
+TEST_F(ApplicationWindowTest, smoothMedian)
+{
+    std::vector<double> y{ 1, 5, 2, 8, 3, 9, 4 };
+    EXPECT_EQ((std::vector<double>{ 1, 2, 5, 3, 8, 4, 4 }),
+              smooth(this, y, SmoothFilter::Median, 3));
+    EXPECT_EQ((std::vector<double>{ 1, 2, 3, 5, 4, 4, 4 }),
+              smooth(this, y, SmoothFilter::Median, 5));
+}
+
+// three points give a smoothing factor of 1/2; the backward pass starts from the forward one
+TEST_F(ApplicationWindowTest, smoothExponential)
+{
+    EXPECT_EQ((std::vector<double>{ 0.9375, 1.875, 1.75, 2.5 }),
+              smooth(this, { 0, 4, 0, 4 }, SmoothFilter::Exponential, 3));
+}
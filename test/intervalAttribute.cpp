@@ -0,0 +1,42 @@
+#include "lib/IntervalAttribute.h"
+#include <gtest/gtest.h>
+
+TEST(IntervalAttribute, setAndUnset)
+{
+    IntervalAttribute<bool> a;
+    a.setValue(Interval<int>(10, 19));
+    a.setValue(Interval<int>(0, 4));
+    a.setValue(Interval<int>(5, 7)); // touches [0,4]
+    a.setValue(Interval<int>(12, 15), false);
+    QList<Interval<int>> expected;
+    expected << Interval<int>(0, 7) << Interval<int>(10, 11) << Interval<int>(16, 19);
+    EXPECT_EQ(a.intervals(), expected);
+    EXPECT_TRUE(a.isSet(7));
+    EXPECT_FALSE(a.isSet(8));
+    EXPECT_FALSE(a.isSet(15));
+    EXPECT_TRUE(a.isSet(Interval<int>(2, 6)));
+    EXPECT_FALSE(a.isSet(Interval<int>(6, 10)));
+
+    QVector<bool> bitmap = a.bitmap(6, 6);
+    EXPECT_EQ(bitmap, QVector<bool>({ true, true, false, false, true, true }));
+}
+
+TEST(IntervalAttribute, insertAndRemoveRows)
+{
+    QList<Interval<int>> unsorted;
+    unsorted << Interval<int>(10, 12) << Interval<int>(2, 5) << Interval<int>(4, 6);
+    IntervalAttribute<bool> a(unsorted);
+    QList<Interval<int>> expected;
+    expected << Interval<int>(2, 6) << Interval<int>(10, 12);
+    EXPECT_EQ(a.intervals(), expected);
+
+    a.insertRows(4, 2);
+    expected.clear();
+    expected << Interval<int>(2, 3) << Interval<int>(6, 8) << Interval<int>(12, 14);
+    EXPECT_EQ(a.intervals(), expected);
+
+    a.removeRows(4, 2);
+    expected.clear();
+    expected << Interval<int>(2, 6) << Interval<int>(10, 12);
+    EXPECT_EQ(a.intervals(), expected);
+}
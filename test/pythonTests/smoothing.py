@@ -36,6 +36,13 @@ smth1.setSmoothPoints(2,2) # left and right points
 smth1.setPolynomOrder(3)
 smth1.run()
 
+smth1b=SmoothFilter(l1,curve1)
+smth1b.setMethod(1) # long windows are convolved through FFTs
+smth1b.setSmoothPoints(12,12)
+smth1b.setPolynomOrder(4)
+smth1b.setColor("darkGreen")
+smth1b.run()
+
 smth2=SmoothFilter(l1,curve1)
 smth2.setMethod(2) # method=2 - FFT
 smth2.setSmoothPoints(3)
@@ -48,5 +55,17 @@ smth3.setSmoothPoints(3)
 smth3.setColor("green")
 smth3.run()
 
+smth4=SmoothFilter(l1,curve1)
+smth4.setMethod(4) # method=4 - Moving Window Median
+smth4.setSmoothPoints(3)
+smth4.setColor("magenta")
+smth4.run()
+
+smth5=SmoothFilter(l1,curve1)
+smth5.setMethod(5) # method=5 - Exponential Moving Average
+smth5.setSmoothPoints(3)
+smth5.setColor("cyan")
+smth5.run()
+
 g1.exportImage("smoothing.png")
 app.exit()
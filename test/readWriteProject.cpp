@@ -3,6 +3,7 @@
 #include "Graph3D.h"
 #include "testPaintDevice.h"
 #include "Note.h"
+#include "Matrix.h"
 #include <QMdiArea>
 
 #include <iostream>
@@ -20,13 +21,93 @@ TEST_F(ApplicationWindowTest, readWriteProject)
 {
     std::unique_ptr<ApplicationWindow> app(open("testProject.sciprj"));
     EXPECT_TRUE(app.get());
-    app->saveFolder(app->projectFolder(), "testProject1.sciprj");
-    std::unique_ptr<ApplicationWindow> app1(open("testProject1.sciprj"));
-    // TODO check that app1 is the same as app?
-    EXPECT_TRUE(app1.get());
+    std::unique_ptr<ApplicationWindow> app1;
+    // table data must survive the round trip exactly, whichever way numbers are stored
+    auto &settings = ApplicationWindow::getSettings();
+    for (bool binary_data : { true, false }) {
+        settings.setValue("/General/BinaryProjectData", binary_data);
+        app->saveFolder(app->projectFolder(), "testProject1.sciprj");
+        app1.reset(open("testProject1.sciprj"));
+        ASSERT_TRUE(app1.get());
+        for (auto i : app->windowsList())
+            if (auto table = dynamic_cast<Table *>(i)) {
+                auto table1 = dynamic_cast<Table *>(app1->window(table->name()));
+                ASSERT_TRUE(table1);
+                ASSERT_EQ(table->numRows(), table1->numRows());
+                ASSERT_EQ(table->numCols(), table1->numCols());
+                for (int col = 0; col < table->numCols(); col++)
+                    for (int row = 0; row < table->numRows(); row++) {
+                        EXPECT_EQ(table->column(col)->isInvalid(row),
+                                  table1->column(col)->isInvalid(row));
+                        if (table->column(col)->dataType() == SciDAVis::TypeDouble)
+                            EXPECT_EQ(table->column(col)->valueAt(row),
+                                      table1->column(col)->valueAt(row));
+                        else
+                            EXPECT_EQ(table->text(row, col), table1->text(row, col));
+                    }
+            }
+    }
+    settings.remove("/General/BinaryProjectData");
     file_compress("testProject1.sciprj", "wb9");
     app1.reset(open("testProject1.sciprj.gz"));
     EXPECT_TRUE(app1.get());
+    // compressed on the fly
+    app->saveFolder(app->projectFolder(), "testProject2.sciprj.gz");
+    app1.reset(open("testProject2.sciprj.gz"));
+    ASSERT_TRUE(app1.get());
+    EXPECT_EQ(app->windowsList().size(), app1->windowsList().size());
+}
+
+// unchanged windows are written from cached XML, so edits and undo must invalidate it
+TEST_F(ApplicationWindowTest, saveAfterEdit)
+{
+    std::unique_ptr<ApplicationWindow> app(open("testProject.sciprj"));
+    ASSERT_TRUE(app.get());
+    auto table = dynamic_cast<Table *>(app->window("Table1"));
+    ASSERT_TRUE(table);
+    double old_value = table->cell(0, 0);
+    quint64 revision = table->d_future_table->revision();
+    app->saveFolder(app->projectFolder(), "testProject3.sciprj");
+    EXPECT_EQ(revision, table->d_future_table->revision());
+
+    table->column(0)->setValueAt(0, old_value + 1);
+    EXPECT_NE(revision, table->d_future_table->revision());
+    app->saveFolder(app->projectFolder(), "testProject3.sciprj");
+    std::unique_ptr<ApplicationWindow> app1(open("testProject3.sciprj"));
+    ASSERT_TRUE(app1.get());
+    auto table1 = dynamic_cast<Table *>(app1->window("Table1"));
+    ASSERT_TRUE(table1);
+    EXPECT_EQ(old_value + 1, table1->cell(0, 0));
+
+    app->undo();
+    app->saveFolder(app->projectFolder(), "testProject3.sciprj");
+    app1.reset(open("testProject3.sciprj"));
+    ASSERT_TRUE(app1.get());
+    table1 = dynamic_cast<Table *>(app1->window("Table1"));
+    ASSERT_TRUE(table1);
+    EXPECT_EQ(old_value, table1->cell(0, 0));
+}
+
+// header sizes are saved, but resizing a header section is no modification of the matrix
+TEST_F(ApplicationWindowTest, saveMatrixAfterResize)
+{
+    std::unique_ptr<ApplicationWindow> app(open("testProject.sciprj"));
+    ASSERT_TRUE(app.get());
+    auto matrix = app->newMatrix("ResizedMatrix", 4, 3);
+    ASSERT_TRUE(matrix);
+    app->saveFolder(app->projectFolder(), "testProject3.sciprj");
+
+    int width = matrix->d_future_matrix->columnWidth(1) + 17;
+    int height = matrix->d_future_matrix->rowHeight(2) + 5;
+    matrix->d_future_matrix->setColumnWidth(1, width);
+    matrix->d_future_matrix->setRowHeight(2, height);
+    app->saveFolder(app->projectFolder(), "testProject3.sciprj");
+    std::unique_ptr<ApplicationWindow> app1(open("testProject3.sciprj"));
+    ASSERT_TRUE(app1.get());
+    auto matrix1 = app1->matrix("ResizedMatrix");
+    ASSERT_TRUE(matrix1);
+    EXPECT_EQ(width, matrix1->d_future_matrix->columnWidth(1));
+    EXPECT_EQ(height, matrix1->d_future_matrix->rowHeight(2));
 }
 
 TEST_F(ApplicationWindowTest, exportTestProject)
@@ -0,0 +1,36 @@
+#include "lib/UndoMemory.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+TEST(UndoMemory, spillToDisk)
+{
+    qint64 budget = UndoMemory::budget();
+    // move whatever earlier tests left behind out of the way
+    UndoMemory::setBudget(0);
+    qint64 usage = UndoMemory::usage();
+    qint64 disk_usage = UndoMemory::diskUsage();
+
+    // random bytes don't compress, so that each payload exceeds the budget on its own
+    std::mt19937 generator(0);
+    QByteArray data(100000, '\0');
+    for (int i = 0; i < data.size(); i++)
+        data[i] = char(generator());
+
+    UndoMemory::setBudget(usage + 1000);
+    {
+        UndoMemory::Payload first, second;
+        first.set(data);
+        EXPECT_FALSE(first.isOnDisk());
+        second.set(data);
+        EXPECT_TRUE(first.isOnDisk());
+        EXPECT_FALSE(second.isOnDisk());
+        EXPECT_EQ(0, first.memoryUsage());
+        EXPECT_GT(UndoMemory::diskUsage(), disk_usage);
+        EXPECT_EQ(data, first.get());
+        EXPECT_EQ(data, second.get());
+    }
+    EXPECT_EQ(usage, UndoMemory::usage());
+    EXPECT_EQ(disk_usage, UndoMemory::diskUsage());
+    UndoMemory::setBudget(budget);
+}